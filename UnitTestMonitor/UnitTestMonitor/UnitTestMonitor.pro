@@ -4,9 +4,16 @@
 #
 #-------------------------------------------------
 
-QT       += core gui webkit xml
+QT       += core gui xml
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets concurrent webkitwidgets
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets concurrent
+
+# the genhtml report browser is optional, the native coverage viewer needs no WebKit
+greaterThan(QT_MAJOR_VERSION, 4) {
+    qtHaveModule(webkitwidgets): CONFIG += utm_webkit
+} else {
+    CONFIG += utm_webkit
+}
 
 TARGET = UnitTestMonitor
 DESTDIR = ../bin
@@ -15,9 +22,9 @@ TEMPLATE = app
 SOURCES += src/main.cpp\
         src/MainWindow.cpp \
     src/TlogViewDialog.cpp \
-    src/LcovBrowserDialog.cpp \
     src/Model/MonitorSet.cpp \
     src/Model/Branch.cpp \
+    src/Model/BranchLayout.cpp \
     src/MonitorSetReader.cpp \
     src/Model/Project.cpp \
     src/Model/Testrun.cpp \
@@ -25,16 +32,42 @@ SOURCES += src/main.cpp\
     src/Model/Library.cpp \
     src/BranchScanner.cpp \
     src/MonitorSetWriter.cpp \
-    src/AboutDialog.cpp
+    src/AboutDialog.cpp \
+    src/Model/Fingerprint.cpp \
+    src/BranchWatcher.cpp \
+    src/BranchPoller.cpp \
+    src/TlogParser.cpp \
+    src/TlogMarkerScanner.cpp \
+    src/TestlibXmlParser.cpp \
+    src/Model/Testfunction.cpp \
+    src/JUnitXmlParser.cpp \
+    src/Model/BenchmarkResult.cpp \
+    src/BenchmarkTrend.cpp \
+    src/SlowTestsDialog.cpp \
+    src/DirectoryWalker.cpp \
+    src/BranchLayoutMatcher.cpp \
+    src/ScanProgress.cpp \
+    src/ScanThrottle.cpp \
+    src/UringReader.cpp \
+    src/Model/Coverage.cpp \
+    src/Model/FileCoverage.cpp \
+    src/Model/CoverageHistory.cpp \
+    src/LcovInfoParser.cpp \
+    src/LcovSummaryParser.cpp \
+    src/SourceCoverageModel.cpp \
+    src/CoverageViewDialog.cpp \
+    src/CoverageDelta.cpp \
+    src/CoverageDeltaDialog.cpp \
+    src/CoverageMerger.cpp
 
 INCLUDEPATH += include
 
 HEADERS  += include/MainWindow.h \
     include/TlogViewDialog.h \
-    include/LcovBrowserDialog.h \
     include/Model/MonitorSet.h \
     include/Model.h \
     include/Model/Branch.h \
+    include/Model/BranchLayout.h \
     include/MonitorSetReader.h \
     include/Model/Project.h \
     include/Model/Testrun.h \
@@ -42,15 +75,52 @@ HEADERS  += include/MainWindow.h \
     include/Model/Library.h \
     include/BranchScanner.h \
     include/MonitorSetWriter.h \
-    include/AboutDialog.h
+    include/AboutDialog.h \
+    include/Model/Fingerprint.h \
+    include/BranchWatcher.h \
+    include/BranchPoller.h \
+    include/TlogParser.h \
+    include/TlogMarkerScanner.h \
+    include/TestlibXmlParser.h \
+    include/Model/Testfunction.h \
+    include/JUnitXmlParser.h \
+    include/Model/BenchmarkResult.h \
+    include/BenchmarkTrend.h \
+    include/SlowTestsDialog.h \
+    include/DirectoryWalker.h \
+    include/BranchLayoutMatcher.h \
+    include/ScanProgress.h \
+    include/ScanThrottle.h \
+    include/UringReader.h \
+    include/Model/Coverage.h \
+    include/Model/FileCoverage.h \
+    include/Model/CoverageHistory.h \
+    include/LcovInfoParser.h \
+    include/LcovSummaryParser.h \
+    include/SourceCoverageModel.h \
+    include/CoverageViewDialog.h \
+    include/CoverageDelta.h \
+    include/CoverageDeltaDialog.h \
+    include/CoverageMerger.h
 
 FORMS    += form/MainWindow.ui \
     form/TlogViewDialog.ui \
-    form/LcovBrowserDialog.ui \
-    form/AboutDialog.ui
+    form/AboutDialog.ui \
+    form/SlowTestsDialog.ui \
+    form/CoverageViewDialog.ui \
+    form/CoverageDeltaDialog.ui
 
 RESOURCES += \
     resources/UnitTestMonitor.qrc
 
 OTHER_FILES += \
     resources/utm.qss
+
+utm_webkit {
+    QT += webkit
+    greaterThan(QT_MAJOR_VERSION, 4): QT += webkitwidgets
+    DEFINES += UTM_WITH_WEBKIT
+    SOURCES += src/LcovBrowserDialog.cpp
+    HEADERS += include/LcovBrowserDialog.h
+    FORMS += form/LcovBrowserDialog.ui
+}
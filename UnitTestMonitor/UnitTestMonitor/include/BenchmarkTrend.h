@@ -0,0 +1,47 @@
+/**
+  * @file BenchmarkTrend.h
+  *
+  * @class BenchmarkTrend
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Rates the latest QBENCHMARK result of a test function against its history
+  * @details The latest value is compared with the median of the runs before it. A change beyond
+  *          the noise threshold is flagged as regression or improvement. Every benchmark metric
+  *          is better the lower it is.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#ifndef BENCHMARKTREND_H
+#define BENCHMARKTREND_H
+
+#include <QList>
+
+class BenchmarkTrend
+{
+public:
+    enum Rating
+    {
+        Unrated = 0,
+        Steady,
+        Improved,
+        Regressed
+    };
+
+    BenchmarkTrend();
+    BenchmarkTrend& withNoiseThreshold(const double percent);
+    BenchmarkTrend& withWindow(const int runs);
+    double getNoiseThreshold() const;
+    int getWindow() const;
+    Rating rate(const QList<double> &values);
+    double getMedian() const;
+    double getChange() const;
+private:
+    double m_noiseThreshold;
+    int m_window;
+    double m_median;
+    double m_change;
+};
+
+#endif // BENCHMARKTREND_H
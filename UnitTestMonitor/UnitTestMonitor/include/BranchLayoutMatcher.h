@@ -0,0 +1,131 @@
+/**
+  * @file BranchLayoutMatcher.h
+  *
+  * @class BranchLayoutMatcher
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Finds the test output of a branch by the templates of its layout
+  * @details The matcher compiles the path templates of a BranchLayout once into segments: plain
+  *          names, patterns with placeholders and globs, and ** for any number of directories.
+  *          A walk keeps a cursor per template position and per bound project and library. A
+  *          directory is listed only if a cursor needs to match a pattern in it, plain names and
+  *          patterns whose placeholders are all bound are opened or probed directly. Directories
+  *          no cursor leads into are never entered, so deep build trees next to the test output
+  *          cost nothing. With a DirectoryWalker each directory is opened relative to its parent
+  *          and listed or probed through that descriptor. A walk can stop at the directories
+  *          binding a project and leave them to the caller, to be walked in parallel. The matcher
+  *          is not changed by a walk and may be shared between threads.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#ifndef BRANCHLAYOUTMATCHER_H
+#define BRANCHLAYOUTMATCHER_H
+
+#include <QList>
+#include <QRegExp>
+#include <QString>
+#include <QStringList>
+#include <DirectoryWalker.h>
+#include <Model/BranchLayout.h>
+
+class BranchLayoutMatcher
+{
+public:
+    enum Role
+    {
+        Tlog,
+        Lcov,
+        Info
+    };
+
+    class Match
+    {
+    public:
+        Match() : role(Tlog), priority(0), modified(-1), size(-1) {}
+        QString project;
+        QString library;
+        Role role;
+        // position of the template among those of its role, lower ones win
+        int priority;
+        QString filePath;
+        qint64 modified;
+        qint64 size;
+    };
+
+    class Cursor
+    {
+    public:
+        Cursor() : rule(0), segment(0) {}
+        int rule;
+        int segment;
+        QString project;
+        QString library;
+    };
+
+    class Step
+    {
+    public:
+        Step() : depth(0), directoryFd(-1) {}
+        QString path;
+        int depth;
+        // open while the walk is in the directory, a walk opens a step without one by its path
+        int directoryFd;
+        QList<Cursor> cursors;
+    };
+
+    explicit BranchLayoutMatcher(const Model::BranchLayout &layout = Model::BranchLayout());
+    bool isValid() const;
+    QString getError() const;
+    Step createStep(const QString &branchPath, const QString &project = QString(),
+                    const QString &library = QString()) const;
+    void walk(const Step &step, DirectoryWalker *walker, QList<Match> &matches,
+              QList<Step> *projectSteps = 0) const;
+
+protected:
+    class Segment
+    {
+    public:
+        enum Kind
+        {
+            Name,
+            Pattern,
+            AnyDepth
+        };
+        Segment() : kind(Name), hasGlob(false) {}
+        Kind kind;
+        QString text;
+        bool hasGlob;
+        QRegExp pattern;
+        // placeholder of each capture group of the pattern
+        QStringList captures;
+    };
+
+    class Rule
+    {
+    public:
+        Rule() : role(Tlog), priority(0) {}
+        Role role;
+        int priority;
+        QList<Segment> segments;
+    };
+
+    bool compile(const QString &pathTemplate, Role role, int priority);
+    bool compileExcludes(const QStringList &patterns, QList<QRegExp> &excludes);
+    bool resolveName(const Segment &segment, const Cursor &cursor, QString &name) const;
+    bool bind(const Segment &segment, const QString &name, Cursor &cursor) const;
+    bool isExcluded(const QList<QRegExp> &excludes, const QString &name) const;
+    void probeFile(const Step &step, const QString &name, const Cursor &cursor,
+                   DirectoryWalker *walker, QList<Match> &matches) const;
+    bool list(const Step &step, DirectoryWalker *walker, QStringList &directories,
+              QStringList &files) const;
+
+private:
+    QList<Rule> m_rules;
+    QList<QRegExp> m_projectExcludes;
+    QList<QRegExp> m_libraryExcludes;
+    QString m_error;
+};
+
+#endif // BRANCHLAYOUTMATCHER_H
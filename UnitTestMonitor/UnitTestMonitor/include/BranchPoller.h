@@ -0,0 +1,117 @@
+/**
+  * @file BranchPoller.h
+  *
+  * @class BranchPoller
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Polls branches whose file system sends no change notifications
+  * @details On NFS mounts inotify events of other hosts never arrive, so the poller probes every
+  *          branch of a monitor set on its own schedule. A probe stats the branch directory and
+  *          the directories of the libraries first; the tlog and lcov reports are only compared
+  *          with the fingerprints of the last scan where their directory changed. Only a changed
+  *          directory is searched, by the branch layout, for new projects and libraries; the
+  *          first probe of a branch just takes the baseline. Changed and new libraries are
+  *          reported as library keys "<project>/<library>", so they are updated the way the branch
+  *          watcher's changes are, instead of rescanning the branch. The interval of a branch
+  *          shrinks towards a quarter of the average time between its observed changes and grows by
+  *          half after every probe without a change, bounded by the minimum and maximum interval.
+  *          Probes run on a worker thread and never touch the model, they work on a copy of the
+  *          paths and fingerprints taken on the GUI thread.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#ifndef BRANCHPOLLER_H
+#define BRANCHPOLLER_H
+
+#include <QObject>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QSet>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+#include <Model/Branch.h>
+#include <Model/Fingerprint.h>
+#include <BranchLayoutMatcher.h>
+
+class BranchPoller : public QObject
+{
+    Q_OBJECT
+
+public:
+    class LibraryProbe
+    {
+    public:
+        QString key;
+        QString tlogFilePath;
+        QString lcovFilePath;
+        QString infoFilePath;
+        Model::Fingerprint tlogFingerprint;
+        Model::Fingerprint lcovFingerprint;
+        Model::Fingerprint infoFingerprint;
+    };
+
+    class BranchProbe
+    {
+    public:
+        BranchProbe() : branchModified(-1) {}
+        QString branchPath;
+        Model::BranchLayout layout;
+        qint64 branchModified;
+        QSet<QString> projectNames;
+        // directory holding the output directories of libraries -> their project
+        QMap<QString, QString> libraryDirectories;
+        // directory of a library or of its reports -> its modification time, -1 if never probed
+        QMap<QString, qint64> directoriesModified;
+        QList<LibraryProbe> libraries;
+        QStringList changedLibraryKeys;
+    };
+
+    explicit BranchPoller(QObject *parent = 0);
+    BranchPoller& withIntervals(int minSeconds, int maxSeconds);
+    int getMinInterval() const;
+    int getMaxInterval() const;
+    int getInterval(const QString &branchPath) const;
+    bool isProbing() const;
+    void poll(const QList<QSharedPointer<Model::Branch> > &branches);
+    void forgetBranch(const QString &branchPath);
+    static QList<BranchProbe> probeBranches(const QList<BranchProbe> &probes);
+
+signals:
+    void librariesChanged(const QString &branchPath, const QStringList &libraryKeys);
+
+protected slots:
+    void handleFinishedProbe();
+
+protected:
+    class Schedule
+    {
+    public:
+        Schedule() : interval(0), nextProbe(0), lastChange(-1), changeGap(-1.0),
+            branchModified(-1) {}
+        int interval;
+        qint64 nextProbe;
+        qint64 lastChange;
+        double changeGap;
+        qint64 branchModified;
+        QMap<QString, qint64> directoriesModified;
+    };
+
+    BranchProbe createProbe(const QSharedPointer<Model::Branch> &branch) const;
+    static void probeBranch(BranchProbe &probe);
+    static void walkProject(BranchProbe &probe, const BranchLayoutMatcher &matcher,
+                            const QString &projectName, const QSet<QString> &knownKeys);
+    void reschedule(Schedule &schedule, bool changed, qint64 now);
+
+private:
+    int m_minInterval;
+    int m_maxInterval;
+    QHash<QString, Schedule> m_schedules;
+    QFutureWatcher<QList<BranchProbe> > m_probeWatcher;
+};
+
+#endif // BRANCHPOLLER_H
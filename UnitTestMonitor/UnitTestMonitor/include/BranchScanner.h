@@ -8,7 +8,8 @@
   *
   * @brief Scans a branch directory for unit test data
   * @details The branch scanner scans a directory structure for libraries with tests, tlog, and lcov
-  *          reports.
+  *          reports. The tlogs and reports are found by the templates of the branch's layout;
+  *          changed libraries are parsed newest first and published as soon as they are done.
   *
   * @author Robert Wloch, robert@rowlo.de
   *************************************************************************************************/
@@ -17,19 +18,148 @@
 
 #include <Model/Branch.h>
 #include <Model/Library.h>
+#include <Model/Fingerprint.h>
+#include <Model/Coverage.h>
+#include <Model/FileCoverage.h>
+#include <BranchLayoutMatcher.h>
+#include <ScanProgress.h>
+#include <ScanThrottle.h>
+#include <TlogParser.h>
+#include <QHash>
+#include <QList>
+#include <QMutex>
 #include <QSharedPointer>
 #include <QString>
+#include <QStringList>
 
 class BranchScanner
 {
 public:
     BranchScanner();
-    QSharedPointer<Model::Branch> scanBranch(const QString &path);
+    BranchScanner& withParallelScan(bool parallel, int maxThreadCount = 0);
+    bool isParallelScan() const;
+    int getMaxThreadCount() const;
+    BranchScanner& withIncrementalScan(bool incremental, bool contentHashing = false);
+    bool isIncrementalScan() const;
+    bool isContentHashing() const;
+    BranchScanner& withNativeWalk(bool nativeWalk);
+    bool isNativeWalk() const;
+    BranchScanner& withProgress(const QSharedPointer<ScanProgress> &progress);
+    QSharedPointer<ScanProgress> getProgress() const;
+    BranchScanner& withBackgroundScan(bool background, qint64 bytesPerSecond = 0);
+    bool isBackgroundScan() const;
+    qint64 getBytesPerSecond() const;
+    BranchScanner& withBatchedReads(bool batchedReads);
+    bool isBatchedReads() const;
+    BranchScanner& withTailIngestion(bool tailIngestion);
+    bool isTailIngestion() const;
+    QSharedPointer<Model::Branch> scanBranch(const QString &path,
+                                             const Model::BranchLayout &layout);
     QSharedPointer<Model::Branch> updateBranch(const QSharedPointer<Model::Branch> &branch);
+    QSharedPointer<Model::Branch> updateLibraries(const QSharedPointer<Model::Branch> &branch,
+                                                  const QStringList &libraryKeys);
+
+    class LibraryCandidate
+    {
+    public:
+        QString name;
+        QString path;
+        QString tlogFilePath;
+        QString lcovFilePath;
+        QString infoFilePath;
+        Model::Fingerprint tlogFingerprint;
+        Model::Fingerprint lcovFingerprint;
+        Model::Fingerprint infoFingerprint;
+    };
+
+    class ProjectCandidate
+    {
+    public:
+        QString name;
+        QString path;
+        QList<LibraryCandidate> libraries;
+    };
+
+    class ProjectWalk
+    {
+    public:
+        BranchLayoutMatcher::Step step;
+        QList<BranchLayoutMatcher::Match> matches;
+    };
+
+    class TlogTails
+    {
+    public:
+        QSharedPointer<TlogParser> take(const QString &tlogFilePath);
+        bool contains(const QString &tlogFilePath);
+        void put(const QString &tlogFilePath, const QSharedPointer<TlogParser> &parser);
+        QList<QSharedPointer<TlogParser> > takeStale(const QString &branchPath,
+                                                     qint64 modifiedBefore);
+    private:
+        QMutex m_mutex;
+        QHash<QString, QSharedPointer<TlogParser> > m_parsers;
+    };
+
+    class TlogJob
+    {
+    public:
+        QString tlogFilePath;
+        QSharedPointer<Model::Library> library;
+        Model::Fingerprint fingerprint;
+    };
+
+    class CoverageJob
+    {
+    public:
+        CoverageJob() : fromReport(false), parsed(false) {}
+        // a tracefile, or the index.html of a genhtml report if the library has no tracefile
+        QString filePath;
+        bool fromReport;
+        QSharedPointer<Model::Library> library;
+        Model::Fingerprint fingerprint;
+        Model::Coverage coverage;
+        QList<Model::FileCoverage> fileCoverages;
+        bool parsed;
+    };
+
 protected:
+    bool isCancelled() const;
+    bool throttle(qint64 bytes) const;
+    BranchLayoutMatcher createMatcher(const QSharedPointer<Model::Branch> &branch) const;
+    void walkProject(const BranchLayoutMatcher &matcher, ProjectWalk &walk) const;
+    QList<ProjectCandidate> collectCandidates(
+            const QString &branchPath, const QList<BranchLayoutMatcher::Match> &matches) const;
+    void ingestCandidates(const QSharedPointer<Model::Branch> &branch,
+                          const QList<ProjectCandidate> &projectCandidates,
+                          qint64 timestamp);
+    void analyzeCoverage(QList<CoverageJob> &jobs);
+    void parseCoverage(CoverageJob &job) const;
+    void analyzeTlogs(const QList<TlogJob> &jobs, qint64 timestamp);
+    void ingestTlogBatch(const QList<TlogJob> &jobs, qint64 timestamp);
+    void ingestTlog(const TlogJob &job, qint64 timestamp, const QByteArray *content = 0);
+    bool tailTlog(const TlogJob &job, qint64 timestamp);
+    void closeStaleTails(const QString &branchPath);
     void analyzeTlog(const QString &tlogFilePath,
                      const QSharedPointer<Model::Library> &library,
-                     qint64 timestamp);
+                     qint64 timestamp, const QByteArray *content = 0);
+    void dropRepeatedTestruns(const TlogJob &job, qint64 timestamp,
+                              const QByteArray &tlogHash) const;
+private:
+    bool m_parallelScan;
+    int m_maxThreadCount;
+    bool m_incrementalScan;
+    bool m_contentHashing;
+    bool m_nativeWalk;
+    bool m_batchedReads;
+    QSharedPointer<ScanProgress> m_progress;
+    QSharedPointer<ScanThrottle> m_throttle;
+    QSharedPointer<TlogTails> m_tlogTails;
+
+    friend class WalkProjectTask;
+    friend class ParseCoverageTask;
+    friend class AnalyzeTlogTask;
+    friend class AnalyzeTlogBatchTask;
+    friend class TlogBatchConsumer;
 };
 
 #endif // BRANCHSCANNER_H
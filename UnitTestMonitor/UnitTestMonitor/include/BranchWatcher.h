@@ -0,0 +1,69 @@
+/**
+  * @file BranchWatcher.h
+  *
+  * @class BranchWatcher
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Watches the test output directories of branches
+  * @details The branch watcher registers file system watches on the tests and testcoverage
+  *          directories of every library of a watched branch. Changes are debounced and reported
+  *          per branch as a set of library keys "<project>/<library>".
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#ifndef BRANCHWATCHER_H
+#define BRANCHWATCHER_H
+
+#include <QObject>
+#include <QFileSystemWatcher>
+#include <QHash>
+#include <QMap>
+#include <QPair>
+#include <QSet>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+#include <Model/Branch.h>
+
+class BranchWatcher : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit BranchWatcher(QObject *parent = 0);
+    void setDebounceInterval(int msecs);
+    void watchBranch(const QSharedPointer<Model::Branch> &branch);
+    void unwatchBranch(const QString &branchPath);
+    void unwatchAll();
+    bool isWatching(const QString &branchPath) const;
+    bool hasPendingLibraries() const;
+    QStringList pendingBranches() const;
+    QStringList takePendingLibraries(const QString &branchPath);
+
+public slots:
+    void addPendingLibraries(const QString &branchPath, const QStringList &libraryKeys);
+
+signals:
+    void librariesChanged();
+
+protected slots:
+    void handlePathChanged(const QString &path);
+    void emitPendingChanges();
+
+protected:
+    void watchPath(const QString &path, const QString &branchPath, const QString &libraryKey);
+
+private:
+    QFileSystemWatcher m_fileSystemWatcher;
+    QTimer m_debounceTimer;
+    // watched path -> (branch path, library key)
+    QHash<QString, QPair<QString, QString> > m_watchedPaths;
+    // branch path -> changed library keys
+    QMap<QString, QSet<QString> > m_changedLibraries;
+    QMap<QString, QSet<QString> > m_pendingLibraries;
+};
+
+#endif // BRANCHWATCHER_H
@@ -0,0 +1,68 @@
+/**
+  * @file CoverageDelta.h
+  *
+  * @class CoverageDelta
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Compares the coverage of two runs file by file and line by line
+  * @details Both runs hand in their FileCoverages ordered by path, so the files are paired in one
+  *          walk over both lists, and the sorted line and function arrays of a pair are walked side
+  *          by side the same way. Nothing is hashed or looked up, a comparison is linear in the
+  *          instrumented lines of both runs. A line or function gained coverage if it ran in the
+  *          newer run only and lost it if it ran in the older run only. Lines and functions that
+  *          exist in one run only are counted as added or removed, they are neither gained nor
+  *          lost. Line numbers are compared as they are, an edit moving code shows up as losses
+  *          and gains. The files with changes are ordered by impact, the number of lines that
+  *          changed coverage, losses first.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#ifndef COVERAGEDELTA_H
+#define COVERAGEDELTA_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <Model/FileCoverage.h>
+
+class CoverageDelta
+{
+public:
+    class FileDelta
+    {
+    public:
+        FileDelta() : addedLines(0), removedLines(0) {}
+        int getImpact() const;
+        QString scope;
+        QString path;
+        QVector<qint64> gainedLines;
+        QVector<qint64> lostLines;
+        QStringList gainedFunctions;
+        QStringList lostFunctions;
+        qint64 addedLines;
+        qint64 removedLines;
+    };
+
+    CoverageDelta();
+    void compare(const QString &scope, const QList<Model::FileCoverage> &older,
+                 const QList<Model::FileCoverage> &newer);
+    QList<FileDelta> getFileDeltas() const;
+    qint64 getGainedLines() const;
+    qint64 getLostLines() const;
+    qint64 getComparedFiles() const;
+    static QString formatLines(const QVector<qint64> &lines);
+protected:
+    static FileDelta compareFiles(const Model::FileCoverage &older,
+                                  const Model::FileCoverage &newer);
+    void addFileDelta(const FileDelta &fileDelta);
+private:
+    QList<FileDelta> m_fileDeltas;
+    qint64 m_gainedLines;
+    qint64 m_lostLines;
+    qint64 m_comparedFiles;
+};
+
+#endif // COVERAGEDELTA_H
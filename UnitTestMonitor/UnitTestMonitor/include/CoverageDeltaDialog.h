@@ -0,0 +1,58 @@
+/**
+  * @file CoverageDeltaDialog.h
+  *
+  * @class CoverageDeltaDialog
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Dialog showing how the coverage changed between two runs
+  * @details The CoverageDeltaDialog lists every source file whose coverage differs between an
+  *          older and a newer run, the files losing most coverage first. Selecting a file shows
+  *          the lines and functions that lost and gained coverage, consecutive lines joined into
+  *          ranges. The comparison itself is done by a CoverageDelta, the dialog only shows it.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#ifndef COVERAGEDELTADIALOG_H
+#define COVERAGEDELTADIALOG_H
+
+#include <QDialog>
+#include <QList>
+#include <CoverageDelta.h>
+
+class QColor;
+class QModelIndex;
+class QSortFilterProxyModel;
+class QStandardItem;
+class QStandardItemModel;
+
+namespace Ui {
+class CoverageDeltaDialog;
+}
+
+class CoverageDeltaDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit CoverageDeltaDialog(QWidget *parent = 0);
+    ~CoverageDeltaDialog();
+    void initialize(const CoverageDelta &delta, const QString &olderRun, const QString &newerRun);
+
+protected slots:
+    void storeGeometry();
+    void showFileDelta(const QModelIndex &index);
+
+protected:
+    QStandardItem* createItem(const QString &text, const QVariant &sortValue);
+    QStandardItem* createCountItem(qint64 count, const QColor &color);
+
+private:
+    Ui::CoverageDeltaDialog *ui;
+    QStandardItemModel *m_filesModel;
+    QSortFilterProxyModel *m_filesProxyModel;
+    QList<CoverageDelta::FileDelta> m_fileDeltas;
+};
+
+#endif // COVERAGEDELTADIALOG_H
@@ -0,0 +1,102 @@
+/**
+  * @file CoverageMerger.h
+  *
+  * @class CoverageMerger
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Merges the coverage of all libraries of a branch into project and branch coverage
+  * @details Like lcov -a the merger adds up the execution counts a source file has in the
+  *          tracefiles of several libraries, so a header shared by libraries counts once. The
+  *          latest run of every library is read from its CoverageHistory. The source files are
+  *          split into chunks merged in parallel on a pool; a chunk is handled one source file at
+  *          a time, only that file is decoded from the histories holding it, so memory stays
+  *          bounded by one file per library. The copies of a file are merged pairwise in a tree,
+  *          first within each project and then the project results into the branch result.
+  *          Branches are counted per file only, the copy covering most of them is taken. The
+  *          partial results of the chunks are added up in a tree as well. Libraries known from
+  *          their genhtml report only have no file coverage and are left out.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#ifndef COVERAGEMERGER_H
+#define COVERAGEMERGER_H
+
+#include <QList>
+#include <QMap>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+#include <Model/Branch.h>
+#include <Model/Coverage.h>
+#include <Model/CoverageHistory.h>
+#include <Model/FileCoverage.h>
+
+class CoverageMerger
+{
+public:
+    class Source
+    {
+    public:
+        Source() : timestamp(-1) {}
+        QString project;
+        Model::CoverageHistory history;
+        qint64 timestamp;
+    };
+
+    class Result
+    {
+    public:
+        Result() : branchTimestamp(-1), sources(0), files(0) {}
+        QString signature;
+        QMap<QString, Model::Coverage> projects;
+        QMap<QString, qint64> projectTimestamps;
+        Model::Coverage branch;
+        qint64 branchTimestamp;
+        int sources;
+        int files;
+    };
+
+    static QList<Source> collectSources(const QSharedPointer<Model::Branch> &branch,
+                                        QString &signature);
+    static Result merge(const QList<Source> &sources, const QString &signature);
+    static Model::FileCoverage mergeFiles(const Model::FileCoverage &left,
+                                          const Model::FileCoverage &right);
+
+protected:
+    // line, function, and branch counts added up over files or chunks
+    class Counts
+    {
+    public:
+        Counts() : linesFound(0), linesHit(0), functionsFound(0), functionsHit(0),
+            branchesFound(0), branchesHit(0) {}
+        void add(const Model::FileCoverage &fileCoverage);
+        void add(const Counts &other);
+        Model::Coverage toCoverage() const;
+        qint64 linesFound;
+        qint64 linesHit;
+        qint64 functionsFound;
+        qint64 functionsHit;
+        qint64 branchesFound;
+        qint64 branchesHit;
+    };
+
+    class Partial
+    {
+    public:
+        Partial() : files(0) {}
+        void add(const Partial &other);
+        QMap<QString, Counts> projects;
+        Counts branch;
+        int files;
+    };
+
+    static Model::FileCoverage reduce(QList<Model::FileCoverage> fileCoverages);
+    static void mergeChunk(const QList<Source> &sources, const QStringList &paths,
+                           Partial &partial);
+
+    friend class MergeChunkTask;
+};
+
+#endif // COVERAGEMERGER_H
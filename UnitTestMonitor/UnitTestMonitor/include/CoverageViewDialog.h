@@ -0,0 +1,67 @@
+/**
+  * @file CoverageViewDialog.h
+  *
+  * @class CoverageViewDialog
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Dialog showing the coverage of a library from its lcov tracefile
+  * @details The CoverageViewDialog lists the source files of a tracefile with their line,
+  *          function, and branch coverage, and shows the selected source file with the execution
+  *          count of every line next to it. No html is rendered: the file table is filled from one
+  *          parse of the tracefile and the source view only asks a SourceCoverageModel for the
+  *          rows it paints. The genhtml report can still be opened from the dialog if the
+  *          application was built with WebKit.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#ifndef COVERAGEVIEWDIALOG_H
+#define COVERAGEVIEWDIALOG_H
+
+#include <QDialog>
+#include <QList>
+#include <Model/FileCoverage.h>
+
+class QModelIndex;
+class QSortFilterProxyModel;
+class QStandardItem;
+class QStandardItemModel;
+class SourceCoverageModel;
+
+namespace Ui {
+class CoverageViewDialog;
+}
+
+class CoverageViewDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit CoverageViewDialog(QWidget *parent = 0);
+    ~CoverageViewDialog();
+    bool initializeForTracefile(const QString &infoPath, const QString &lcovPath = QString());
+
+signals:
+    void reportRequested(const QString &lcovPath);
+
+protected slots:
+    void storeGeometry();
+    void showSourceFile(const QModelIndex &index);
+    void showNextUncoveredLine();
+    void requestReport();
+
+protected:
+    QStandardItem* createItem(const QString &text, const QVariant &sortValue);
+    QStandardItem* createRateItem(qint64 found, qint64 hit);
+
+private:
+    Ui::CoverageViewDialog *ui;
+    QStandardItemModel *m_filesModel;
+    QSortFilterProxyModel *m_filesProxyModel;
+    SourceCoverageModel *m_sourceModel;
+    QList<Model::FileCoverage> m_sourceFiles;
+    QString m_lcovPath;
+};
+
+#endif // COVERAGEVIEWDIALOG_H
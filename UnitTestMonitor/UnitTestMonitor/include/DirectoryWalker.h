@@ -0,0 +1,50 @@
+/**
+  * @file DirectoryWalker.h
+  *
+  * @class DirectoryWalker
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Lists directories and probes files with few file system calls
+  * @details On Linux the walker lists a directory with getdents64 and takes the file type from
+  *          d_type, so telling directories from files needs no stat. A directory is opened with
+  *          openat relative to its open parent, and files are probed with one fstatat relative
+  *          to their directory, so the path above it is not resolved again. The walker
+  *          counts its system calls and estimates the calls a QDir/QFileInfo walk of the same
+  *          tree would have made. Elsewhere isSupported() is false and callers keep using QDir.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#ifndef DIRECTORYWALKER_H
+#define DIRECTORYWALKER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+class DirectoryWalker
+{
+public:
+    DirectoryWalker();
+    static bool isSupported();
+    int openDirectory(const QString &path);
+    int openDirectory(int directoryFd, const QString &name);
+    void closeDirectory(int directoryFd);
+    bool listDirectories(const QString &path, QStringList &names);
+    bool listEntries(int directoryFd, QStringList &directories, QStringList &files);
+    bool statFile(int directoryFd, const QString &name, qint64 &modified, qint64 &size);
+    qint64 getSyscalls() const;
+    qint64 getEstimatedQDirSyscalls() const;
+    qint64 getSavedSyscalls() const;
+protected:
+    int openAt(int directoryFd, const QByteArray &path);
+    bool readEntries(int directoryFd, QList<QByteArray> &directories, QList<QByteArray> *files);
+    bool statAt(int directoryFd, const QByteArray &path, qint64 &modified, qint64 &size);
+private:
+    qint64 m_syscalls;
+    qint64 m_estimatedQDirSyscalls;
+};
+
+#endif // DIRECTORYWALKER_H
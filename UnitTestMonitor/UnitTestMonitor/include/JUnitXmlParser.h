@@ -0,0 +1,71 @@
+/**
+  * @file JUnitXmlParser.h
+  *
+  * @class JUnitXmlParser
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Parses JUnit xml reports into the model
+  * @details The JUnit xml parser streams reports written by GoogleTest or ctest through a
+  *          QXmlStreamReader reading directly from the file. Every testsuite becomes a testcase
+  *          and every testcase element becomes a test function result with its time and failure
+  *          message. Test output captured in system-out or system-err is skipped.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#ifndef JUNITXMLPARSER_H
+#define JUNITXMLPARSER_H
+
+#include <Model/Library.h>
+#include <Model/Testcase.h>
+#include <Model/Testfunction.h>
+#include <QList>
+#include <QSharedPointer>
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+class QXmlStreamReader;
+
+class JUnitXmlParser
+{
+public:
+    JUnitXmlParser();
+    static bool isJUnitXml(const QString &reportFilePath);
+    static bool isJUnitXmlHead(const QByteArray &head);
+    bool parse(const QString &reportFilePath,
+               const QSharedPointer<Model::Library> &library,
+               qint64 timestamp);
+    qint64 getBytesParsed() const;
+protected:
+    void handleStartElement(QXmlStreamReader &reader);
+    void handleEndElement(QXmlStreamReader &reader);
+    void endTestsuite(int endLine);
+    void recordTestcase();
+private:
+    QString m_reportFilePath;
+    QSharedPointer<Model::Library> m_library;
+    qint64 m_timestamp;
+    qint64 m_bytesParsed;
+
+    QSharedPointer<Model::Testcase> m_testcase;
+    int m_testsuiteStartLine;
+    qint32 m_passed;
+    qint32 m_failed;
+    qint32 m_skipped;
+    double m_testsuiteDuration;
+    QList<Model::Testfunction> m_testfunctions;
+    QStringList m_failLog;
+
+    bool m_inTestcase;
+    QString m_testcaseName;
+    QString m_testcaseFile;
+    int m_testcaseLine;
+    double m_testcaseDuration;
+    QString m_incident;
+    QString m_message;
+    bool m_inMessage;
+};
+
+#endif // JUNITXMLPARSER_H
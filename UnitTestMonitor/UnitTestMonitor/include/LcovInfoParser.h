@@ -0,0 +1,64 @@
+/**
+  * @file LcovInfoParser.h
+  *
+  * @class LcovInfoParser
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Sums up the coverage of an lcov tracefile
+  * @details The parser memory maps a .info tracefile and walks its records line by line without
+  *          decoding them into strings. DA, FN, FNDA, and BRDA records are counted per source
+  *          file, so a source file listed by several sections, as headers are in tracefiles of
+  *          several test binaries, counts once with the union of its hits. A section without DA
+  *          records contributes its LF and LH summary instead. If a tracefile cannot be mapped it
+  *          is read into memory and parsed the same way. The execution counts of every source file
+  *          are handed out as FileCoverages, for viewers and comparisons.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#ifndef LCOVINFOPARSER_H
+#define LCOVINFOPARSER_H
+
+#include <Model/Coverage.h>
+#include <Model/FileCoverage.h>
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+class LcovInfoParser
+{
+public:
+    LcovInfoParser();
+    bool parse(const QString &infoFilePath);
+    void parseData(const char *data, qint64 size);
+    Model::Coverage getCoverage() const;
+    int getSourceFilesCount() const;
+    QList<Model::FileCoverage> getFileCoverages() const;
+protected:
+    class SourceCoverage
+    {
+    public:
+        // line number or function name -> execution count summed over all sections
+        QHash<qint64, qint64> lines;
+        QHash<QByteArray, qint64> functions;
+        // branch "<line>,<block>,<branch>" -> taken
+        QHash<QByteArray, bool> branches;
+    };
+
+    void reset();
+    void handleRecord(const char *begin, const char *end);
+    void closeSection();
+private:
+    Q_DISABLE_COPY(LcovInfoParser)
+    QHash<QByteArray, SourceCoverage> m_sources;
+    SourceCoverage *m_source;
+    bool m_sectionHasLines;
+    qint64 m_sectionLinesFound;
+    qint64 m_sectionLinesHit;
+    qint64 m_summaryLinesFound;
+    qint64 m_summaryLinesHit;
+};
+
+#endif // LCOVINFOPARSER_H
@@ -0,0 +1,59 @@
+/**
+  * @file LcovSummaryParser.h
+  *
+  * @class LcovSummaryParser
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Reads the headline numbers of a genhtml report without rendering it
+  * @details The parser reads the index.html of a genhtml report in small chunks and only looks at
+  *          its table cells, until the ruler below the header or a limit of bytes is reached. It
+  *          takes the hit and total counts of the Lines, Functions, and Branches rows and the
+  *          value of the Date row. genhtml before and since lcov 2 order the counts differently,
+  *          so the smaller count of a row is taken as hit. The rate cells are skipped, the rates
+  *          are computed from the counts.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#ifndef LCOVSUMMARYPARSER_H
+#define LCOVSUMMARYPARSER_H
+
+#include <Model/Coverage.h>
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+class LcovSummaryParser
+{
+public:
+    LcovSummaryParser();
+    bool parse(const QString &reportFilePath);
+    int parseData(const QByteArray &data);
+    bool isComplete() const;
+    Model::Coverage getCoverage() const;
+    QString getDate() const;
+protected:
+    enum Label
+    {
+        NoLabel,
+        LinesLabel,
+        FunctionsLabel,
+        BranchesLabel,
+        DateLabel
+    };
+
+    void reset();
+    void handleCell(const QByteArray &cssClass, const QByteArray &text);
+    void closeLabel();
+private:
+    Q_DISABLE_COPY(LcovSummaryParser)
+    Label m_label;
+    QList<qint64> m_counts;
+    int m_cells;
+    bool m_complete;
+    Model::Coverage m_coverage;
+    QString m_date;
+};
+
+#endif // LCOVSUMMARYPARSER_H
@@ -15,6 +15,7 @@
 #define MAINWINDOW_H
 
 #include <QAtomicInt>
+#include <QElapsedTimer>
 #include <QFutureWatcher>
 #include <QPair>
 #include <QMap>
@@ -26,14 +27,25 @@
 #include <QStandardItemModel>
 #include <Model/MonitorSet.h>
 #include <Model/Branch.h>
+#include <Model/Library.h>
+#include <Model/Testcase.h>
 #include <Model/Testrun.h>
 #include <BranchScanner.h>
+#include <BranchWatcher.h>
+#include <BranchPoller.h>
+#include <BenchmarkTrend.h>
+#include <CoverageMerger.h>
+#include <ScanProgress.h>
 #include <QMutex>
 
 class QMenu;
 class QPushButton;
+class QProgressBar;
 class TlogViewDialog;
+class SlowTestsDialog;
 class LcovBrowserDialog;
+class CoverageViewDialog;
+class CoverageDeltaDialog;
 
 namespace Ui
 {
@@ -54,8 +66,21 @@ protected:
     bool isTestSelected();
     bool isTestrunSelected();
     void enableIOActions(bool enabled);
+    QList<qint64> groupRunColumns(const QList<qint64> &timestamps);
+    qint64 getRunColumnKey(qint64 timestamp) const;
     void fillMissingRuns(const QList<qint64> testrunKeys,
                                      QMap<qint64, QSharedPointer<Model::Testrun> > &runsMap);
+    void appendCoverageRow(
+            QStandardItem *parentItem, int columnCount, const QList<qint64> &testrunKeys,
+            const QMap<qint64, Model::Coverage> &coverages, const QString &title = QString());
+    QString formatRate(double rate) const;
+    bool isComparisonSelected();
+    QList<Model::FileCoverage> getColumnFileCoverages(
+            const QSharedPointer<Model::Library> &library, qint64 columnKey) const;
+    int appendFunctionRows(
+            QStandardItem *testcaseItem, int columnCount, int trendColumn,
+            const QSharedPointer<Model::Testcase> &testcase,
+            const QList<QSharedPointer<Model::Testrun> > &columnTestruns);
     void appendFilledRow(
             QStandardItem *parentItem, int columnCount,
             QStandardItem *firstItem, const QMap<int, QPair<int, QIcon> > &icons,
@@ -64,6 +89,11 @@ protected:
     void pushRecentMonitorSetFile(const QString &recentFile);
     void updateRecentFilesMenu();
     bool openMonitorSetFile(const QString& fileName);
+    void startScanProgress();
+    void updateScanProgress();
+    void stopScanProgress();
+    bool isLibraryBusy(const QSharedPointer<Model::Library> &library) const;
+    bool askBranchLayout(const QString &branchName, Model::BranchLayout &layout);
 
 protected slots:
     void resetUi();
@@ -77,13 +107,22 @@ protected slots:
     void on_addBranchToolButton_clicked();
     void on_removeBranchToolButton_clicked();
     void on_updateBranchToolButton_clicked();
+    void on_watchBranchToolButton_clicked();
     void on_viewLcovToolButton_clicked();
+    void on_compareCoverageToolButton_clicked();
     void on_viewTlogToolButton_clicked();
+    void on_slowTestsToolButton_clicked();
     void on_deleteTestrunToolButton_clicked();
 
     void handleFinishedOpenMonitorSet();
     void handleFinishedSaveMonitorSet();
     void handleFinishedScanBranch();
+    void handleFinishedCoverageMerge();
+    void processWatchedBranches();
+    void editBranchLayout();
+    void showLcovReport(const QString &lcovPath);
+    void pollBranches();
+    void cancelScan();
 
     void initializeBranchTableModel();
     void updateBranchTabs();
@@ -101,13 +140,28 @@ private:
     QFutureWatcher<QSharedPointer<Model::MonitorSet> > watcherOpenMonitorSet;
     QFutureWatcher<bool> watcherSaveMonitorSet;
     QFutureWatcher<QSharedPointer<Model::Branch> > watcherScanBranch;
+    QFutureWatcher<CoverageMerger::Result> m_coverageMergeWatcher;
+    CoverageMerger::Result m_mergedCoverage;
     QStandardItemModel* m_branchTableModel;
     QSharedPointer<Model::MonitorSet> m_monitorSet;
     BranchScanner m_branchScanner;
+    BranchWatcher m_branchWatcher;
+    BranchPoller m_branchPoller;
+    BenchmarkTrend m_benchmarkTrend;
+    QSharedPointer<ScanProgress> m_scanProgress;
+    QProgressBar* m_scanProgressBar;
+    QPushButton* m_cancelScanButton;
+    QSharedPointer<Model::Branch> m_scanPreviewBranch;
+    QSharedPointer<Model::Branch> m_shownBranch;
+    int m_shownPublications;
+    QElapsedTimer m_scanPreviewTimer;
+    bool m_backgroundScan;
+    bool m_scanRunning;
     QAtomicInt m_ioBlocked;
     QTimer m_openPollTimer;
     QTimer m_savePollTimer;
     QTimer m_scanPollTimer;
+    QTimer m_branchPollTimer;
     QSignalMapper m_branchTabsSignalMapper;
     QSharedPointer<Model::Branch> m_selectedBranch;
     QStringList m_recentMonitorSetFiles;
@@ -117,9 +171,16 @@ private:
     QStandardItem* m_selectedLibrary;
     QStandardItem* m_selectedTestcase;
     qint64 m_selectedTestrun;
+    qint64 m_comparedTestrun;
     TlogViewDialog* tlogViewDialog;
+    SlowTestsDialog* slowTestsDialog;
     LcovBrowserDialog* lcovBrowserDialog;
+    CoverageViewDialog* coverageViewDialog;
+    CoverageDeltaDialog* coverageDeltaDialog;
     QMap<int, qint64> m_headerTimestamps;
+    qint64 m_runGroupWindow;
+    QMap<qint64, qint64> m_runColumnKeys;
+    qint64 m_backgroundBytesPerSecond;
 
 };
 
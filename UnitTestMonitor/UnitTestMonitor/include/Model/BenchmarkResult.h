@@ -0,0 +1,49 @@
+/**
+  * @file BenchmarkResult.h
+  *
+  * @class Model::BenchmarkResult
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Model element representing the QBENCHMARK result of a test function within a testrun.
+  * @details A benchmark result is the value per iteration, the number of iterations, the unit of
+  *          the value, and the measurement backend (walltime, tickcounter, callgrind, or perf).
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#ifndef BENCHMARKRESULT_H
+#define BENCHMARKRESULT_H
+
+#include <QString>
+
+namespace Model
+{
+
+class BenchmarkResult
+{
+public:
+    BenchmarkResult();
+    BenchmarkResult(const BenchmarkResult &other);
+    BenchmarkResult& operator=(const BenchmarkResult &other);
+    BenchmarkResult& withValue(const double value);
+    BenchmarkResult& withIterations(const int iterations);
+    BenchmarkResult& withUnit(const QString &unit);
+    BenchmarkResult& withBackend(const QString &backend);
+    double getValue() const;
+    int getIterations() const;
+    QString getUnit() const;
+    QString getBackend() const;
+    bool isEmpty() const;
+    static QString backendFromUnit(const QString &unit);
+    static QString unitFromMetric(const QString &metric);
+private:
+    double m_value;
+    int m_iterations;
+    QString m_unit;
+    QString m_backend;
+};
+
+} // namespace Model
+
+#endif // BENCHMARKRESULT_H
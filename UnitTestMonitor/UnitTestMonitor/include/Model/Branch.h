@@ -18,6 +18,7 @@
 #include <QSharedPointer>
 #include <QMap>
 #include <Model/Project.h>
+#include <Model/BranchLayout.h>
 
 namespace Model
 {
@@ -29,8 +30,12 @@ public:
     Branch(const Branch &other);
     Branch& withPath(const QString &path);
     Branch& withName(const QString &name);
+    Branch& withWatched(bool watched);
+    Branch& withLayout(const BranchLayout &layout);
     QString getPath() const;
     QString getName() const;
+    bool isWatched() const;
+    BranchLayout getLayout() const;
     QSharedPointer<Project> getProject(const QString &name) const;
     void addProject(QSharedPointer<Project> project);
     QList<QSharedPointer<Project> > getProjects() const;
@@ -38,6 +43,8 @@ public:
 private:
     QString m_path;
     QString m_name;
+    bool m_watched;
+    BranchLayout m_layout;
     QMap<QString, QSharedPointer<Project> > m_projects;
 };
 
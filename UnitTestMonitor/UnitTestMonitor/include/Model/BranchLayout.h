@@ -0,0 +1,62 @@
+/**
+  * @file BranchLayout.h
+  *
+  * @class Model::BranchLayout
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Model element describing where a branch keeps its test output.
+  * @details A layout has path templates for tlogs, lcov reports, and lcov tracefiles, relative to
+  *          the branch directory, and glob patterns of project and library names to skip. A
+  *          template names its project and library with {project} and {library} and may use the
+  *          globs * and ? within a path segment or ** for any number of directories. The templates
+  *          of a kind are tried in their order. A tracefile is optional, a library without one
+  *          just has no coverage numbers. A default constructed layout describes the
+  *          <project>/_/tests/<library>/tlog and <project>/_/testcoverage/<library>/index.html
+  *          structure with the tracefile next to the report. As rules a layout reads and writes
+  *          one line per template or pattern.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#ifndef BRANCHLAYOUT_H
+#define BRANCHLAYOUT_H
+
+#include <QString>
+#include <QStringList>
+
+namespace Model
+{
+
+class BranchLayout
+{
+public:
+    BranchLayout();
+    BranchLayout(const BranchLayout &other);
+    BranchLayout& operator=(const BranchLayout &other);
+    bool operator==(const BranchLayout &other) const;
+    bool operator!=(const BranchLayout &other) const;
+    static BranchLayout fromRules(const QStringList &rules, QStringList *invalidRules = 0);
+    QStringList toRules() const;
+    BranchLayout& withTlogTemplates(const QStringList &templates);
+    BranchLayout& withLcovTemplates(const QStringList &templates);
+    BranchLayout& withInfoTemplates(const QStringList &templates);
+    BranchLayout& withProjectExcludes(const QStringList &patterns);
+    BranchLayout& withLibraryExcludes(const QStringList &patterns);
+    QStringList getTlogTemplates() const;
+    QStringList getLcovTemplates() const;
+    QStringList getInfoTemplates() const;
+    QStringList getProjectExcludes() const;
+    QStringList getLibraryExcludes() const;
+    bool isDefault() const;
+private:
+    QStringList m_tlogTemplates;
+    QStringList m_lcovTemplates;
+    QStringList m_infoTemplates;
+    QStringList m_projectExcludes;
+    QStringList m_libraryExcludes;
+};
+
+} // namespace Model
+
+#endif // BRANCHLAYOUT_H
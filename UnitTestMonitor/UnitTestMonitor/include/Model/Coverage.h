@@ -0,0 +1,57 @@
+/**
+  * @file Coverage.h
+  *
+  * @class Model::Coverage
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Model element holding the code coverage of a library at one point in time.
+  * @details A coverage counts the instrumented and the executed lines, functions, and branches of
+  *          an lcov tracefile or of the header of a genhtml report, which also tells the date the
+  *          report was generated. A rate is a percentage, or -1 if nothing of its kind was found.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#ifndef COVERAGE_H
+#define COVERAGE_H
+
+#include <QString>
+
+namespace Model
+{
+
+class Coverage
+{
+public:
+    Coverage();
+    Coverage(const Coverage &other);
+    Coverage& operator=(const Coverage &other);
+    Coverage& withLines(qint64 found, qint64 hit);
+    Coverage& withFunctions(qint64 found, qint64 hit);
+    Coverage& withBranches(qint64 found, qint64 hit);
+    Coverage& withReportDate(const QString &date);
+    qint64 getLinesFound() const;
+    qint64 getLinesHit() const;
+    qint64 getFunctionsFound() const;
+    qint64 getFunctionsHit() const;
+    qint64 getBranchesFound() const;
+    qint64 getBranchesHit() const;
+    QString getReportDate() const;
+    double getLineRate() const;
+    double getFunctionRate() const;
+    double getBranchRate() const;
+    bool isEmpty() const;
+private:
+    qint64 m_linesFound;
+    qint64 m_linesHit;
+    qint64 m_functionsFound;
+    qint64 m_functionsHit;
+    qint64 m_branchesFound;
+    qint64 m_branchesHit;
+    QString m_reportDate;
+};
+
+} // namespace Model
+
+#endif // COVERAGE_H
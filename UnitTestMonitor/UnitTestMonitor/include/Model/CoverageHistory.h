@@ -0,0 +1,99 @@
+/**
+  * @file CoverageHistory.h
+  *
+  * @class Model::CoverageHistory
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Model element holding the per-file coverage of every run of a library in compact form.
+  * @details The history keeps one column per source file. A column holds an entry per run with
+  *          the headline numbers of the file and the offset of its record in the byte stream of
+  *          the column. A record stores the execution counts of the lines and functions as varints
+  *          and only those that changed since the previous record of the file, marked in a bitmap
+  *          of the lines and one of the functions; a run changing no count costs a few bytes.
+  *          Line numbers and function names are stored in keyframes only, written whenever they
+  *          change and every 64 records, so reading any run decodes at most 64 records of a file.
+  *          The coverage of a file over time is read from the entries without decoding anything.
+  *          Runs are appended in order of their timestamps, an older run rebuilds the history.
+  *          All data lives in implicitly shared Qt containers, copies of a history are cheap.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#ifndef COVERAGEHISTORY_H
+#define COVERAGEHISTORY_H
+
+#include <QByteArray>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <Model/Coverage.h>
+#include <Model/FileCoverage.h>
+
+class QDataStream;
+
+namespace Model
+{
+
+class CoverageHistory
+{
+public:
+    CoverageHistory();
+    CoverageHistory(const CoverageHistory &other);
+    CoverageHistory& operator=(const CoverageHistory &other);
+    bool addRun(qint64 timestamp, const QList<FileCoverage> &fileCoverages);
+    bool containsRun(qint64 timestamp) const;
+    QList<qint64> getTimestamps() const;
+    QStringList getPaths() const;
+    QList<FileCoverage> getFileCoverages(qint64 timestamp) const;
+    FileCoverage getFileCoverage(const QString &path, qint64 timestamp) const;
+    QMap<qint64, Coverage> getFileHistory(const QString &path) const;
+    QMap<qint64, FileCoverage> getFileTimeline(const QString &path) const;
+    bool isEmpty() const;
+    void write(QDataStream &stream) const;
+    bool read(QDataStream &stream);
+    static QString getFileName(const QString &monitorSetFileName);
+    static void writeFileHeader(QDataStream &stream);
+    static bool readFileHeader(QDataStream &stream);
+protected:
+    class Entry
+    {
+    public:
+        Entry() : run(0), offset(0), keyframe(false), linesFound(0), linesHit(0),
+            functionsFound(0), functionsHit(0), branchesFound(0), branchesHit(0) {}
+        // index of the run in m_timestamps
+        qint32 run;
+        qint32 offset;
+        bool keyframe;
+        quint32 linesFound;
+        quint32 linesHit;
+        quint32 functionsFound;
+        quint32 functionsHit;
+        quint32 branchesFound;
+        quint32 branchesHit;
+    };
+
+    class Column
+    {
+    public:
+        QVector<Entry> entries;
+        QByteArray data;
+    };
+
+    void appendRecord(Column &column, qint32 run, const FileCoverage &fileCoverage);
+    static int findEntry(const Column &column, qint32 run);
+    static bool decode(const QString &path, const Column &column, int entryIndex,
+                       FileCoverage &fileCoverage);
+    static bool decodeRecord(const char *&data, const char *end, bool keyframe,
+                             FileCoverage &fileCoverage);
+    static Coverage toCoverage(const Entry &entry);
+private:
+    QVector<qint64> m_timestamps;
+    QMap<QString, Column> m_columns;
+};
+
+} // namespace Model
+
+#endif // COVERAGEHISTORY_H
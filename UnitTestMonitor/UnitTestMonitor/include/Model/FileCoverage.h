@@ -0,0 +1,60 @@
+/**
+  * @file FileCoverage.h
+  *
+  * @class Model::FileCoverage
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Model element holding the line and function coverage of one source file.
+  * @details The instrumented lines are kept in ascending order with the execution count of each
+  *          line at the same index, the functions in ascending order of their names the same way.
+  *          Sorted arrays let viewers look up a line by binary search and let comparisons walk two
+  *          files side by side.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#ifndef FILECOVERAGE_H
+#define FILECOVERAGE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+namespace Model
+{
+
+class FileCoverage
+{
+public:
+    FileCoverage();
+    FileCoverage(const FileCoverage &other);
+    FileCoverage& operator=(const FileCoverage &other);
+    FileCoverage& withPath(const QString &path);
+    FileCoverage& withLines(const QVector<qint64> &lines, const QVector<qint64> &hits);
+    FileCoverage& withFunctions(const QStringList &names, const QVector<qint64> &hits);
+    FileCoverage& withBranches(qint64 found, qint64 hit);
+    QString getPath() const;
+    QVector<qint64> getLines() const;
+    QVector<qint64> getLineHits() const;
+    QStringList getFunctionNames() const;
+    QVector<qint64> getFunctionHits() const;
+    qint64 getLinesHit() const;
+    qint64 getFunctionsHit() const;
+    qint64 getBranchesFound() const;
+    qint64 getBranchesHit() const;
+    // execution count of a line, -1 if the line is not instrumented
+    qint64 getHits(qint64 line) const;
+private:
+    QString m_path;
+    QVector<qint64> m_lines;
+    QVector<qint64> m_lineHits;
+    QStringList m_functionNames;
+    QVector<qint64> m_functionHits;
+    qint64 m_branchesFound;
+    qint64 m_branchesHit;
+};
+
+} // namespace Model
+
+#endif // FILECOVERAGE_H
@@ -0,0 +1,51 @@
+/**
+  * @file Fingerprint.h
+  *
+  * @class Model::Fingerprint
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Model element identifying the state of a scanned file.
+  * @details A fingerprint is the modification time, the size, and optionally a content hash of a
+  *          tlog or lcov file as seen by the last scan.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#ifndef FINGERPRINT_H
+#define FINGERPRINT_H
+
+#include <QByteArray>
+#include <QString>
+
+class QFileInfo;
+
+namespace Model
+{
+
+class Fingerprint
+{
+public:
+    Fingerprint();
+    Fingerprint(const Fingerprint &other);
+    Fingerprint& operator=(const Fingerprint &other);
+    static Fingerprint fromFileInfo(const QFileInfo &fileInfo);
+    static QByteArray hashFile(const QString &filePath);
+    Fingerprint& withModified(const qint64 modified);
+    Fingerprint& withSize(const qint64 size);
+    Fingerprint& withHash(const QByteArray &hash);
+    qint64 getModified() const;
+    qint64 getSize() const;
+    QByteArray getHash() const;
+    bool isEmpty() const;
+    bool hasSameMetaData(const Fingerprint &other) const;
+    bool hasSameHash(const Fingerprint &other) const;
+private:
+    qint64 m_modified;
+    qint64 m_size;
+    QByteArray m_hash;
+};
+
+} // namespace Model
+
+#endif // FINGERPRINT_H
@@ -7,7 +7,9 @@
   * @license LGPL v2.1
   *
   * @brief Model element representing a library folder within a project.
-  * @details A library has a collection of testcases.
+  * @details A library has a collection of testcases and the coverage of its lcov tracefile per
+  *          testrun, keyed on the modification time of the tracefile. The coverage of every
+  *          source file per testrun is kept in the library's CoverageHistory.
   *
   * @author Robert Wloch, robert@rowlo.de
   *************************************************************************************************/
@@ -18,6 +20,10 @@
 #include <QSharedPointer>
 #include <QMap>
 #include <Model/Testcase.h>
+#include <Model/Fingerprint.h>
+#include <Model/Coverage.h>
+#include <Model/FileCoverage.h>
+#include <Model/CoverageHistory.h>
 
 namespace Model
 {
@@ -30,9 +36,26 @@ public:
     Library& withPath(const QString &path);
     Library& withName(const QString &name);
     Library& withLcovPath(const QString &path);
+    Library& withTlogPath(const QString &path);
+    Library& withInfoPath(const QString &path);
     QString getPath() const;
     QString getName() const;
     QString getLcovPath() const;
+    QString getTlogPath() const;
+    QString getInfoPath() const;
+    Library& withTlogFingerprint(const Fingerprint &fingerprint);
+    Library& withLcovFingerprint(const Fingerprint &fingerprint);
+    Fingerprint getTlogFingerprint() const;
+    Fingerprint getLcovFingerprint() const;
+    Library& withInfoFingerprint(const Fingerprint &fingerprint);
+    Fingerprint getInfoFingerprint() const;
+    void addCoverage(qint64 timestamp, const Coverage &coverage);
+    QMap<qint64, Coverage> getCoverages() const;
+    void addFileCoverages(qint64 timestamp, const QList<FileCoverage> &fileCoverages);
+    QList<FileCoverage> getFileCoverages(qint64 timestamp) const;
+    QList<qint64> getFileCoverageTimestamps() const;
+    Library& withCoverageHistory(const CoverageHistory &history);
+    CoverageHistory getCoverageHistory() const;
     QSharedPointer<Testcase> getTestcase(const QString &name) const;
     void addTestcase(QSharedPointer<Testcase> testcase);
     QList<QSharedPointer<Testcase> > getTestcases() const;
@@ -41,6 +64,13 @@ private:
     QString m_path;
     QString m_name;
     QString m_lcovPath;
+    QString m_tlogPath;
+    QString m_infoPath;
+    Fingerprint m_tlogFingerprint;
+    Fingerprint m_lcovFingerprint;
+    Fingerprint m_infoFingerprint;
+    QMap<qint64, Coverage> m_coverages;
+    CoverageHistory m_coverageHistory;
     QMap<QString, QSharedPointer<Testcase> > m_testcases;
 };
 
@@ -7,7 +7,10 @@
   * @license LGPL v2.1
   *
   * @brief Model element representing a testcase class of a library.
-  * @details A testcase has a collection of testruns.
+  * @details A testcase has a collection of testruns. The names of its test functions are interned
+  *          once per testcase, testruns refer to them by id. The source location of a function does
+  *          not change between testruns and is kept once per testcase. A testrun whose tlog segment
+  *          hash equals the one of the testrun before it is a repeat and not worth keeping.
   *
   * @author Robert Wloch, robert@rowlo.de
   *************************************************************************************************/
@@ -17,6 +20,9 @@
 #include <QString>
 #include <QSharedPointer>
 #include <QMap>
+#include <QPair>
+#include <QHash>
+#include <QStringList>
 #include <Model/Testrun.h>
 
 namespace Model
@@ -38,12 +44,27 @@ public:
     void deleteTestrun(qint64 timestamp);
     QList<QSharedPointer<Testrun> > getTestruns() const;
     int getTestrunsCount() const;
+    bool isRepeatedTestrun(const QSharedPointer<Testrun> &testrun) const;
+    int internFunction(const QString &key);
+    int getFunctionId(const QString &key) const;
+    QStringList getFunctionNames() const;
+    Testcase& withFunctionLocation(const int functionId, const QString &file, const int line);
+    QPair<QString, int> getFunctionLocation(const int functionId) const;
+    QMap<int, QPair<QString, int> > getFunctionLocations() const;
+    void recordTestfunction(const QSharedPointer<Testrun> &testrun,
+                            const Testfunction &testfunction);
+    QList<Testfunction> getTestfunctions(const QSharedPointer<Testrun> &testrun) const;
+    void recordBenchmarkResult(const QSharedPointer<Testrun> &testrun, const QString &key,
+                               const BenchmarkResult &result);
 private:
     QString m_tlogPath;
     QString m_name;
     int m_tlogStartLine;
     int m_tlogEndLine;
     QMap<qint64, QSharedPointer<Testrun> > m_testruns;
+    QStringList m_functionNames;
+    QHash<QString, int> m_functionIds;
+    QMap<int, QPair<QString, int> > m_functionLocations;
 };
 
 } // namespace Model
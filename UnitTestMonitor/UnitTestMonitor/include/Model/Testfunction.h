@@ -0,0 +1,70 @@
+/**
+  * @file Testfunction.h
+  *
+  * @class Model::Testfunction
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Model element representing the result of a test function within a testrun.
+  * @details A test function result is the incident of one test function or data row, its source
+  *          location and the duration of the test function. Testruns store only the state byte of
+  *          an incident, this class is the expanded form handed between parsers, model, and view.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#ifndef TESTFUNCTION_H
+#define TESTFUNCTION_H
+
+#include <QString>
+
+namespace Model
+{
+
+class Testfunction
+{
+public:
+    enum State
+    {
+        NotRun = 0,
+        Passed,
+        Failed,
+        Skipped,
+        ExpectedFailure,
+        UnexpectedPass,
+        BlacklistedPass,
+        BlacklistedFail,
+        BlacklistedExpectedFailure,
+        BlacklistedUnexpectedPass
+    };
+
+    Testfunction();
+    Testfunction(const Testfunction &other);
+    Testfunction& operator=(const Testfunction &other);
+    Testfunction& withName(const QString &name);
+    Testfunction& withDataTag(const QString &dataTag);
+    Testfunction& withIncident(const QString &incident);
+    Testfunction& withLocation(const QString &file, const int line);
+    Testfunction& withDuration(const double msecs);
+    QString getName() const;
+    QString getDataTag() const;
+    QString getIncident() const;
+    QString getFile() const;
+    int getLine() const;
+    double getDuration() const;
+    QString getKey() const;
+    State getState() const;
+    static State stateFromIncident(const QString &incident);
+    static QString incidentFromState(const State state);
+private:
+    QString m_name;
+    QString m_dataTag;
+    QString m_incident;
+    QString m_file;
+    int m_line;
+    double m_duration;
+};
+
+} // namespace Model
+
+#endif // TESTFUNCTION_H
@@ -7,15 +7,26 @@
   * @license LGPL v2.1
   *
   * @brief Model element representing a testrun of a testcase.
-  * @details A testrun is a quadrupel of timestamp, passed, failed, and skipped tests.
+  * @details A testrun is a quadrupel of timestamp, passed, failed, and skipped tests. Test function
+  *          results are kept as one state byte and one float duration per function id of the
+  *          testcase, QBENCHMARK results only for the benchmark functions. The segment hash
+  *          identifies the tlog content the testrun was parsed from, so a tlog that is merely
+  *          touched does not add a repeated testrun. A testrun in progress is the state of a
+  *          testcase whose tlog is still being written, it is aborted once the tlog stops growing
+  *          before the testcase's totals are written.
   *
   * @author Robert Wloch, robert@rowlo.de
   *************************************************************************************************/
 #ifndef TESTRUN_H
 #define TESTRUN_H
 
+#include <QByteArray>
 #include <QList>
+#include <QMap>
 #include <QString>
+#include <QVector>
+#include <Model/Testfunction.h>
+#include <Model/BenchmarkResult.h>
 
 namespace Model
 {
@@ -28,17 +39,44 @@ public:
     Testrun& withTimestamp(const qint64 timestamp);
     Testrun& withResults(const qint32 passed, const qint32 failed, const qint32 skipped);
     Testrun& withFailLog(const QString &failLog);
+    Testrun& withDuration(const double msecs);
+    Testrun& withFunctionState(const int functionId, const Testfunction::State state);
+    Testrun& withFunctionStates(const QByteArray &states);
+    Testrun& withFunctionDuration(const int functionId, const double msecs);
+    Testrun& withFunctionDurations(const QVector<float> &durations);
+    Testrun& withBenchmarkResult(const int functionId, const BenchmarkResult &result);
+    Testrun& withSegmentHash(const QByteArray &segmentHash);
+    Testrun& withInProgress(const bool inProgress);
+    Testrun& withAborted(const bool aborted);
     qint64 getTimestamp() const;
     qint32 getPassed() const;
     qint32 getFailed() const;
     qint32 getSkipped() const;
     QList<QString> getFailLogs() const;
+    double getDuration() const;
+    Testfunction::State getFunctionState(const int functionId) const;
+    QByteArray getFunctionStates() const;
+    double getFunctionDuration(const int functionId) const;
+    QVector<float> getFunctionDurations() const;
+    BenchmarkResult getBenchmarkResult(const int functionId) const;
+    QMap<int, BenchmarkResult> getBenchmarkResults() const;
+    QByteArray getSegmentHash() const;
+    bool isInProgress() const;
+    bool isAborted() const;
 private:
     qint64 m_timestamp;
     qint32 m_passed;
     qint32 m_failed;
     qint32 m_skipped;
     QList<QString> m_failLogs;
+    double m_duration;
+    QByteArray m_functionStates;
+    // negative for the functions without a duration
+    QVector<float> m_functionDurations;
+    QMap<int, BenchmarkResult> m_benchmarkResults;
+    QByteArray m_segmentHash;
+    bool m_inProgress;
+    bool m_aborted;
 };
 
 } // namespace Model
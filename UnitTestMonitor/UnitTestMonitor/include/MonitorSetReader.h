@@ -7,7 +7,8 @@
   * @license LGPL v2.1
   *
   * @brief Reads utm files and creates a monitor set model
-  * @details The MonitorSetReader parses a utm file and instanciates a MonitorSet model.
+  * @details The MonitorSetReader parses a utm file and instanciates a MonitorSet model. The
+  *          coverage histories of its libraries are read from the utmcov file next to it.
   *
   * @author Robert Wloch, robert@rowlo.de
   *************************************************************************************************/
@@ -26,9 +27,12 @@ public:
     MonitorSetReader(const QString &fileName);
     QSharedPointer<Model::MonitorSet> read();
 protected:
+    void readCoverageHistories(QSharedPointer<Model::MonitorSet> result);
     void readBranches(QXmlStreamReader* stream, QSharedPointer<Model::MonitorSet> result);
     void readProjects(QXmlStreamReader* stream, QSharedPointer<Model::Branch> result);
     void readLibraries(QXmlStreamReader* stream, QSharedPointer<Model::Project> result);
+    void readFingerprint(QXmlStreamReader* stream, QSharedPointer<Model::Library> result);
+    void readCoverage(QXmlStreamReader* stream, QSharedPointer<Model::Library> result);
     void readTestcases(QXmlStreamReader* stream, QSharedPointer<Model::Library> result);
     void readTestruns(QXmlStreamReader* stream, QSharedPointer<Model::Testcase> result);
     bool readAttribute(QXmlStreamReader* stream, const QString &attributeName, QString &value);
@@ -7,7 +7,8 @@
   * @license LGPL v2.1
   *
   * @brief Writes utm files from a monitor set model
-  * @details The MonitorSetWriter creates an utm file from a MonitorSet model.
+  * @details The MonitorSetWriter creates an utm file from a MonitorSet model. The coverage
+  *          histories of the libraries are written in binary next to it, to a utmcov file.
   *
   * @author Robert Wloch, robert@rowlo.de
   *************************************************************************************************/
@@ -16,12 +17,16 @@
 
 #include <QString>
 #include <QSharedPointer>
+#include <QStringList>
 #include <Model/MonitorSet.h>
 #include <Model/Branch.h>
 #include <Model/Project.h>
 #include <Model/Library.h>
 #include <Model/Testcase.h>
 #include <Model/Testrun.h>
+#include <Model/Fingerprint.h>
+#include <Model/Coverage.h>
+#include <Model/CoverageHistory.h>
 
 class QXmlStreamWriter;
 
@@ -31,12 +36,20 @@ public:
     MonitorSetWriter(const QString &fileName);
     bool write(const QSharedPointer<Model::MonitorSet> &monitorSet);
 protected:
+    bool writeCoverageHistories(const QSharedPointer<Model::MonitorSet> &monitorSet);
     void writeBranches(QXmlStreamWriter* writer, QList<QSharedPointer<Model::Branch> > branches);
     void writeProjects(QXmlStreamWriter* writer, QList<QSharedPointer<Model::Project> > projects);
     void writeLibraries(QXmlStreamWriter* writer, QList<QSharedPointer<Model::Library> > libraries);
+    void writeFingerprint(
+            QXmlStreamWriter* writer, const QString &kind, const Model::Fingerprint &fingerprint);
+    void writeCoverages(
+            QXmlStreamWriter* writer, const QMap<qint64, Model::Coverage> &coverages);
     void writeTestcases(
             QXmlStreamWriter* writer, QList<QSharedPointer<Model::Testcase> > testcases);
     void writeTestruns(QXmlStreamWriter* writer, QList<QSharedPointer<Model::Testrun> > testruns);
+    void writeFunctions(QXmlStreamWriter* writer, const QSharedPointer<Model::Testcase> &testcase);
+    void writeFunctionResults(
+            QXmlStreamWriter* writer, const QSharedPointer<Model::Testrun> &testrun);
 private:
     QString m_fileName;
 };
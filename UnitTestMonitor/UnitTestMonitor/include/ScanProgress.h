@@ -0,0 +1,66 @@
+/**
+  * @file ScanProgress.h
+  *
+  * @class ScanProgress
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Progress and cancellation state of a branch scan
+  * @details The branch scanner counts discovered and parsed libraries and the tlog bytes read into
+  *          a ScanProgress shared with the main window, which polls it while the scan runs. A
+  *          cancel request is honored between libraries, so every library is either parsed
+  *          completely or left untouched. Once the libraries of a scan are merged into the branch
+  *          the scanner publishes the branch; libraries whose tlog is still queued or parsed are
+  *          busy and must not be read until they are finished.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#ifndef SCANPROGRESS_H
+#define SCANPROGRESS_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QSet>
+#include <QSharedPointer>
+#include <QtGlobal>
+#include <Model/Branch.h>
+#include <Model/Library.h>
+
+class ScanProgress
+{
+public:
+    ScanProgress();
+    void reset();
+    void cancel();
+    bool isCancelled() const;
+    void addDiscoveredLibraries(int count);
+    void addPendingLibraries(int count, qint64 bytes);
+    void addParsedLibrary(const Model::Library *library, qint64 bytes);
+    void addBusyLibrary(const Model::Library *library);
+    bool isBusy(const Model::Library *library) const;
+    void publishBranch(const QSharedPointer<Model::Branch> &branch);
+    QSharedPointer<Model::Branch> getBranch() const;
+    int getPublications() const;
+    int getDiscoveredLibraries() const;
+    int getPendingLibraries() const;
+    int getParsedLibraries() const;
+    qint64 getPendingBytes() const;
+    qint64 getBytesRead() const;
+    qint64 getElapsedMsecs() const;
+    qint64 getRemainingMsecs() const;
+private:
+    mutable QMutex m_mutex;
+    QElapsedTimer m_elapsedTimer;
+    bool m_cancelled;
+    int m_discoveredLibraries;
+    int m_pendingLibraries;
+    int m_parsedLibraries;
+    qint64 m_pendingBytes;
+    qint64 m_bytesRead;
+    QSet<const Model::Library*> m_busyLibraries;
+    QSharedPointer<Model::Branch> m_branch;
+    int m_publications;
+};
+
+#endif // SCANPROGRESS_H
@@ -0,0 +1,54 @@
+/**
+  * @file ScanThrottle.h
+  *
+  * @class ScanThrottle
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Keeps a background branch scan out of the way of the builds on the same host
+  * @details The throttle hands out the tlog bytes of a scan against a budget of bytes per second
+  *          shared by all worker threads; a budget of 0 does not limit the rate. On Linux the
+  *          IdleIoPriority scope puts the calling thread into the idle I/O scheduling class and
+  *          dropFromPageCache() advises the kernel that a parsed tlog is not needed again, so a
+  *          scan neither competes with compilers for the disk nor evicts their working set.
+  *          Elsewhere both are no-ops.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#ifndef SCANTHROTTLE_H
+#define SCANTHROTTLE_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QString>
+#include <QtGlobal>
+
+class ScanThrottle
+{
+public:
+    class IdleIoPriority
+    {
+    public:
+        explicit IdleIoPriority(bool enabled);
+        ~IdleIoPriority();
+    private:
+        Q_DISABLE_COPY(IdleIoPriority)
+        int m_previousPriority;
+    };
+
+    explicit ScanThrottle(qint64 bytesPerSecond = 0);
+    qint64 getBytesPerSecond() const;
+    qint64 getBytesReserved() const;
+    int reserve(qint64 bytes);
+    static void dropFromPageCache(const QString &filePath);
+private:
+    Q_DISABLE_COPY(ScanThrottle)
+    mutable QMutex m_mutex;
+    QElapsedTimer m_clock;
+    qint64 m_bytesPerSecond;
+    qint64 m_bytesReserved;
+    qint64 m_budgetFreeAt;
+};
+
+#endif // SCANTHROTTLE_H
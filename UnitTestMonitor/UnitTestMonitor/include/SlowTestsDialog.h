@@ -0,0 +1,51 @@
+/**
+  * @file SlowTestsDialog.h
+  *
+  * @class SlowTestsDialog
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Dialog listing the testcase durations of a branch
+  * @details The SlowTestsDialog lists the duration of the latest run of each testcase next to
+  *          the duration of the run before it. The table sorts by any column, so the slowest
+  *          testcases and the biggest slowdowns are a click away.
+  *
+  * @author robert@rowlo.de
+  *************************************************************************************************/
+#ifndef SLOWTESTSDIALOG_H
+#define SLOWTESTSDIALOG_H
+
+#include <QDialog>
+#include <QSharedPointer>
+#include <Model/Branch.h>
+
+class QStandardItemModel;
+class QStandardItem;
+
+namespace Ui {
+class SlowTestsDialog;
+}
+
+class SlowTestsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit SlowTestsDialog(QWidget *parent = 0);
+    ~SlowTestsDialog();
+    void initializeForBranch(const QSharedPointer<Model::Branch> &branch);
+protected slots:
+    void storeGeometry();
+    void sortBySlowest();
+    void sortBySlowdown();
+protected:
+    QStandardItem* createItem(const QString &text, const QVariant &sortValue);
+    QStandardItem* createDurationItem(double msecs);
+
+private:
+    Ui::SlowTestsDialog *ui;
+    QStandardItemModel *m_model;
+};
+
+#endif // SLOWTESTSDIALOG_H
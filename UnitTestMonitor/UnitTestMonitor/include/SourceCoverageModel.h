@@ -0,0 +1,68 @@
+/**
+  * @file SourceCoverageModel.h
+  *
+  * @class SourceCoverageModel
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Table model of a source file with the execution count of each line
+  * @details The model maps the source file and only indexes where its lines start. The text of a
+  *          line is decoded when a view asks for it, so a view shows a file of any length right
+  *          away and only pays for the rows it paints. The execution counts come from the sorted
+  *          line arrays of a tracefile and are looked up by binary search. Instrumented lines are
+  *          tinted by whether they ran.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#ifndef SOURCECOVERAGEMODEL_H
+#define SOURCECOVERAGEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QFile>
+#include <QVector>
+#include <Model/FileCoverage.h>
+
+class SourceCoverageModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column
+    {
+        LineColumn = 0,
+        HitsColumn,
+        SourceColumn
+    };
+
+    explicit SourceCoverageModel(QObject *parent = 0);
+    ~SourceCoverageModel();
+    bool setSourceFile(const Model::FileCoverage &sourceFile);
+    void clear();
+    int findLine(qint64 lineNumber) const;
+    int nextUncoveredRow(int row) const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const;
+    QVariant headerData(int section, Qt::Orientation orientation,
+                        int role = Qt::DisplayRole) const;
+
+protected:
+    QString lineText(int row) const;
+    // execution count of a row, -1 if the line is not instrumented
+    qint64 lineHits(int row) const;
+
+private:
+    Model::FileCoverage m_sourceFile;
+    QVector<qint64> m_lines;
+    QVector<qint64> m_lineHits;
+    QFile m_file;
+    const char *m_data;
+    qint64 m_size;
+    QByteArray m_content;
+    // offset of the first character of every line
+    QVector<qint64> m_lineStarts;
+};
+
+#endif // SOURCECOVERAGEMODEL_H
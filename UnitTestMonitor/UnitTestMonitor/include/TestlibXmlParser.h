@@ -0,0 +1,78 @@
+/**
+  * @file TestlibXmlParser.h
+  *
+  * @class TestlibXmlParser
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Parses Qt testlib xml and lightxml output into the model
+  * @details The testlib xml parser streams a tlog written with "-o file,xml" or "-o file,lightxml"
+  *          through a QXmlStreamReader. Concatenated documents of several test executables are
+  *          accepted. Each test function and data row is recorded with its incident, source
+  *          location, duration, and QBENCHMARK result.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#ifndef TESTLIBXMLPARSER_H
+#define TESTLIBXMLPARSER_H
+
+#include <Model/Library.h>
+#include <Model/Testcase.h>
+#include <Model/Testfunction.h>
+#include <Model/BenchmarkResult.h>
+#include <QList>
+#include <QPair>
+#include <QSharedPointer>
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+class QXmlStreamReader;
+class QXmlStreamAttributes;
+
+class TestlibXmlParser
+{
+public:
+    TestlibXmlParser();
+    static bool isXmlTlog(const QString &tlogFilePath);
+    static bool isXmlTlogHead(const QByteArray &head);
+    bool parse(const QString &tlogFilePath,
+               const QSharedPointer<Model::Library> &library,
+               qint64 timestamp);
+    qint64 getBytesParsed() const;
+protected:
+    void handleStartElement(QXmlStreamReader &reader);
+    void handleEndElement(QXmlStreamReader &reader);
+    void beginTestcase(const QString &name, int startLine);
+    void endTestcase(int endLine);
+    void recordIncident();
+    void recordBenchmarkResult(const QXmlStreamAttributes &attributes);
+private:
+    QString m_tlogFilePath;
+    QSharedPointer<Model::Library> m_library;
+    qint64 m_timestamp;
+    qint64 m_bytesParsed;
+
+    QSharedPointer<Model::Testcase> m_testcase;
+    int m_testcaseStartLine;
+    qint32 m_passed;
+    qint32 m_failed;
+    qint32 m_skipped;
+    double m_testcaseDuration;
+    QList<Model::Testfunction> m_testfunctions;
+    QList<QPair<QString, Model::BenchmarkResult> > m_benchmarkResults;
+    QStringList m_failLog;
+
+    QString m_functionName;
+    int m_functionFirstResult;
+    bool m_inIncident;
+    QString m_incidentType;
+    QString m_incidentFile;
+    int m_incidentLine;
+    QString m_dataTag;
+    QString m_description;
+    QString *m_text;
+};
+
+#endif // TESTLIBXMLPARSER_H
@@ -0,0 +1,44 @@
+/**
+  * @file TlogMarkerScanner.h
+  *
+  * @class TlogMarkerScanner
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Finds testlib marker lines in a tlog buffer
+  * @details The marker scanner jumps from one line starting with a marker character to the next
+  *          one and only counts the lines in between. On x86 it compares 32 bytes (AVX2) or 16
+  *          bytes (SSE2) at a time, elsewhere it falls back to a memchr based scalar loop.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#ifndef TLOGMARKERSCANNER_H
+#define TLOGMARKERSCANNER_H
+
+#include <QtGlobal>
+
+class TlogMarkerScanner
+{
+public:
+    TlogMarkerScanner(const char *data, qint64 size, const char *markers);
+    bool nextMarkerLine(const char *&line, int &length, int &lineNumber);
+    bool nextLine(const char *&line, int &length, int &lineNumber);
+    static const char* instructionSet();
+protected:
+    qint64 skipToMarkerLine(qint64 position);
+    qint64 skipScalar(qint64 position);
+    qint64 skipSse2(qint64 position);
+    qint64 skipAvx2(qint64 position);
+private:
+    static const int maxMarkersCount = 8;
+    const char *m_data;
+    qint64 m_size;
+    qint64 m_position;
+    int m_lineIndex;
+    char m_markers[maxMarkersCount];
+    int m_markersCount;
+    bool m_isMarker[256];
+};
+
+#endif // TLOGMARKERSCANNER_H
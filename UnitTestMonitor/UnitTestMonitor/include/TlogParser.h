@@ -0,0 +1,97 @@
+/**
+  * @file TlogParser.h
+  *
+  * @class TlogParser
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Parses Qt testlib plain text tlogs into the model
+  * @details The tlog parser memory maps a tlog and lets a TlogMarkerScanner jump between the lines
+  *          starting with a testlib marker. Only those lines and the lines of a fail log are
+  *          decoded into strings. The incident lines and QBENCHMARK results of the single test
+  *          functions are recorded with the testrun of their testcase. If a tlog cannot be
+  *          mapped it is read into memory and parsed the same way. The bytes of every testcase
+  *          segment are hashed, a testrun repeating the segment of the testrun before it is
+  *          skipped. In tail mode the parser keeps its state and the offset behind the last
+  *          complete line of a tlog, so parseAppended() maps only the bytes written since; a
+  *          testcase whose totals are not written yet gets a testrun in progress. A hash of the
+  *          bytes in front of the offset tells a tlog rewritten by the next test execution. A tail
+  *          whose tlog stopped growing is closed by abortTestcase().
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#ifndef TLOGPARSER_H
+#define TLOGPARSER_H
+
+#include <Model/Library.h>
+#include <Model/Testcase.h>
+#include <Model/Testfunction.h>
+#include <Model/BenchmarkResult.h>
+#include <QCryptographicHash>
+#include <QFile>
+#include <QList>
+#include <QPair>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+
+class TlogParser
+{
+public:
+    TlogParser();
+    bool parse(const QString &tlogFilePath,
+               const QSharedPointer<Model::Library> &library,
+               qint64 timestamp);
+    bool parseData(const char *data, qint64 size,
+                   const QString &tlogFilePath,
+                   const QSharedPointer<Model::Library> &library,
+                   qint64 timestamp);
+    bool parseAppended(const QString &tlogFilePath,
+                       const QSharedPointer<Model::Library> &library,
+                       qint64 timestamp);
+    bool isTestcaseOpen() const;
+    void abortTestcase();
+    qint64 getTailOffset() const;
+    qint64 getBytesParsed() const;
+    static bool parseTotals(const QString &line, qint32 &passed, qint32 &failed,
+                            qint32 &skipped, double &msecs);
+protected:
+    void reset(const QString &tlogFilePath,
+               const QSharedPointer<Model::Library> &library,
+               qint64 timestamp);
+    void parseLines(const char *data, qint64 size);
+    void handleLine(const char *line, int length, int lineNumber);
+    void beginTestcase(const char *line, int length);
+    void recordIncident(const char *line, int length, const QString &incident);
+    void recordLocation(const char *line, int length);
+    void beginBenchmarkResult(const char *line, int length);
+    void recordBenchmarkResult(const QString &text);
+    void recordTotals(const char *line, int length);
+    void endTestcase();
+    void updateTestrunInProgress();
+    bool hasTailAnchor(QFile &tlogFile);
+private:
+    Q_DISABLE_COPY(TlogParser)
+    QString m_tlogFilePath;
+    QSharedPointer<Model::Library> m_library;
+    qint64 m_timestamp;
+    qint64 m_bytesParsed;
+    QSharedPointer<Model::Testcase> m_testcase;
+    int m_lineNumber;
+    int m_testcaseStartLine;
+    const char *m_testcaseBegin;
+    QCryptographicHash m_segmentHash;
+    bool m_testcaseOpen;
+    qint64 m_tailOffset;
+    int m_lineBase;
+    QByteArray m_tailAnchor;
+    qint64 m_tailAnchorSize;
+    QStringList m_failLog;
+    QList<Model::Testfunction> m_testfunctions;
+    QString m_benchmarkKey;
+    QList<QPair<QString, Model::BenchmarkResult> > m_benchmarkResults;
+    bool m_inFailLogOutput;
+};
+
+#endif // TLOGPARSER_H
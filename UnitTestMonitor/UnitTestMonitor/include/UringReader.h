@@ -0,0 +1,82 @@
+/**
+  * @file UringReader.h
+  *
+  * @class UringReader
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Reads a batch of small files through a Linux io_uring
+  * @details Instead of open, read, and close per file the reader submits the opens of a whole
+  *          window of files with one system call, then their reads with another one, and hands
+  *          every file to its Consumer as soon as its read completes, while the kernel still
+  *          reads the others. The closes go along with the next submission. The ring is set up
+  *          with raw system calls, no liburing is needed. If the kernel or the headers lack
+  *          io_uring the reader is not valid and callers keep using their own file access; a file
+  *          that fails in the ring is handed over without content, so the caller can fall back
+  *          for that file alone.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#ifndef URINGREADER_H
+#define URINGREADER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+class UringReader
+{
+public:
+    class Consumer
+    {
+    public:
+        virtual ~Consumer() {}
+        // content is only valid if read is true, it holds the complete file then
+        virtual void consume(int index, const QByteArray &content, bool read) = 0;
+    };
+
+    explicit UringReader(int queueDepth = 64);
+    ~UringReader();
+    static bool isSupported();
+    bool isValid() const;
+    int getQueueDepth() const;
+    bool readFiles(const QStringList &filePaths, const QList<qint64> &sizes, Consumer &consumer);
+    qint64 getSyscalls() const;
+protected:
+    bool setup();
+    void teardown();
+    bool reserveEntry();
+    bool queueOpen(int index, const QByteArray &path);
+    bool queueRead(int index, int fd, char *buffer, qint64 length, qint64 offset);
+    bool queueClose(int fd);
+    bool submit(int minComplete);
+    bool reap(int &index, int &result);
+    void readWindow(const QList<QByteArray> &paths, const QList<qint64> &sizes,
+                    int begin, int end, Consumer &consumer);
+private:
+    Q_DISABLE_COPY(UringReader)
+    int m_queueDepth;
+    int m_ringFd;
+    void *m_sqRing;
+    void *m_cqRing;
+    void *m_sqes;
+    size_t m_sqRingSize;
+    size_t m_cqRingSize;
+    size_t m_sqesSize;
+    unsigned *m_sqHead;
+    unsigned *m_sqTail;
+    unsigned *m_sqMask;
+    unsigned *m_sqArray;
+    unsigned *m_cqHead;
+    unsigned *m_cqTail;
+    unsigned *m_cqMask;
+    void *m_cqes;
+    int m_queued;
+    // queued entries whose completion was not reaped yet
+    int m_inFlight;
+    qint64 m_syscalls;
+};
+
+#endif // URINGREADER_H
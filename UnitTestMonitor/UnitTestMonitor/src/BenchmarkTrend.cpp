@@ -0,0 +1,91 @@
+/**
+  * @file BenchmarkTrend.cpp
+  *
+  * @class BenchmarkTrend
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Rates the latest QBENCHMARK result of a test function against its history
+  * @details The latest value is compared with the median of the runs before it. A change beyond
+  *          the noise threshold is flagged as regression or improvement. Every benchmark metric
+  *          is better the lower it is.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#include "BenchmarkTrend.h"
+
+#include <QtAlgorithms>
+
+BenchmarkTrend::BenchmarkTrend()
+    : m_noiseThreshold(5.0),
+      m_window(5),
+      m_median(-1.0),
+      m_change(0.0)
+{
+}
+
+BenchmarkTrend& BenchmarkTrend::withNoiseThreshold(const double percent)
+{
+    m_noiseThreshold = qMax(0.0, percent);
+    return *this;
+}
+
+BenchmarkTrend& BenchmarkTrend::withWindow(const int runs)
+{
+    m_window = qMax(1, runs);
+    return *this;
+}
+
+double BenchmarkTrend::getNoiseThreshold() const
+{
+    return m_noiseThreshold;
+}
+
+int BenchmarkTrend::getWindow() const
+{
+    return m_window;
+}
+
+BenchmarkTrend::Rating BenchmarkTrend::rate(const QList<double> &values)
+{
+    // values are ordered from the oldest to the latest run
+    m_median = -1.0;
+    m_change = 0.0;
+    if (values.size() < 2)
+    {
+        return Unrated;
+    }
+
+    int first = qMax(0, values.size() - 1 - m_window);
+    QList<double> recent = values.mid(first, values.size() - 1 - first);
+    qSort(recent);
+    int middle = recent.size() / 2;
+    m_median = recent.size() % 2 ? recent.at(middle)
+                                 : (recent.at(middle - 1) + recent.at(middle)) / 2.0;
+    if (m_median <= 0.0)
+    {
+        return Unrated;
+    }
+
+    m_change = (values.last() - m_median) * 100.0 / m_median;
+    if (m_change > m_noiseThreshold)
+    {
+        return Regressed;
+    }
+    if (m_change < -m_noiseThreshold)
+    {
+        return Improved;
+    }
+    return Steady;
+}
+
+double BenchmarkTrend::getMedian() const
+{
+    return m_median;
+}
+
+double BenchmarkTrend::getChange() const
+{
+    return m_change;
+}
@@ -0,0 +1,475 @@
+/**
+  * @file BranchLayoutMatcher.cpp
+  *
+  * @class BranchLayoutMatcher
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Finds the test output of a branch by the templates of its layout
+  * @details The matcher compiles the path templates of a BranchLayout once into segments: plain
+  *          names, patterns with placeholders and globs, and ** for any number of directories.
+  *          A walk keeps a cursor per template position and per bound project and library. A
+  *          directory is listed only if a cursor needs to match a pattern in it, plain names and
+  *          patterns whose placeholders are all bound are opened or probed directly. Directories
+  *          no cursor leads into are never entered, so deep build trees next to the test output
+  *          cost nothing. With a DirectoryWalker each directory is opened relative to its parent
+  *          and listed or probed through that descriptor. A walk can stop at the directories
+  *          binding a project and leave them to the caller, to be walked in parallel. The matcher
+  *          is not changed by a walk and may be shared between threads.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#include "BranchLayoutMatcher.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QMap>
+#include <QSet>
+
+using Model::BranchLayout;
+
+namespace
+{
+
+const QString projectPlaceholder = "project";
+const QString libraryPlaceholder = "library";
+
+// ** stops descending below this depth, symbolic links may form cycles
+const int maxWalkDepth = 32;
+
+QString globToRegularExpression(const QString &glob)
+{
+    QString result;
+    foreach (const QChar &character, glob)
+    {
+        if (character == '*')
+        {
+            result.append("[^/]*");
+        }
+        else if (character == '?')
+        {
+            result.append("[^/]");
+        }
+        else
+        {
+            result.append(QRegExp::escape(QString(character)));
+        }
+    }
+    return result;
+}
+
+QString cursorKey(const BranchLayoutMatcher::Cursor &cursor)
+{
+    return QString("%1:%2:%3/%4").arg(cursor.rule).arg(cursor.segment)
+            .arg(cursor.project).arg(cursor.library);
+}
+
+} // namespace
+
+BranchLayoutMatcher::BranchLayoutMatcher(const BranchLayout &layout)
+{
+    QStringList tlogTemplates = layout.getTlogTemplates();
+    QStringList lcovTemplates = layout.getLcovTemplates();
+    if (tlogTemplates.isEmpty() || lcovTemplates.isEmpty())
+    {
+        m_error = "A layout needs at least one tlog and one lcov template.";
+        return;
+    }
+    for (int i = 0; i < tlogTemplates.size(); ++i)
+    {
+        if (not compile(tlogTemplates.at(i), Tlog, i))
+        {
+            return;
+        }
+    }
+    for (int i = 0; i < lcovTemplates.size(); ++i)
+    {
+        if (not compile(lcovTemplates.at(i), Lcov, i))
+        {
+            return;
+        }
+    }
+    // tracefiles are optional, a layout may have no template for them
+    QStringList infoTemplates = layout.getInfoTemplates();
+    for (int i = 0; i < infoTemplates.size(); ++i)
+    {
+        if (not compile(infoTemplates.at(i), Info, i))
+        {
+            return;
+        }
+    }
+    if (not compileExcludes(layout.getProjectExcludes(), m_projectExcludes) ||
+            not compileExcludes(layout.getLibraryExcludes(), m_libraryExcludes))
+    {
+        return;
+    }
+}
+
+bool BranchLayoutMatcher::isValid() const
+{
+    return m_error.isEmpty();
+}
+
+QString BranchLayoutMatcher::getError() const
+{
+    return m_error;
+}
+
+bool BranchLayoutMatcher::compile(const QString &pathTemplate, Role role, int priority)
+{
+    if (pathTemplate.isEmpty() || pathTemplate.startsWith('/'))
+    {
+        m_error = QString("Template \"%1\" is not relative to the branch.").arg(pathTemplate);
+        return false;
+    }
+
+    Rule rule;
+    rule.role = role;
+    rule.priority = priority;
+    QSet<QString> placeholders;
+    foreach (const QString &text, pathTemplate.split('/', QString::SkipEmptyParts))
+    {
+        Segment segment;
+        segment.text = text;
+        if (text == "." || text == "..")
+        {
+            m_error = QString("Template \"%1\" must not leave its directory.").arg(pathTemplate);
+            return false;
+        }
+        if (text == "**")
+        {
+            segment.kind = Segment::AnyDepth;
+            rule.segments.append(segment);
+            continue;
+        }
+
+        QString expression;
+        for (int i = 0; i < text.size(); ++i)
+        {
+            QChar character = text.at(i);
+            if (character == '{')
+            {
+                int end = text.indexOf('}', i);
+                QString placeholder = text.mid(i + 1, end - i - 1);
+                if (end < 0 ||
+                        (placeholder != projectPlaceholder && placeholder != libraryPlaceholder))
+                {
+                    m_error = QString("Template \"%1\" has an unknown placeholder.")
+                            .arg(pathTemplate);
+                    return false;
+                }
+                expression.append("(.+)");
+                segment.captures.append(placeholder);
+                placeholders.insert(placeholder);
+                i = end;
+                continue;
+            }
+            segment.hasGlob = segment.hasGlob || character == '*' || character == '?';
+            expression.append(globToRegularExpression(QString(character)));
+        }
+        if (segment.hasGlob || not segment.captures.isEmpty())
+        {
+            segment.kind = Segment::Pattern;
+            segment.pattern = QRegExp(expression);
+        }
+        rule.segments.append(segment);
+    }
+
+    if (not placeholders.contains(projectPlaceholder) ||
+            not placeholders.contains(libraryPlaceholder))
+    {
+        m_error = QString("Template \"%1\" needs both {project} and {library}.").arg(pathTemplate);
+        return false;
+    }
+    if (rule.segments.last().kind == Segment::AnyDepth)
+    {
+        m_error = QString("Template \"%1\" must end with a file name.").arg(pathTemplate);
+        return false;
+    }
+    m_rules.append(rule);
+    return true;
+}
+
+bool BranchLayoutMatcher::compileExcludes(const QStringList &patterns,
+                                          QList<QRegExp> &excludes)
+{
+    foreach (const QString &pattern, patterns)
+    {
+        QRegExp exclude(globToRegularExpression(pattern));
+        if (not exclude.isValid())
+        {
+            m_error = QString("Pattern \"%1\" is not a valid glob.").arg(pattern);
+            return false;
+        }
+        excludes.append(exclude);
+    }
+    return true;
+}
+
+BranchLayoutMatcher::Step BranchLayoutMatcher::createStep(
+        const QString &branchPath, const QString &project, const QString &library) const
+{
+    // a bound project or library limits the walk to the directories of that library
+    Step result;
+    result.path = QDir::cleanPath(branchPath);
+    if ((not project.isEmpty() && isExcluded(m_projectExcludes, project)) ||
+            (not library.isEmpty() && isExcluded(m_libraryExcludes, library)))
+    {
+        return result;
+    }
+    for (int i = 0; i < m_rules.size(); ++i)
+    {
+        Cursor cursor;
+        cursor.rule = i;
+        cursor.project = project;
+        cursor.library = library;
+        result.cursors.append(cursor);
+    }
+    return result;
+}
+
+void BranchLayoutMatcher::walk(const Step &step, DirectoryWalker *walker, QList<Match> &matches,
+                               QList<Step> *projectSteps) const
+{
+    if (walker && step.directoryFd < 0)
+    {
+        // only the first step of a walk resolves its whole path, the others open relative to it
+        Step opened = step;
+        opened.directoryFd = walker->openDirectory(step.path);
+        if (opened.directoryFd >= 0)
+        {
+            walk(opened, walker, matches, projectSteps);
+            walker->closeDirectory(opened.directoryFd);
+        }
+        return;
+    }
+
+    // without projectSteps the walk goes all the way down, with them it stops at every
+    // directory where a project is bound and leaves it to the caller
+    QList<Cursor> cursors = step.cursors;
+    QSet<QString> cursorKeys;
+    QMap<QString, QList<Cursor> > children;
+    bool listed = false;
+    QStringList directories, files;
+    for (int i = 0; i < cursors.size(); ++i)
+    {
+        const Cursor cursor = cursors.at(i);
+        const Rule &rule = m_rules.at(cursor.rule);
+        const Segment &segment = rule.segments.at(cursor.segment);
+        bool isLast = cursor.segment + 1 == rule.segments.size();
+
+        QString name;
+        if (resolveName(segment, cursor, name))
+        {
+            if (isLast)
+            {
+                probeFile(step, name, cursor, walker, matches);
+            }
+            else
+            {
+                Cursor next = cursor;
+                ++next.segment;
+                children[name].append(next);
+            }
+            continue;
+        }
+
+        if (not listed)
+        {
+            listed = true;
+            list(step, walker, directories, files);
+        }
+        if (segment.kind == Segment::AnyDepth)
+        {
+            // ** stands for no directory as well as for any number of them
+            Cursor next = cursor;
+            ++next.segment;
+            if (not cursorKeys.contains(cursorKey(next)))
+            {
+                cursorKeys.insert(cursorKey(next));
+                cursors.append(next);
+            }
+            if (step.depth < maxWalkDepth)
+            {
+                foreach (const QString &directory, directories)
+                {
+                    children[directory].append(cursor);
+                }
+            }
+            continue;
+        }
+        foreach (const QString &entry, isLast ? files : directories)
+        {
+            Cursor next = cursor;
+            if (not bind(segment, entry, next))
+            {
+                continue;
+            }
+            if (isLast)
+            {
+                probeFile(step, entry, next, walker, matches);
+            }
+            else
+            {
+                ++next.segment;
+                children[entry].append(next);
+            }
+        }
+    }
+
+    QMap<QString, QList<Cursor> >::const_iterator it = children.constBegin();
+    for (; it != children.constEnd(); ++it)
+    {
+        Step child;
+        child.path = QString("%1/%2").arg(step.path).arg(it.key());
+        child.depth = step.depth + 1;
+        bool bindsProject = false;
+        QSet<QString> childKeys;
+        foreach (const Cursor &cursor, it.value())
+        {
+            if (not childKeys.contains(cursorKey(cursor)))
+            {
+                childKeys.insert(cursorKey(cursor));
+                child.cursors.append(cursor);
+                bindsProject = bindsProject || not cursor.project.isEmpty();
+            }
+        }
+        if (projectSteps && bindsProject)
+        {
+            // opened by its path once the caller walks it
+            projectSteps->append(child);
+        }
+        else if (walker)
+        {
+            child.directoryFd = walker->openDirectory(step.directoryFd, it.key());
+            if (child.directoryFd >= 0)
+            {
+                walk(child, walker, matches, projectSteps);
+                walker->closeDirectory(child.directoryFd);
+            }
+        }
+        else
+        {
+            walk(child, walker, matches, projectSteps);
+        }
+    }
+}
+
+bool BranchLayoutMatcher::resolveName(const Segment &segment, const Cursor &cursor,
+                                      QString &name) const
+{
+    // a name known without listing the directory
+    if (segment.kind == Segment::Name)
+    {
+        name = segment.text;
+        return true;
+    }
+    if (segment.kind == Segment::AnyDepth || segment.hasGlob)
+    {
+        return false;
+    }
+    name = segment.text;
+    foreach (const QString &placeholder, segment.captures)
+    {
+        QString value = placeholder == projectPlaceholder ? cursor.project : cursor.library;
+        if (value.isEmpty())
+        {
+            return false;
+        }
+        name.replace(QString("{%1}").arg(placeholder), value);
+    }
+    return true;
+}
+
+bool BranchLayoutMatcher::bind(const Segment &segment, const QString &name, Cursor &cursor) const
+{
+    // a QRegExp keeps the captures of its last match, the walk tasks share the segments
+    QRegExp pattern(segment.pattern);
+    if (not pattern.exactMatch(name))
+    {
+        return false;
+    }
+    for (int i = 0; i < segment.captures.size(); ++i)
+    {
+        bool isProject = segment.captures.at(i) == projectPlaceholder;
+        QString &bound = isProject ? cursor.project : cursor.library;
+        QString value = pattern.cap(i + 1);
+        if (bound.isEmpty())
+        {
+            if (isExcluded(isProject ? m_projectExcludes : m_libraryExcludes, value))
+            {
+                return false;
+            }
+            bound = value;
+        }
+        else if (bound != value)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool BranchLayoutMatcher::isExcluded(const QList<QRegExp> &excludes,
+                                     const QString &name) const
+{
+    // copied for the same reason as the pattern in bind()
+    foreach (QRegExp exclude, excludes)
+    {
+        if (exclude.exactMatch(name))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+void BranchLayoutMatcher::probeFile(const Step &step, const QString &name,
+                                    const Cursor &cursor, DirectoryWalker *walker,
+                                    QList<Match> &matches) const
+{
+    Match match;
+    match.filePath = QString("%1/%2").arg(step.path).arg(name);
+    if (walker)
+    {
+        if (not walker->statFile(step.directoryFd, name, match.modified, match.size))
+        {
+            return;
+        }
+    }
+    else
+    {
+        QFileInfo fileInfo(match.filePath);
+        if (not fileInfo.isFile())
+        {
+            return;
+        }
+        match.modified = fileInfo.lastModified().toMSecsSinceEpoch();
+        match.size = fileInfo.size();
+    }
+    const Rule &rule = m_rules.at(cursor.rule);
+    match.project = cursor.project;
+    match.library = cursor.library;
+    match.role = rule.role;
+    match.priority = rule.priority;
+    matches.append(match);
+}
+
+bool BranchLayoutMatcher::list(const Step &step, DirectoryWalker *walker,
+                               QStringList &directories, QStringList &files) const
+{
+    if (walker)
+    {
+        return walker->listEntries(step.directoryFd, directories, files);
+    }
+    QDir directory(step.path);
+    if (not directory.exists())
+    {
+        return false;
+    }
+    directories = directory.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+    files = directory.entryList(QDir::Files);
+    return true;
+}
@@ -0,0 +1,342 @@
+/**
+  * @file BranchPoller.cpp
+  *
+  * @class BranchPoller
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Polls branches whose file system sends no change notifications
+  * @details On NFS mounts inotify events of other hosts never arrive, so the poller probes every
+  *          branch of a monitor set on its own schedule. A probe only stats the branch directory,
+  *          the directories holding the output directories of the libraries and the tlog and lcov
+  *          report of every library, and compares them with the fingerprints of the last scan. Only
+  *          a changed directory is searched, by the branch layout, for new projects and libraries;
+  *          the first probe of a branch just takes the baseline. Changed and new libraries are
+  *          reported as library keys "<project>/<library>", so they are updated the way the branch
+  *          watcher's changes are, instead of rescanning the branch. The interval of a branch
+  *          shrinks towards a quarter of the average time between its observed changes and grows by
+  *          half after every probe without a change, bounded by the minimum and maximum interval.
+  *          Probes run on a worker thread and never touch the model, they work on a copy of the
+  *          paths and fingerprints taken on the GUI thread.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#include "BranchPoller.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QSet>
+#include <QtConcurrent>
+
+#include <Model/Project.h>
+#include <Model/Library.h>
+
+using Model::Branch;
+using Model::Project;
+using Model::Library;
+using Model::Fingerprint;
+
+namespace
+{
+
+// weight of the latest gap between two changes in their running average
+const double changeGapWeight = 0.3;
+
+bool hasChangedFile(const QString &filePath, const Fingerprint &fingerprint,
+                    const QSet<QString> &changedDirectories)
+{
+    // a file can only have changed if its directory did, that saves the stat of all others
+    if (filePath.isEmpty() || not changedDirectories.contains(QFileInfo(filePath).absolutePath()))
+    {
+        return false;
+    }
+    Fingerprint current = Fingerprint::fromFileInfo(QFileInfo(filePath));
+    return not current.isEmpty() && not current.hasSameMetaData(fingerprint);
+}
+
+} // namespace
+
+BranchPoller::BranchPoller(QObject *parent)
+    : QObject(parent),
+      m_minInterval(30),
+      m_maxInterval(1800)
+{
+    connect(&m_probeWatcher, SIGNAL(finished()), SLOT(handleFinishedProbe()));
+}
+
+BranchPoller& BranchPoller::withIntervals(int minSeconds, int maxSeconds)
+{
+    m_minInterval = qMax(1, minSeconds);
+    m_maxInterval = qMax(m_minInterval, maxSeconds);
+    return *this;
+}
+
+int BranchPoller::getMinInterval() const
+{
+    return m_minInterval;
+}
+
+int BranchPoller::getMaxInterval() const
+{
+    return m_maxInterval;
+}
+
+int BranchPoller::getInterval(const QString &branchPath) const
+{
+    return m_schedules.value(branchPath).interval;
+}
+
+bool BranchPoller::isProbing() const
+{
+    return m_probeWatcher.isRunning();
+}
+
+void BranchPoller::poll(const QList<QSharedPointer<Branch> > &branches)
+{
+    // must be called while no scan modifies the branches
+    if (isProbing())
+    {
+        return;
+    }
+
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QList<BranchProbe> probes;
+    QSet<QString> branchPaths;
+    foreach (const QSharedPointer<Branch> &branch, branches)
+    {
+        QString branchPath = branch->getPath();
+        branchPaths.insert(branchPath);
+        Schedule &schedule = m_schedules[branchPath];
+        if (schedule.interval == 0)
+        {
+            // a new branch was just scanned, there is no need to probe it right away
+            schedule.interval = m_minInterval;
+            schedule.nextProbe = now + Q_INT64_C(1000) * schedule.interval;
+        }
+        if (schedule.nextProbe <= now)
+        {
+            probes.append(createProbe(branch));
+        }
+    }
+    foreach (const QString &branchPath, m_schedules.keys())
+    {
+        if (not branchPaths.contains(branchPath))
+        {
+            m_schedules.remove(branchPath);
+        }
+    }
+
+    if (not probes.isEmpty())
+    {
+        m_probeWatcher.setFuture(QtConcurrent::run(&BranchPoller::probeBranches, probes));
+    }
+}
+
+void BranchPoller::forgetBranch(const QString &branchPath)
+{
+    m_schedules.remove(branchPath);
+}
+
+BranchPoller::BranchProbe BranchPoller::createProbe(const QSharedPointer<Branch> &branch) const
+{
+    Schedule schedule = m_schedules.value(branch->getPath());
+    BranchProbe probe;
+    probe.branchPath = branch->getPath();
+    probe.layout = branch->getLayout();
+    probe.branchModified = schedule.branchModified;
+    foreach (const QSharedPointer<Project> &project, branch->getProjects())
+    {
+        probe.projectNames.insert(project->getName());
+        foreach (const QSharedPointer<Library> &library, project->getLibraries())
+        {
+            LibraryProbe libraryProbe;
+            libraryProbe.key = QString("%1/%2").arg(project->getName()).arg(library->getName());
+            libraryProbe.tlogFilePath = library->getTlogPath();
+            libraryProbe.lcovFilePath = library->getLcovPath();
+            libraryProbe.infoFilePath = library->getInfoPath();
+            libraryProbe.tlogFingerprint = library->getTlogFingerprint();
+            libraryProbe.lcovFingerprint = library->getLcovFingerprint();
+            libraryProbe.infoFingerprint = library->getInfoFingerprint();
+            probe.libraries.append(libraryProbe);
+
+            foreach (const QString &filePath, QStringList() << libraryProbe.tlogFilePath
+                     << libraryProbe.lcovFilePath << libraryProbe.infoFilePath)
+            {
+                if (filePath.isEmpty())
+                {
+                    continue;
+                }
+                QString fileDirectory = QFileInfo(filePath).absolutePath();
+                probe.directoriesModified.insert(
+                            fileDirectory, schedule.directoriesModified.value(fileDirectory, -1));
+                if (filePath == libraryProbe.infoFilePath)
+                {
+                    continue;
+                }
+                // a new library shows up next to the output directory of a known one
+                QString directory = QFileInfo(fileDirectory).absolutePath();
+                probe.libraryDirectories.insert(directory, project->getName());
+                probe.directoriesModified.insert(
+                            directory, schedule.directoriesModified.value(directory, -1));
+            }
+        }
+    }
+    return probe;
+}
+
+QList<BranchPoller::BranchProbe> BranchPoller::probeBranches(const QList<BranchProbe> &probes)
+{
+    QList<BranchProbe> result = probes;
+    for (int i = 0; i < result.size(); ++i)
+    {
+        probeBranch(result[i]);
+    }
+    return result;
+}
+
+void BranchPoller::probeBranch(BranchProbe &probe)
+{
+    QFileInfo branchInfo(probe.branchPath);
+    if (not branchInfo.isDir())
+    {
+        return;
+    }
+
+    BranchLayoutMatcher matcher(probe.layout);
+    if (not matcher.isValid())
+    {
+        matcher = BranchLayoutMatcher();
+    }
+    QSet<QString> knownKeys;
+    foreach (const LibraryProbe &libraryProbe, probe.libraries)
+    {
+        knownKeys.insert(libraryProbe.key);
+    }
+
+    // a new project changes the branch directory
+    qint64 branchModified = branchInfo.lastModified().toMSecsSinceEpoch();
+    if (branchModified != probe.branchModified)
+    {
+        QStringList projectNames = QDir(probe.branchPath).entryList(
+                    QDir::Dirs | QDir::NoDotAndDotDot);
+        foreach (const QString &projectName, projectNames)
+        {
+            if (not probe.projectNames.contains(projectName))
+            {
+                walkProject(probe, matcher, projectName, knownKeys);
+            }
+        }
+        probe.branchModified = branchModified;
+    }
+
+    // the directories are stat'ed first, a directory never probed before counts as changed
+    QSet<QString> changedDirectories;
+    QSet<QString> walkedProjects;
+    QMap<QString, qint64>::iterator it = probe.directoriesModified.begin();
+    for (; it != probe.directoriesModified.end(); ++it)
+    {
+        QFileInfo directoryInfo(it.key());
+        if (not directoryInfo.isDir())
+        {
+            continue;
+        }
+        qint64 directoryModified = directoryInfo.lastModified().toMSecsSinceEpoch();
+        if (directoryModified != it.value())
+        {
+            changedDirectories.insert(it.key());
+        }
+        // a new library changes the directory holding the output directories of its project
+        if (it.value() >= 0 && directoryModified != it.value()
+                && probe.libraryDirectories.contains(it.key()))
+        {
+            QString projectName = probe.libraryDirectories.value(it.key());
+            if (not walkedProjects.contains(projectName))
+            {
+                walkedProjects.insert(projectName);
+                walkProject(probe, matcher, projectName, knownKeys);
+            }
+        }
+        it.value() = directoryModified;
+    }
+
+    // only the reports in changed directories are stat'ed and compared with the last scan
+    foreach (const LibraryProbe &libraryProbe, probe.libraries)
+    {
+        if (hasChangedFile(libraryProbe.tlogFilePath, libraryProbe.tlogFingerprint,
+                           changedDirectories)
+                || hasChangedFile(libraryProbe.lcovFilePath, libraryProbe.lcovFingerprint,
+                                  changedDirectories)
+                || hasChangedFile(libraryProbe.infoFilePath, libraryProbe.infoFingerprint,
+                                  changedDirectories))
+        {
+            probe.changedLibraryKeys.append(libraryProbe.key);
+        }
+    }
+}
+
+void BranchPoller::walkProject(BranchProbe &probe, const BranchLayoutMatcher &matcher,
+                               const QString &projectName, const QSet<QString> &knownKeys)
+{
+    // the layout leads the walk straight to the output of this project's libraries
+    QList<BranchLayoutMatcher::Match> matches;
+    matcher.walk(matcher.createStep(probe.branchPath, projectName), 0, matches);
+    foreach (const BranchLayoutMatcher::Match &match, matches)
+    {
+        QString libraryKey = QString("%1/%2").arg(match.project).arg(match.library);
+        if (match.role == BranchLayoutMatcher::Tlog && not knownKeys.contains(libraryKey)
+                && not probe.changedLibraryKeys.contains(libraryKey))
+        {
+            probe.changedLibraryKeys.append(libraryKey);
+        }
+    }
+}
+
+void BranchPoller::handleFinishedProbe()
+{
+    QList<BranchProbe> probes = m_probeWatcher.result();
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    foreach (const BranchProbe &probe, probes)
+    {
+        if (not m_schedules.contains(probe.branchPath))
+        {
+            // removed while it was probed
+            continue;
+        }
+        Schedule &schedule = m_schedules[probe.branchPath];
+        schedule.branchModified = probe.branchModified;
+        schedule.directoriesModified = probe.directoriesModified;
+        bool changed = not probe.changedLibraryKeys.isEmpty();
+        reschedule(schedule, changed, now);
+        if (changed)
+        {
+            emit librariesChanged(probe.branchPath, probe.changedLibraryKeys);
+        }
+    }
+}
+
+void BranchPoller::reschedule(Schedule &schedule, bool changed, qint64 now)
+{
+    if (changed)
+    {
+        if (schedule.lastChange > 0)
+        {
+            double gap = (now - schedule.lastChange) / 1000.0;
+            schedule.changeGap = schedule.changeGap < 0.0
+                    ? gap : changeGapWeight * gap + (1.0 - changeGapWeight) * schedule.changeGap;
+            schedule.interval = static_cast<int>(schedule.changeGap / 4.0);
+        }
+        else
+        {
+            schedule.interval /= 2;
+        }
+        schedule.lastChange = now;
+    }
+    else
+    {
+        schedule.interval += qMax(1, schedule.interval / 2);
+    }
+    schedule.interval = qBound(m_minInterval, schedule.interval, m_maxInterval);
+    schedule.nextProbe = now + Q_INT64_C(1000) * schedule.interval;
+}
@@ -8,7 +8,8 @@
   *
   * @brief Scans a branch directory for unit test data
   * @details The branch scanner scans a directory structure for libraries with tests, tlog, and lcov
-  *          reports.
+  *          reports. The tlogs and reports are found by the templates of the branch's layout;
+  *          changed libraries are parsed newest first and published as soon as they are done.
   *
   * @author Robert Wloch, robert@rowlo.de
   *************************************************************************************************/
@@ -19,8 +20,24 @@
 #include <QDateTime>
 #include <QDir>
 #include <QDirIterator>
-#include <QTextStream>
+#include <QThread>
+#include <QWaitCondition>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QMap>
+#include <QStringList>
+#include <QDebug>
+#include <QCryptographicHash>
+#include <QMutexLocker>
+#include <QtAlgorithms>
 
+#include <DirectoryWalker.h>
+#include <TlogParser.h>
+#include <TestlibXmlParser.h>
+#include <JUnitXmlParser.h>
+#include <LcovInfoParser.h>
+#include <LcovSummaryParser.h>
+#include <UringReader.h>
 #include <Model/Project.h>
 #include <Model/Testcase.h>
 #include <Model/Testrun.h>
@@ -30,12 +47,310 @@ using Model::Project;
 using Model::Library;
 using Model::Testcase;
 using Model::Testrun;
+using Model::Fingerprint;
+
+namespace
+{
+
+// tlog workers of a background scan, the build machine's cores belong to the compilers
+const int backgroundThreadCount = 2;
+
+// longest sleep of a throttled worker before it checks for a cancel request
+const int throttleSleepSlice = 100;
+
+// tlogs opened and read per io_uring submission, larger tlogs are mapped one by one
+const int batchQueueDepth = 64;
+const qint64 batchMaxTlogSize = 16 * 1024 * 1024;
+
+// a tail whose tlog was not written for this long belongs to a crashed or hanging testcase
+const qint64 staleTailMsecs = 15 * 60 * 1000;
+
+bool isNewerTlogJob(const BranchScanner::TlogJob &left, const BranchScanner::TlogJob &right)
+{
+    return left.fingerprint.getModified() > right.fingerprint.getModified();
+}
+
+} // namespace
+
+/**
+  * @brief Walks the directories of one project on a pool thread.
+  */
+class WalkProjectTask : public QRunnable
+{
+public:
+    WalkProjectTask(const BranchScanner *scanner, const BranchLayoutMatcher *matcher,
+                    BranchScanner::ProjectWalk *walk)
+        : m_scanner(scanner),
+          m_matcher(matcher),
+          m_walk(walk)
+    {
+    }
+
+    void run()
+    {
+        ScanThrottle::IdleIoPriority idleIoPriority(m_scanner->isBackgroundScan());
+        m_scanner->walkProject(*m_matcher, *m_walk);
+    }
+
+private:
+    const BranchScanner *m_scanner;
+    const BranchLayoutMatcher *m_matcher;
+    BranchScanner::ProjectWalk *m_walk;
+};
+
+/**
+  * @brief Parses the lcov tracefile of one library on a pool thread.
+  * @details The coverage stays in the job, the scanning thread adds it to the library.
+  */
+class ParseCoverageTask : public QRunnable
+{
+public:
+    ParseCoverageTask(const BranchScanner *scanner, BranchScanner::CoverageJob *job)
+        : m_scanner(scanner),
+          m_job(job)
+    {
+    }
+
+    void run()
+    {
+        ScanThrottle::IdleIoPriority idleIoPriority(m_scanner->isBackgroundScan());
+        m_scanner->parseCoverage(*m_job);
+    }
+
+private:
+    const BranchScanner *m_scanner;
+    BranchScanner::CoverageJob *m_job;
+};
+
+/**
+  * @brief Analyzes the tlog of one library on a pool thread.
+  * @details Each task owns exactly one library, so tasks never touch the same model element.
+  */
+class AnalyzeTlogTask : public QRunnable
+{
+public:
+    AnalyzeTlogTask(BranchScanner *scanner, const BranchScanner::TlogJob &job, qint64 timestamp)
+        : m_scanner(scanner),
+          m_job(job),
+          m_timestamp(timestamp)
+    {
+    }
+
+    void run()
+    {
+        ScanThrottle::IdleIoPriority idleIoPriority(m_scanner->isBackgroundScan());
+        m_scanner->ingestTlog(m_job, m_timestamp);
+    }
+
+private:
+    BranchScanner *m_scanner;
+    BranchScanner::TlogJob m_job;
+    qint64 m_timestamp;
+};
+
+/**
+  * @brief Analyzes the tlogs of several libraries with batched reads on a pool thread.
+  */
+class AnalyzeTlogBatchTask : public QRunnable
+{
+public:
+    AnalyzeTlogBatchTask(BranchScanner *scanner, const QList<BranchScanner::TlogJob> &jobs,
+                         qint64 timestamp)
+        : m_scanner(scanner),
+          m_jobs(jobs),
+          m_timestamp(timestamp)
+    {
+    }
+
+    void run()
+    {
+        m_scanner->ingestTlogBatch(m_jobs, m_timestamp);
+    }
+
+private:
+    BranchScanner *m_scanner;
+    QList<BranchScanner::TlogJob> m_jobs;
+    qint64 m_timestamp;
+};
+
+/**
+  * @brief Ingests every tlog of a batch as soon as its read completes.
+  * @details A tlog the ring failed to read is ingested from its file instead.
+  */
+class TlogBatchConsumer : public UringReader::Consumer
+{
+public:
+    TlogBatchConsumer(BranchScanner *scanner, const QList<BranchScanner::TlogJob> &jobs,
+                      qint64 timestamp)
+        : m_scanner(scanner),
+          m_jobs(jobs),
+          m_timestamp(timestamp)
+    {
+    }
+
+    void consume(int index, const QByteArray &content, bool read)
+    {
+        m_scanner->ingestTlog(m_jobs.at(index), m_timestamp, read ? &content : 0);
+    }
+
+private:
+    BranchScanner *m_scanner;
+    const QList<BranchScanner::TlogJob> &m_jobs;
+    qint64 m_timestamp;
+};
 
 BranchScanner::BranchScanner()
+    : m_parallelScan(true),
+      m_maxThreadCount(QThread::idealThreadCount()),
+      m_incrementalScan(true),
+      m_contentHashing(false),
+      m_nativeWalk(true),
+      m_batchedReads(false)
+{
+}
+
+BranchScanner& BranchScanner::withParallelScan(bool parallel, int maxThreadCount)
+{
+    m_parallelScan = parallel;
+    m_maxThreadCount = maxThreadCount > 0 ? maxThreadCount : QThread::idealThreadCount();
+    return *this;
+}
+
+bool BranchScanner::isParallelScan() const
+{
+    return m_parallelScan && m_maxThreadCount > 1;
+}
+
+int BranchScanner::getMaxThreadCount() const
+{
+    return m_maxThreadCount;
+}
+
+BranchScanner& BranchScanner::withIncrementalScan(bool incremental, bool contentHashing)
+{
+    // libraries whose fingerprints did not change since the last scan are skipped
+    m_incrementalScan = incremental;
+    m_contentHashing = contentHashing;
+    return *this;
+}
+
+bool BranchScanner::isIncrementalScan() const
+{
+    return m_incrementalScan;
+}
+
+bool BranchScanner::isContentHashing() const
+{
+    return m_contentHashing;
+}
+
+BranchScanner& BranchScanner::withNativeWalk(bool nativeWalk)
+{
+    // on Linux the directories are listed with a DirectoryWalker instead of QDirIterator
+    m_nativeWalk = nativeWalk;
+    return *this;
+}
+
+bool BranchScanner::isNativeWalk() const
+{
+    return m_nativeWalk && DirectoryWalker::isSupported();
+}
+
+BranchScanner& BranchScanner::withProgress(const QSharedPointer<ScanProgress> &progress)
+{
+    m_progress = progress;
+    return *this;
+}
+
+QSharedPointer<ScanProgress> BranchScanner::getProgress() const
+{
+    return m_progress;
+}
+
+BranchScanner& BranchScanner::withBackgroundScan(bool background, qint64 bytesPerSecond)
+{
+    // idle I/O priority, at most two tlog workers, a read budget of bytes per second, and every
+    // parsed file is dropped from the page cache
+    m_throttle.clear();
+    if (background)
+    {
+        m_throttle = QSharedPointer<ScanThrottle>(new ScanThrottle(bytesPerSecond));
+    }
+    return *this;
+}
+
+bool BranchScanner::isBackgroundScan() const
+{
+    return not m_throttle.isNull();
+}
+
+qint64 BranchScanner::getBytesPerSecond() const
+{
+    return m_throttle.isNull() ? 0 : m_throttle->getBytesPerSecond();
+}
+
+BranchScanner& BranchScanner::withBatchedReads(bool batchedReads)
 {
+    // a worker reads its tlogs through a UringReader and parses each one as its read completes
+    m_batchedReads = batchedReads;
+    return *this;
 }
 
-QSharedPointer<Branch> BranchScanner::scanBranch(const QString &path)
+bool BranchScanner::isBatchedReads() const
+{
+    // a background scan paces its reads, batching would defeat that
+    return m_batchedReads && not isBackgroundScan();
+}
+
+BranchScanner& BranchScanner::withTailIngestion(bool tailIngestion)
+{
+    // the parser of a tlog whose testcase is still running only reads what was appended since
+    m_tlogTails.clear();
+    if (tailIngestion)
+    {
+        // shared by the copies QtConcurrent makes, the tails outlive a single scan
+        m_tlogTails = QSharedPointer<TlogTails>(new TlogTails());
+    }
+    return *this;
+}
+
+bool BranchScanner::isTailIngestion() const
+{
+    return not m_tlogTails.isNull();
+}
+
+bool BranchScanner::isCancelled() const
+{
+    return not m_progress.isNull() && m_progress->isCancelled();
+}
+
+bool BranchScanner::throttle(qint64 bytes) const
+{
+    // returns false if the scan was cancelled while waiting for the budget
+    if (m_throttle.isNull())
+    {
+        return not isCancelled();
+    }
+    int wait = m_throttle->reserve(bytes);
+    // QThread::msleep() is protected before Qt 5, a wait condition nobody wakes sleeps as well
+    QMutex mutex;
+    QWaitCondition sleep;
+    QMutexLocker locker(&mutex);
+    while (wait > 0)
+    {
+        if (isCancelled())
+        {
+            return false;
+        }
+        int slice = qMin(wait, throttleSleepSlice);
+        sleep.wait(&mutex, slice);
+        wait -= slice;
+    }
+    return not isCancelled();
+}
+
+QSharedPointer<Branch> BranchScanner::scanBranch(const QString &path,
+                                                 const Model::BranchLayout &layout)
 {
     QFileInfo fileInfo(path);
     if (not (fileInfo.isDir() && fileInfo.exists()))
@@ -49,9 +364,16 @@ QSharedPointer<Branch> BranchScanner::scanBranch(const QString &path)
     parentDir.cdUp();
     QFileInfo parentFileInfo(parentDir.absolutePath());
     result->withPath(path)
-            .withName(QString("%1/%2").arg(parentFileInfo.fileName()).arg(fileInfo.fileName()));
+            .withName(QString("%1/%2").arg(parentFileInfo.fileName()).arg(fileInfo.fileName()))
+            .withLayout(layout);
 
-    return updateBranch(result);
+    updateBranch(result);
+    if (isCancelled())
+    {
+        // a partially scanned new branch is not worth keeping
+        return QSharedPointer<Branch>();
+    }
+    return result;
 }
 
 QSharedPointer<Branch> BranchScanner::updateBranch(const QSharedPointer<Branch> &branch)
@@ -62,174 +384,642 @@ QSharedPointer<Branch> BranchScanner::updateBranch(const QSharedPointer<Branch>
         return result;
     }
     result = branch;
+    ScanThrottle::IdleIoPriority idleIoPriority(isBackgroundScan());
 
     QString path = result->getPath();
-    QDir branchDir(path);
-    QFileInfoList branchEntries = branchDir.entryInfoList(QDir::Dirs);
+    BranchLayoutMatcher matcher = createMatcher(result);
+    DirectoryWalker walker;
+    DirectoryWalker *nativeWalker = isNativeWalk() ? &walker : 0;
 
     qint64 scanTimestamp = QDateTime::currentMSecsSinceEpoch();
 
-    foreach (const QFileInfo &branchEntry, branchEntries)
+    // walk down to the directories that bind a project, below them each project is walked alone
+    QList<BranchLayoutMatcher::Match> matches;
+    QList<BranchLayoutMatcher::Step> projectSteps;
+    matcher.walk(matcher.createStep(path), nativeWalker, matches, &projectSteps);
+    QList<ProjectWalk> projectWalks;
+    foreach (const BranchLayoutMatcher::Step &step, projectSteps)
+    {
+        ProjectWalk projectWalk;
+        projectWalk.step = step;
+        projectWalks.append(projectWalk);
+    }
+
+    // each task fills only its own walk
+    if (isParallelScan() && projectWalks.size() > 1)
     {
-        QString projectPath = branchEntry.absoluteFilePath();
-        QString projectName = branchEntry.fileName();
-        if (projectName == "." || projectName == ".." || projectName == "_")
+        QThreadPool pool;
+        pool.setMaxThreadCount(m_maxThreadCount);
+        for (int i = 0; i < projectWalks.size(); ++i)
+        {
+            pool.start(new WalkProjectTask(this, &matcher, &projectWalks[i]));
+        }
+        pool.waitForDone();
+    }
+    else
+    {
+        for (int i = 0; i < projectWalks.size(); ++i)
+        {
+            walkProject(matcher, projectWalks[i]);
+        }
+    }
+
+    foreach (const ProjectWalk &projectWalk, projectWalks)
+    {
+        matches.append(projectWalk.matches);
+    }
+
+    QList<ProjectCandidate> projectCandidates = collectCandidates(path, matches);
+    ingestCandidates(result, projectCandidates, scanTimestamp);
+
+    return result;
+}
+
+QSharedPointer<Branch> BranchScanner::updateLibraries(
+        const QSharedPointer<Branch> &branch, const QStringList &libraryKeys)
+{
+    QSharedPointer<Branch> result;
+    if (branch.isNull())
+    {
+        return result;
+    }
+    result = branch;
+    ScanThrottle::IdleIoPriority idleIoPriority(isBackgroundScan());
+
+    qint64 scanTimestamp = QDateTime::currentMSecsSinceEpoch();
+
+    // bound placeholders lead the walk straight to the directories of each library
+    BranchLayoutMatcher matcher = createMatcher(result);
+    DirectoryWalker walker;
+    QList<BranchLayoutMatcher::Match> matches;
+    foreach (const QString &libraryKey, libraryKeys)
+    {
+        QString projectName = libraryKey.section('/', 0, 0);
+        QString libraryName = libraryKey.section('/', 1);
+        if (projectName.isEmpty() || libraryName.isEmpty())
         {
             continue;
         }
-        QSharedPointer<Project> project = result->getProject(projectName);
+        matcher.walk(matcher.createStep(result->getPath(), projectName, libraryName),
+                     isNativeWalk() ? &walker : 0, matches);
+    }
 
-        QDir projectDir(projectPath);
-        QFileInfoList projectEntries = projectDir.entryInfoList(QDir::Dirs);
-        foreach (const QFileInfo &projectEntry, projectEntries)
+    ingestCandidates(result, collectCandidates(result->getPath(), matches), scanTimestamp);
+
+    return result;
+}
+
+void BranchScanner::ingestCandidates(const QSharedPointer<Branch> &branch,
+                                     const QList<ProjectCandidate> &projectCandidates,
+                                     qint64 timestamp)
+{
+    // merge the discovered libraries into the model on this thread only
+    QList<TlogJob> tlogJobs;
+    QList<CoverageJob> coverageJobs;
+    foreach (const ProjectCandidate &projectCandidate, projectCandidates)
+    {
+        QSharedPointer<Project> project = branch->getProject(projectCandidate.name);
+        foreach (const LibraryCandidate &libraryCandidate, projectCandidate.libraries)
         {
             QSharedPointer<Library> library;
-            QString libraryName = projectEntry.fileName();
-            if (libraryName.endsWith("Test") || libraryName == "." || libraryName == ".."
-                    || libraryName == "_")
+            if (not project.isNull())
             {
-                continue;
+                library = project->getLibrary(libraryCandidate.name);
             }
-            if (not project.isNull())
+            if (project.isNull())
             {
-                library = project->getLibrary(libraryName);
+                project = QSharedPointer<Project>(new Project());
+                project->withName(projectCandidate.name).withPath(projectCandidate.path);
+                branch->addProject(project);
             }
-            QString libraryPath = projectEntry.absoluteFilePath();
-
-            QString tlogFilePath = QString("%1/_/tests/%2/tlog").arg(projectPath).arg(libraryName);
-            QString lcovFilePath =
-                    QString("%1/_/testcoverage/%2/index.html").arg(projectPath).arg(libraryName);
-
-            QFileInfo libraryUnitTestTlogFileInfo(tlogFilePath);
-            QFileInfo libraryUnitTestLcovFileInfo(lcovFilePath);
-            if (libraryUnitTestTlogFileInfo.isFile() && libraryUnitTestTlogFileInfo.exists()&&
-                    libraryUnitTestLcovFileInfo.isFile() && libraryUnitTestLcovFileInfo.exists())
+            if (library.isNull())
             {
-                if (project.isNull())
-                {
-                    project = QSharedPointer<Project>(new Project());
-                    project->withName(projectName).withPath(projectPath);
-                    result->addProject(project);
-                }
-                if (library.isNull())
-                {
-                    library = QSharedPointer<Library>(new Library());
-                    library->withName(libraryName).withPath(libraryPath).withLcovPath(lcovFilePath);
-                    project->addLibrary(library);
-                }
-                analyzeTlog(tlogFilePath, library, scanTimestamp);
+                library = QSharedPointer<Library>(new Library());
+                library->withName(libraryCandidate.name).withPath(libraryCandidate.path);
+                project->addLibrary(library);
             }
+            // a changed layout may move the output of a known library
+            library->withTlogPath(libraryCandidate.tlogFilePath)
+                    .withLcovPath(libraryCandidate.lcovFilePath);
+            library->withInfoPath(libraryCandidate.infoFilePath);
+            bool infoUnchanged = m_incrementalScan &&
+                    library->getInfoFingerprint().hasSameMetaData(libraryCandidate.infoFingerprint);
+            bool lcovUnchanged = m_incrementalScan &&
+                    library->getLcovFingerprint().hasSameMetaData(libraryCandidate.lcovFingerprint);
+            CoverageJob coverageJob;
+            coverageJob.library = library;
+            if (not libraryCandidate.infoFilePath.isEmpty())
+            {
+                library->withLcovFingerprint(libraryCandidate.lcovFingerprint);
+                coverageJob.filePath = infoUnchanged ? QString() : libraryCandidate.infoFilePath;
+                coverageJob.fingerprint = libraryCandidate.infoFingerprint;
+            }
+            else if (not lcovUnchanged)
+            {
+                // the report's fingerprint is taken once its summary is read
+                coverageJob.filePath = libraryCandidate.lcovFilePath;
+                coverageJob.fromReport = true;
+                coverageJob.fingerprint = libraryCandidate.lcovFingerprint;
+            }
+            if (not coverageJob.filePath.isEmpty())
+            {
+                coverageJobs.append(coverageJob);
+            }
+            if (m_incrementalScan &&
+                    library->getTlogFingerprint().hasSameMetaData(libraryCandidate.tlogFingerprint))
+            {
+                // tlog is unchanged since the last scan
+                continue;
+            }
+            TlogJob job;
+            job.tlogFilePath = libraryCandidate.tlogFilePath;
+            job.library = library;
+            job.fingerprint = libraryCandidate.tlogFingerprint;
+            tlogJobs.append(job);
+        }
+    }
+
+    // coverage is known before the branch is published, it is cheap next to the tlogs
+    analyzeCoverage(coverageJobs);
+    foreach (const CoverageJob &job, coverageJobs)
+    {
+        if (not job.parsed)
+        {
+            // the fingerprint stays untouched, so the next scan picks the tracefile up again
+            continue;
+        }
+        qint64 coverageTimestamp = job.fingerprint.getModified() > 0
+                ? job.fingerprint.getModified() : timestamp;
+        job.library->addCoverage(coverageTimestamp, job.coverage);
+        job.library->addFileCoverages(coverageTimestamp, job.fileCoverages);
+        if (job.fromReport)
+        {
+            job.library->withLcovFingerprint(job.fingerprint);
+        }
+        else
+        {
+            job.library->withInfoFingerprint(job.fingerprint);
         }
     }
 
+    // before the branch is published, like any other change to libraries that are not busy
+    closeStaleTails(branch->getPath());
+
+    // the most recently written tlogs carry the news, parse them first
+    qStableSort(tlogJobs.begin(), tlogJobs.end(), isNewerTlogJob);
+
+    if (not m_progress.isNull())
+    {
+        qint64 bytes = 0;
+        foreach (const TlogJob &job, tlogJobs)
+        {
+            bytes += qMax(Q_INT64_C(0), job.fingerprint.getSize());
+            m_progress->addBusyLibrary(job.library.data());
+        }
+        m_progress->addPendingLibraries(tlogJobs.size(), bytes);
+        // the model structure is complete, from now on only busy libraries change
+        m_progress->publishBranch(branch);
+    }
+    analyzeTlogs(tlogJobs, timestamp);
+}
+
+BranchLayoutMatcher BranchScanner::createMatcher(const QSharedPointer<Branch> &branch) const
+{
+    BranchLayoutMatcher result(branch->getLayout());
+    if (not result.isValid())
+    {
+        qWarning() << "Scanning" << branch->getPath() << "with the default layout:"
+                   << result.getError();
+        result = BranchLayoutMatcher();
+    }
     return result;
 }
 
-void BranchScanner::analyzeTlog(const QString &tlogFilePath,
-                                const QSharedPointer<Library> &library,
-                                qint64 timestamp)
+void BranchScanner::walkProject(const BranchLayoutMatcher &matcher, ProjectWalk &walk) const
 {
-    QFileInfo tlogFileInfo(tlogFilePath);
-    if (library.isNull() || not tlogFileInfo.exists())
+    if (isCancelled())
     {
         return;
     }
+    DirectoryWalker walker;
+    matcher.walk(walk.step, isNativeWalk() ? &walker : 0, walk.matches);
+}
 
-    QFile tlogFile(tlogFilePath);
-    if (not tlogFile.open(QIODevice::ReadOnly | QIODevice::Text))
+QList<BranchScanner::ProjectCandidate> BranchScanner::collectCandidates(
+        const QString &branchPath, const QList<BranchLayoutMatcher::Match> &matches) const
+{
+    // a library needs a tlog and a report, the first matching template of each wins
+    QMap<QString, int> tlogMatches, lcovMatches, infoMatches;
+    for (int i = 0; i < matches.size(); ++i)
+    {
+        const BranchLayoutMatcher::Match &match = matches.at(i);
+        QMap<QString, int> &best = match.role == BranchLayoutMatcher::Tlog ? tlogMatches
+                : match.role == BranchLayoutMatcher::Lcov ? lcovMatches : infoMatches;
+        QString libraryKey = QString("%1/%2").arg(match.project).arg(match.library);
+        if (not best.contains(libraryKey) ||
+                matches.at(best.value(libraryKey)).priority > match.priority)
+        {
+            best.insert(libraryKey, i);
+        }
+    }
+
+    QMap<QString, ProjectCandidate> projectCandidates;
+    QMap<QString, int>::const_iterator it = tlogMatches.constBegin();
+    for (; it != tlogMatches.constEnd(); ++it)
+    {
+        if (not lcovMatches.contains(it.key()))
+        {
+            continue;
+        }
+        const BranchLayoutMatcher::Match &tlogMatch = matches.at(it.value());
+        const BranchLayoutMatcher::Match &lcovMatch = matches.at(lcovMatches.value(it.key()));
+        if (not projectCandidates.contains(tlogMatch.project))
+        {
+            ProjectCandidate projectCandidate;
+            projectCandidate.name = tlogMatch.project;
+            projectCandidate.path =
+                    QDir::cleanPath(QString("%1/%2").arg(branchPath).arg(tlogMatch.project));
+            projectCandidates.insert(tlogMatch.project, projectCandidate);
+        }
+        ProjectCandidate &projectCandidate = projectCandidates[tlogMatch.project];
+        LibraryCandidate candidate;
+        candidate.name = tlogMatch.library;
+        candidate.path = QString("%1/%2").arg(projectCandidate.path).arg(tlogMatch.library);
+        candidate.tlogFilePath = tlogMatch.filePath;
+        candidate.lcovFilePath = lcovMatch.filePath;
+        candidate.tlogFingerprint.withModified(tlogMatch.modified).withSize(tlogMatch.size);
+        candidate.lcovFingerprint.withModified(lcovMatch.modified).withSize(lcovMatch.size);
+        if (infoMatches.contains(it.key()))
+        {
+            const BranchLayoutMatcher::Match &infoMatch = matches.at(infoMatches.value(it.key()));
+            candidate.infoFilePath = infoMatch.filePath;
+            candidate.infoFingerprint.withModified(infoMatch.modified).withSize(infoMatch.size);
+        }
+        projectCandidate.libraries.append(candidate);
+    }
+
+    if (not m_progress.isNull())
+    {
+        int libraries = 0;
+        foreach (const ProjectCandidate &projectCandidate, projectCandidates)
+        {
+            libraries += projectCandidate.libraries.size();
+        }
+        m_progress->addDiscoveredLibraries(libraries);
+    }
+    return projectCandidates.values();
+}
+
+void BranchScanner::analyzeCoverage(QList<CoverageJob> &jobs)
+{
+    // runs before the tlogs, the coverage is keyed on the modification time of its file
+    // each task fills only its own job
+    if (isParallelScan() && jobs.size() > 1)
+    {
+        QThreadPool pool;
+        pool.setMaxThreadCount(isBackgroundScan() ? qMin(m_maxThreadCount, backgroundThreadCount)
+                                                  : m_maxThreadCount);
+        for (int i = 0; i < jobs.size(); ++i)
+        {
+            pool.start(new ParseCoverageTask(this, &jobs[i]));
+        }
+        pool.waitForDone();
+        return;
+    }
+
+    for (int i = 0; i < jobs.size(); ++i)
+    {
+        parseCoverage(jobs[i]);
+    }
+}
+
+void BranchScanner::parseCoverage(CoverageJob &job) const
+{
+    if (not throttle(qMax(Q_INT64_C(0), job.fingerprint.getSize())))
     {
         return;
     }
+    if (job.fromReport)
+    {
+        // a library without a tracefile gets the headline numbers of its genhtml report;
+        // a report without a readable header still counts as read, it is not tried again
+        LcovSummaryParser parser;
+        job.parsed = parser.parse(job.filePath) || QFileInfo(job.filePath).isFile();
+        job.coverage = parser.getCoverage();
+    }
+    else
+    {
+        LcovInfoParser parser;
+        job.parsed = parser.parse(job.filePath);
+        job.coverage = parser.getCoverage();
+        job.fileCoverages = parser.getFileCoverages();
+    }
+    if (isBackgroundScan())
+    {
+        ScanThrottle::dropFromPageCache(job.filePath);
+    }
+}
 
-    QString patternTestCaseBeginStartOfLine("********* Start ");
-    QString patternTestCaseBeginEndOfLine(" *********");
-    QString patternTestCaseEndStartOfLine("********* Finished testing of ");
-    QString patternTestCaseEndEndOfLine(" *********");
-    // "Totals: 9 passed, 0 failed, 0 skipped"
-    QString patternTestCaseSummaryStartOfLine("Totals: ");
-    QString patternTestCaseSummaryPassed(" passed");
-    QString patternTestCaseSummaryFailed(" failed");
-    QString patternTestCaseSummarySkipped(" skipped");
-    // Fails
-    QString patternTestCaseFailBeginStartOfLine("FAIL!");
-    QString patternTestCaseFailEndStartOfLine("   Loc:");
-
-    QSharedPointer<Testcase> testcase;
-    QTextStream in(&tlogFile);
-    int lineNumber = 0, testcaseStartLine = 0, testcaseEndLine;
-    QStringList failLog;
-    bool inFailLogOutput = false;
-    while (not in.atEnd())
-    {
-        QString line = in.readLine();
-        ++lineNumber;
-
-        if (line.startsWith(patternTestCaseBeginStartOfLine) &&
-                line.endsWith(patternTestCaseBeginEndOfLine))
-        {
-            testcaseStartLine = lineNumber - 1;
-            failLog.clear();
-            QString testcaseName = line.replace(patternTestCaseBeginStartOfLine, "").
-                    replace(patternTestCaseBeginEndOfLine, "")
-                    .split("::").last();
-            testcase = library->getTestcase(testcaseName);
-            if (testcase.isNull())
+void BranchScanner::analyzeTlogs(const QList<TlogJob> &jobs, qint64 timestamp)
+{
+    if (isBatchedReads() && jobs.size() > 1)
+    {
+        QList<TlogJob> batchJobs;
+        QList<TlogJob> mappedJobs;
+        foreach (const TlogJob &job, jobs)
+        {
+            // a stored tail goes on from its offset instead of parsing the read tlog again
+            if (job.fingerprint.getSize() > batchMaxTlogSize ||
+                    (not m_tlogTails.isNull() && m_tlogTails->contains(job.tlogFilePath)))
+            {
+                mappedJobs.append(job);
+            }
+            else
             {
-                testcase = QSharedPointer<Testcase>(new Testcase());
-                testcase->withName(testcaseName);
-                library->addTestcase(testcase);
+                batchJobs.append(job);
             }
         }
-
-        if (line.startsWith(patternTestCaseFailBeginStartOfLine))
+        if (isParallelScan() && batchJobs.size() > 1)
         {
-            inFailLogOutput = true;
+            // every worker gets its own ring, the batches keep the newest first order
+            int batchSize = qBound(1, (batchJobs.size() + m_maxThreadCount - 1) / m_maxThreadCount,
+                                   batchQueueDepth);
+            QThreadPool pool;
+            pool.setMaxThreadCount(m_maxThreadCount);
+            for (int begin = 0; begin < batchJobs.size(); begin += batchSize)
+            {
+                pool.start(new AnalyzeTlogBatchTask(this, batchJobs.mid(begin, batchSize),
+                                                    timestamp));
+            }
+            foreach (const TlogJob &job, mappedJobs)
+            {
+                pool.start(new AnalyzeTlogTask(this, job, timestamp));
+            }
+            pool.waitForDone();
+            return;
         }
-        if (inFailLogOutput)
+        ingestTlogBatch(batchJobs, timestamp);
+        foreach (const TlogJob &job, mappedJobs)
         {
-            failLog << line;
-            if (line.startsWith(patternTestCaseFailEndStartOfLine))
+            if (isCancelled())
             {
-                inFailLogOutput = false;
+                break;
             }
+            ingestTlog(job, timestamp);
+        }
+        return;
+    }
+
+    if (isParallelScan() && jobs.size() > 1)
+    {
+        QThreadPool pool;
+        pool.setMaxThreadCount(isBackgroundScan() ? qMin(m_maxThreadCount, backgroundThreadCount)
+                                                  : m_maxThreadCount);
+        foreach (const TlogJob &job, jobs)
+        {
+            pool.start(new AnalyzeTlogTask(this, job, timestamp));
         }
+        pool.waitForDone();
+        return;
+    }
 
-        if (line.startsWith(patternTestCaseSummaryStartOfLine))
+    foreach (const TlogJob &job, jobs)
+    {
+        if (isCancelled())
+        {
+            break;
+        }
+        ingestTlog(job, timestamp);
+    }
+}
+
+void BranchScanner::ingestTlogBatch(const QList<TlogJob> &jobs, qint64 timestamp)
+{
+    UringReader reader(batchQueueDepth);
+    if (not reader.isValid())
+    {
+        // without io_uring the tlogs are read one by one
+        foreach (const TlogJob &job, jobs)
         {
-            QString keyNumbers = line.replace(patternTestCaseSummaryStartOfLine, "")
-                    .replace(patternTestCaseSummaryPassed, "")
-                    .replace(patternTestCaseSummaryFailed, "")
-                    .replace(patternTestCaseSummarySkipped, "");
+            if (isCancelled())
+            {
+                break;
+            }
+            ingestTlog(job, timestamp);
+        }
+        return;
+    }
+
+    QStringList tlogFilePaths;
+    QList<qint64> sizes;
+    foreach (const TlogJob &job, jobs)
+    {
+        tlogFilePaths.append(job.tlogFilePath);
+        sizes.append(job.fingerprint.getSize());
+    }
+    TlogBatchConsumer consumer(this, jobs, timestamp);
+    reader.readFiles(tlogFilePaths, sizes, consumer);
+}
 
-            QStringList numbers = keyNumbers.split(",");
-            qint32 passed = 0, failed = 0, skipped = 0;
-            if (numbers.size() == 3)
+void BranchScanner::ingestTlog(const TlogJob &job, qint64 timestamp, const QByteArray *content)
+{
+    if (job.library.isNull() || isCancelled())
+    {
+        // the fingerprint stays untouched, so the next scan picks the library up again
+        return;
+    }
+
+    Fingerprint fingerprint = job.fingerprint;
+    qint64 tlogSize = qMax(Q_INT64_C(0), fingerprint.getSize());
+    // one reservation per tlog, hashing and parsing it read the same pages
+    if (not throttle(tlogSize))
+    {
+        return;
+    }
+    if (m_contentHashing)
+    {
+        fingerprint.withHash(content ? QCryptographicHash::hash(*content,
+                                                                QCryptographicHash::Sha1).toHex()
+                                     : Fingerprint::hashFile(job.tlogFilePath));
+        if (m_incrementalScan && fingerprint.hasSameHash(job.library->getTlogFingerprint()))
+        {
+            // only touched, the content is unchanged
+            if (isBackgroundScan())
             {
-                passed = numbers.at(0).trimmed().toInt();
-                failed = numbers.at(1).trimmed().toInt();
-                skipped = numbers.at(2).trimmed().toInt();
+                ScanThrottle::dropFromPageCache(job.tlogFilePath);
             }
-            if (testcase->getTestrun(timestamp).isNull())
+            job.library->withTlogFingerprint(fingerprint);
+            if (not m_progress.isNull())
             {
-                            QString failLogAsString("");
-                            if (failed > 0)
-                            {
-                                failLogAsString = failLog.join("\n");
-                            }
-
-                            QSharedPointer<Testrun> testrun(new Testrun());
-                            testrun->withFailLog(failLogAsString)
-                                    .withResults(passed, failed, skipped)
-                                    .withTimestamp(timestamp);
-                            testcase->addTestrun(testrun);
+                m_progress->addParsedLibrary(job.library.data(), tlogSize);
             }
+            return;
         }
+    }
 
-        if (line.startsWith(patternTestCaseEndStartOfLine) &&
-                line.endsWith(patternTestCaseEndEndOfLine))
+    // a testrun is keyed on the time its tlog was written, rescanning the same tlog adds nothing
+    qint64 runTimestamp = job.fingerprint.getModified() > 0 ? job.fingerprint.getModified()
+                                                            : timestamp;
+    // a batch buffer is parsed only if no tail of the tlog is stored
+    bool tail = not content ||
+            (not m_tlogTails.isNull() && m_tlogTails->contains(job.tlogFilePath));
+    if (not (tail && tailTlog(job, runTimestamp)))
+    {
+        analyzeTlog(job.tlogFilePath, job.library, runTimestamp, content);
+    }
+    dropRepeatedTestruns(job, runTimestamp, fingerprint.getHash());
+    if (isBackgroundScan())
+    {
+        // the build's working set matters more than a tlog that is not read again
+        ScanThrottle::dropFromPageCache(job.tlogFilePath);
+    }
+    job.library->withTlogFingerprint(fingerprint);
+    if (not m_progress.isNull())
+    {
+        m_progress->addParsedLibrary(job.library.data(), tlogSize);
+    }
+}
+
+bool BranchScanner::tailTlog(const TlogJob &job, qint64 timestamp)
+{
+    if (m_tlogTails.isNull())
+    {
+        return false;
+    }
+    QSharedPointer<TlogParser> parser = m_tlogTails->take(job.tlogFilePath);
+    if (parser.isNull())
+    {
+        if (JUnitXmlParser::isJUnitXml(job.tlogFilePath) ||
+                TestlibXmlParser::isXmlTlog(job.tlogFilePath))
         {
-            testcaseEndLine = lineNumber - 1;
-            testcase->withTlogPath(tlogFilePath, testcaseStartLine, testcaseEndLine);
+            return false;
         }
+        // maps the whole tlog like analyzeTlog() does, kept only while a testcase is open
+        parser = QSharedPointer<TlogParser>(new TlogParser());
+    }
+    // a stored tail goes on only at its offset and with the same bytes in front of it,
+    // a tail keeps the timestamp of the scan that found the tlog first
+    parser->parseAppended(job.tlogFilePath, job.library, timestamp);
+    if (parser->isTestcaseOpen())
+    {
+        m_tlogTails->put(job.tlogFilePath, parser);
     }
+    return true;
+}
+
+void BranchScanner::closeStaleTails(const QString &branchPath)
+{
+    if (m_tlogTails.isNull())
+    {
+        return;
+    }
+    qint64 modifiedBefore = QDateTime::currentMSecsSinceEpoch() - staleTailMsecs;
+    QList<QSharedPointer<TlogParser> > staleTails =
+            m_tlogTails->takeStale(branchPath, modifiedBefore);
+    foreach (const QSharedPointer<TlogParser> &parser, staleTails)
+    {
+        parser->abortTestcase();
+    }
+}
+
+void BranchScanner::analyzeTlog(const QString &tlogFilePath,
+                                const QSharedPointer<Library> &library,
+                                qint64 timestamp, const QByteArray *content)
+{
+    if (content)
+    {
+        // read by a batch already, xml reports are still streamed from their file
+        if (not JUnitXmlParser::isJUnitXmlHead(*content) &&
+                not TestlibXmlParser::isXmlTlogHead(*content))
+        {
+            TlogParser parser;
+            parser.parseData(content->constData(), content->size(), tlogFilePath, library,
+                             timestamp);
+            return;
+        }
+    }
+    if (JUnitXmlParser::isJUnitXml(tlogFilePath))
+    {
+        JUnitXmlParser parser;
+        parser.parse(tlogFilePath, library, timestamp);
+        return;
+    }
+    if (TestlibXmlParser::isXmlTlog(tlogFilePath))
+    {
+        TestlibXmlParser parser;
+        parser.parse(tlogFilePath, library, timestamp);
+        return;
+    }
+    TlogParser parser;
+    parser.parse(tlogFilePath, library, timestamp);
+}
+
+void BranchScanner::dropRepeatedTestruns(const TlogJob &job, qint64 timestamp,
+                                         const QByteArray &tlogHash) const
+{
+    // a testrun that repeats the one before it is dropped; the plain text parser hashes every
+    // testcase segment itself, xml reports are hashed whole
+    QByteArray hash = tlogHash;
+    foreach (const QSharedPointer<Testcase> &testcase, job.library->getTestcases())
+    {
+        QSharedPointer<Testrun> testrun = testcase->getTestrun(timestamp);
+        if (testrun.isNull() || testrun->isInProgress() ||
+                not testrun->getSegmentHash().isEmpty())
+        {
+            continue;
+        }
+        if (hash.isEmpty())
+        {
+            hash = Fingerprint::hashFile(job.tlogFilePath);
+        }
+        testrun->withSegmentHash(hash);
+        if (testcase->isRepeatedTestrun(testrun))
+        {
+            testcase->deleteTestrun(timestamp);
+        }
+    }
+}
+
+QSharedPointer<TlogParser> BranchScanner::TlogTails::take(const QString &tlogFilePath)
+{
+    QMutexLocker locker(&m_mutex);
+    return m_parsers.take(tlogFilePath);
+}
+
+QList<QSharedPointer<TlogParser> > BranchScanner::TlogTails::takeStale(
+        const QString &branchPath, qint64 modifiedBefore)
+{
+    QMutexLocker locker(&m_mutex);
+    QList<QSharedPointer<TlogParser> > result;
+    QString prefix = branchPath.endsWith('/') ? branchPath : branchPath + '/';
+    QMutableHashIterator<QString, QSharedPointer<TlogParser> > it(m_parsers);
+    while (it.hasNext())
+    {
+        it.next();
+        if (not it.key().startsWith(prefix))
+        {
+            continue;
+        }
+        QFileInfo tlogFileInfo(it.key());
+        if (not tlogFileInfo.exists() ||
+                tlogFileInfo.lastModified().toMSecsSinceEpoch() < modifiedBefore)
+        {
+            result.append(it.value());
+            it.remove();
+        }
+    }
+    return result;
+}
+
+bool BranchScanner::TlogTails::contains(const QString &tlogFilePath)
+{
+    QMutexLocker locker(&m_mutex);
+    return m_parsers.contains(tlogFilePath);
+}
+
+void BranchScanner::TlogTails::put(const QString &tlogFilePath,
+                                   const QSharedPointer<TlogParser> &parser)
+{
+    QMutexLocker locker(&m_mutex);
+    m_parsers.insert(tlogFilePath, parser);
 }
@@ -0,0 +1,219 @@
+/**
+  * @file BranchWatcher.cpp
+  *
+  * @class BranchWatcher
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Watches the test output directories of branches
+  * @details The branch watcher registers file system watches on the tests and testcoverage
+  *          directories of every library of a watched branch. Changes are debounced and reported
+  *          per branch as a set of library keys "<project>/<library>".
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#include "BranchWatcher.h"
+
+#include <QFileInfo>
+#include <Model/Project.h>
+#include <Model/Library.h>
+
+using Model::Branch;
+using Model::Project;
+using Model::Library;
+
+namespace
+{
+
+const QStringList testOutputFileNames = QStringList() << "tlog" << "tlog.xml" << "junit.xml";
+
+} // namespace
+
+BranchWatcher::BranchWatcher(QObject *parent)
+    : QObject(parent)
+{
+    m_debounceTimer.setInterval(2000);
+    m_debounceTimer.setSingleShot(true);
+
+    connect(&m_fileSystemWatcher, SIGNAL(directoryChanged(QString)),
+            SLOT(handlePathChanged(QString)));
+    connect(&m_fileSystemWatcher, SIGNAL(fileChanged(QString)),
+            SLOT(handlePathChanged(QString)));
+    connect(&m_debounceTimer, SIGNAL(timeout()), SLOT(emitPendingChanges()));
+}
+
+void BranchWatcher::setDebounceInterval(int msecs)
+{
+    m_debounceTimer.setInterval(msecs);
+}
+
+void BranchWatcher::watchBranch(const QSharedPointer<Branch> &branch)
+{
+    if (branch.isNull())
+    {
+        return;
+    }
+
+    QString branchPath = branch->getPath();
+    foreach (const QSharedPointer<Project> &project, branch->getProjects())
+    {
+        foreach (const QSharedPointer<Library> &library, project->getLibraries())
+        {
+            QString libraryKey =
+                    QString("%1/%2").arg(project->getName()).arg(library->getName());
+            // the branch layout decides where a library's output lives, the scan found it there
+            if (not library->getTlogPath().isEmpty())
+            {
+                QFileInfo tlogFileInfo(library->getTlogPath());
+                QString testsPath = tlogFileInfo.absolutePath();
+                watchPath(testsPath, branchPath, libraryKey);
+                // a tlog rewritten in place does not change its directory
+                watchPath(tlogFileInfo.absoluteFilePath(), branchPath, libraryKey);
+                foreach (const QString &fileName, testOutputFileNames)
+                {
+                    watchPath(QString("%1/%2").arg(testsPath).arg(fileName),
+                              branchPath, libraryKey);
+                }
+            }
+            if (not library->getLcovPath().isEmpty())
+            {
+                watchPath(QFileInfo(library->getLcovPath()).absolutePath(),
+                          branchPath, libraryKey);
+            }
+            if (not library->getInfoPath().isEmpty())
+            {
+                watchPath(QFileInfo(library->getInfoPath()).absolutePath(),
+                          branchPath, libraryKey);
+            }
+        }
+    }
+}
+
+void BranchWatcher::watchPath(
+        const QString &path, const QString &branchPath, const QString &libraryKey)
+{
+    if (m_watchedPaths.contains(path) || not QFileInfo(path).exists())
+    {
+        return;
+    }
+    m_watchedPaths.insert(path, QPair<QString, QString>(branchPath, libraryKey));
+    m_fileSystemWatcher.addPath(path);
+}
+
+void BranchWatcher::unwatchBranch(const QString &branchPath)
+{
+    QStringList paths;
+    QHash<QString, QPair<QString, QString> >::const_iterator it = m_watchedPaths.constBegin();
+    for (; it != m_watchedPaths.constEnd(); ++it)
+    {
+        if (it.value().first == branchPath)
+        {
+            paths << it.key();
+        }
+    }
+    foreach (const QString &path, paths)
+    {
+        m_watchedPaths.remove(path);
+    }
+    if (not paths.isEmpty())
+    {
+        m_fileSystemWatcher.removePaths(paths);
+    }
+    m_changedLibraries.remove(branchPath);
+    m_pendingLibraries.remove(branchPath);
+}
+
+void BranchWatcher::unwatchAll()
+{
+    QStringList paths = m_watchedPaths.keys();
+    if (not paths.isEmpty())
+    {
+        m_fileSystemWatcher.removePaths(paths);
+    }
+    m_watchedPaths.clear();
+    m_changedLibraries.clear();
+    m_pendingLibraries.clear();
+    m_debounceTimer.stop();
+}
+
+bool BranchWatcher::isWatching(const QString &branchPath) const
+{
+    QHash<QString, QPair<QString, QString> >::const_iterator it = m_watchedPaths.constBegin();
+    for (; it != m_watchedPaths.constEnd(); ++it)
+    {
+        if (it.value().first == branchPath)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool BranchWatcher::hasPendingLibraries() const
+{
+    return not m_pendingLibraries.isEmpty();
+}
+
+QStringList BranchWatcher::pendingBranches() const
+{
+    return m_pendingLibraries.keys();
+}
+
+QStringList BranchWatcher::takePendingLibraries(const QString &branchPath)
+{
+    return m_pendingLibraries.take(branchPath).toList();
+}
+
+void BranchWatcher::addPendingLibraries(const QString &branchPath,
+                                        const QStringList &libraryKeys)
+{
+    if (libraryKeys.isEmpty())
+    {
+        return;
+    }
+    m_pendingLibraries[branchPath].unite(libraryKeys.toSet());
+    emit librariesChanged();
+}
+
+void BranchWatcher::handlePathChanged(const QString &path)
+{
+    if (not m_watchedPaths.contains(path))
+    {
+        return;
+    }
+    QPair<QString, QString> owner = m_watchedPaths.value(path);
+    m_changedLibraries[owner.first].insert(owner.second);
+
+    // a tlog replaced by a new file drops its watch, so register it again
+    if (not m_fileSystemWatcher.files().contains(path) &&
+            not m_fileSystemWatcher.directories().contains(path))
+    {
+        m_watchedPaths.remove(path);
+    }
+    if (QFileInfo(path).isDir())
+    {
+        foreach (const QString &fileName, testOutputFileNames)
+        {
+            watchPath(QString("%1/%2").arg(path).arg(fileName), owner.first, owner.second);
+        }
+    }
+
+    // restart the debounce interval on every write
+    m_debounceTimer.start();
+}
+
+void BranchWatcher::emitPendingChanges()
+{
+    if (m_changedLibraries.isEmpty())
+    {
+        return;
+    }
+    QMap<QString, QSet<QString> >::const_iterator it = m_changedLibraries.constBegin();
+    for (; it != m_changedLibraries.constEnd(); ++it)
+    {
+        m_pendingLibraries[it.key()].unite(it.value());
+    }
+    m_changedLibraries.clear();
+    emit librariesChanged();
+}
@@ -0,0 +1,240 @@
+/**
+  * @file CoverageDelta.cpp
+  *
+  * @class CoverageDelta
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Compares the coverage of two runs file by file and line by line
+  * @details Both runs hand in their FileCoverages ordered by path, so the files are paired in one
+  *          walk over both lists, and the sorted line and function arrays of a pair are walked side
+  *          by side the same way. Nothing is hashed or looked up, a comparison is linear in the
+  *          instrumented lines of both runs. A line or function gained coverage if it ran in the
+  *          newer run only and lost it if it ran in the older run only. Lines and functions that
+  *          exist in one run only are counted as added or removed, they are neither gained nor
+  *          lost. Line numbers are compared as they are, an edit moving code shows up as losses
+  *          and gains. The files with changes are ordered by impact, the number of lines that
+  *          changed coverage, losses first.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#include "CoverageDelta.h"
+
+#include <QtAlgorithms>
+
+using Model::FileCoverage;
+
+namespace
+{
+
+bool hasMoreImpact(const CoverageDelta::FileDelta &left, const CoverageDelta::FileDelta &right)
+{
+    if (left.getImpact() != right.getImpact())
+    {
+        return left.getImpact() > right.getImpact();
+    }
+    if (left.lostLines.size() != right.lostLines.size())
+    {
+        return left.lostLines.size() > right.lostLines.size();
+    }
+    return left.path < right.path;
+}
+
+bool isBeforeByPath(const FileCoverage &left, const FileCoverage &right)
+{
+    return left.getPath() < right.getPath();
+}
+
+QList<FileCoverage> sortedByPath(const QList<FileCoverage> &fileCoverages)
+{
+    // parsers hand them out sorted already, then this is a single pass
+    for (int i = 1; i < fileCoverages.size(); ++i)
+    {
+        if (isBeforeByPath(fileCoverages.at(i), fileCoverages.at(i - 1)))
+        {
+            QList<FileCoverage> result = fileCoverages;
+            qStableSort(result.begin(), result.end(), isBeforeByPath);
+            return result;
+        }
+    }
+    return fileCoverages;
+}
+
+} // namespace
+
+int CoverageDelta::FileDelta::getImpact() const
+{
+    return gainedLines.size() + lostLines.size();
+}
+
+CoverageDelta::CoverageDelta()
+    : m_gainedLines(0),
+      m_lostLines(0),
+      m_comparedFiles(0)
+{
+}
+
+void CoverageDelta::compare(const QString &scope, const QList<FileCoverage> &older,
+                            const QList<FileCoverage> &newer)
+{
+    QList<FileCoverage> olderFiles = sortedByPath(older);
+    QList<FileCoverage> newerFiles = sortedByPath(newer);
+    int o = 0, n = 0;
+    while (o < olderFiles.size() || n < newerFiles.size())
+    {
+        FileDelta fileDelta;
+        if (n == newerFiles.size() ||
+                (o < olderFiles.size() && isBeforeByPath(olderFiles.at(o), newerFiles.at(n))))
+        {
+            fileDelta.path = olderFiles.at(o).getPath();
+            fileDelta.removedLines = olderFiles.at(o).getLines().size();
+            ++o;
+        }
+        else if (o == olderFiles.size() || isBeforeByPath(newerFiles.at(n), olderFiles.at(o)))
+        {
+            fileDelta.path = newerFiles.at(n).getPath();
+            fileDelta.addedLines = newerFiles.at(n).getLines().size();
+            ++n;
+        }
+        else
+        {
+            fileDelta = compareFiles(olderFiles.at(o), newerFiles.at(n));
+            ++o;
+            ++n;
+        }
+        fileDelta.scope = scope;
+        ++m_comparedFiles;
+        addFileDelta(fileDelta);
+    }
+}
+
+CoverageDelta::FileDelta CoverageDelta::compareFiles(const FileCoverage &older,
+                                                     const FileCoverage &newer)
+{
+    FileDelta result;
+    result.path = newer.getPath();
+
+    const QVector<qint64> olderLines = older.getLines();
+    const QVector<qint64> olderHits = older.getLineHits();
+    const QVector<qint64> newerLines = newer.getLines();
+    const QVector<qint64> newerHits = newer.getLineHits();
+    int o = 0, n = 0;
+    while (o < olderLines.size() && n < newerLines.size())
+    {
+        if (olderLines.at(o) < newerLines.at(n))
+        {
+            ++result.removedLines;
+            ++o;
+        }
+        else if (newerLines.at(n) < olderLines.at(o))
+        {
+            ++result.addedLines;
+            ++n;
+        }
+        else
+        {
+            bool ranBefore = olderHits.at(o) > 0;
+            bool runsNow = newerHits.at(n) > 0;
+            if (runsNow && not ranBefore)
+            {
+                result.gainedLines.append(newerLines.at(n));
+            }
+            else if (ranBefore && not runsNow)
+            {
+                result.lostLines.append(newerLines.at(n));
+            }
+            ++o;
+            ++n;
+        }
+    }
+    result.removedLines += olderLines.size() - o;
+    result.addedLines += newerLines.size() - n;
+
+    const QStringList olderFunctions = older.getFunctionNames();
+    const QVector<qint64> olderFunctionHits = older.getFunctionHits();
+    const QStringList newerFunctions = newer.getFunctionNames();
+    const QVector<qint64> newerFunctionHits = newer.getFunctionHits();
+    o = 0;
+    n = 0;
+    while (o < olderFunctions.size() && n < newerFunctions.size())
+    {
+        int order = QString::compare(olderFunctions.at(o), newerFunctions.at(n));
+        if (order < 0)
+        {
+            ++o;
+        }
+        else if (order > 0)
+        {
+            ++n;
+        }
+        else
+        {
+            bool ranBefore = olderFunctionHits.at(o) > 0;
+            bool runsNow = newerFunctionHits.at(n) > 0;
+            if (runsNow && not ranBefore)
+            {
+                result.gainedFunctions.append(newerFunctions.at(n));
+            }
+            else if (ranBefore && not runsNow)
+            {
+                result.lostFunctions.append(newerFunctions.at(n));
+            }
+            ++o;
+            ++n;
+        }
+    }
+    return result;
+}
+
+void CoverageDelta::addFileDelta(const FileDelta &fileDelta)
+{
+    m_gainedLines += fileDelta.gainedLines.size();
+    m_lostLines += fileDelta.lostLines.size();
+    if (fileDelta.getImpact() > 0 || fileDelta.addedLines > 0 || fileDelta.removedLines > 0 ||
+            not fileDelta.gainedFunctions.isEmpty() || not fileDelta.lostFunctions.isEmpty())
+    {
+        m_fileDeltas.append(fileDelta);
+    }
+}
+
+QList<CoverageDelta::FileDelta> CoverageDelta::getFileDeltas() const
+{
+    QList<FileDelta> result = m_fileDeltas;
+    qStableSort(result.begin(), result.end(), hasMoreImpact);
+    return result;
+}
+
+qint64 CoverageDelta::getGainedLines() const
+{
+    return m_gainedLines;
+}
+
+qint64 CoverageDelta::getLostLines() const
+{
+    return m_lostLines;
+}
+
+qint64 CoverageDelta::getComparedFiles() const
+{
+    return m_comparedFiles;
+}
+
+QString CoverageDelta::formatLines(const QVector<qint64> &lines)
+{
+    // consecutive lines are joined into ranges: 3, 7-9, 12
+    QStringList ranges;
+    int i = 0;
+    while (i < lines.size())
+    {
+        int end = i;
+        while (end + 1 < lines.size() && lines.at(end + 1) == lines.at(end) + 1)
+        {
+            ++end;
+        }
+        ranges.append(end == i ? QString::number(lines.at(i))
+                               : QString("%1-%2").arg(lines.at(i)).arg(lines.at(end)));
+        i = end + 1;
+    }
+    return ranges.join(", ");
+}
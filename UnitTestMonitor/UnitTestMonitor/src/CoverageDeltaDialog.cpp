@@ -0,0 +1,195 @@
+/**
+  * @file CoverageDeltaDialog.cpp
+  *
+  * @class CoverageDeltaDialog
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Dialog showing how the coverage changed between two runs
+  * @details The CoverageDeltaDialog lists every source file whose coverage differs between an
+  *          older and a newer run, the files losing most coverage first. Selecting a file shows
+  *          the lines and functions that lost and gained coverage, consecutive lines joined into
+  *          ranges. The comparison itself is done by a CoverageDelta, the dialog only shows it.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#include "CoverageDeltaDialog.h"
+#include "ui_CoverageDeltaDialog.h"
+
+#include <QColor>
+#include <QHeaderView>
+#include <QSettings>
+#include <QSortFilterProxyModel>
+#include <QStandardItemModel>
+
+namespace
+{
+
+const int sortRole = Qt::UserRole + 1;
+const int fileDeltaRole = Qt::UserRole + 2;
+
+enum Column
+{
+    FileColumn = 0,
+    LostLinesColumn,
+    GainedLinesColumn,
+    LostFunctionsColumn,
+    GainedFunctionsColumn,
+    AddedLinesColumn,
+    RemovedLinesColumn
+};
+
+// same tints as failed and passed tests
+const QColor lostColor = QColor::fromRgb(240, 130, 130, 230);
+const QColor gainedColor = QColor::fromRgb(150, 240, 150, 230);
+
+} // namespace
+
+CoverageDeltaDialog::CoverageDeltaDialog(QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::CoverageDeltaDialog),
+    m_filesModel(0),
+    m_filesProxyModel(0)
+{
+    ui->setupUi(this);
+    m_filesModel = new QStandardItemModel(this);
+    m_filesProxyModel = new QSortFilterProxyModel(this);
+    m_filesProxyModel->setSourceModel(m_filesModel);
+    m_filesProxyModel->setSortRole(sortRole);
+    m_filesProxyModel->setFilterKeyColumn(FileColumn);
+    m_filesProxyModel->setFilterCaseSensitivity(Qt::CaseInsensitive);
+    ui->filesTableView->setModel(m_filesProxyModel);
+    ui->filesTableView->setSortingEnabled(true);
+
+    connect(this, SIGNAL(finished(int)), SLOT(storeGeometry()));
+    connect(ui->filesTableView, SIGNAL(activated(QModelIndex)), SLOT(showFileDelta(QModelIndex)));
+    connect(ui->filesTableView, SIGNAL(clicked(QModelIndex)), SLOT(showFileDelta(QModelIndex)));
+    connect(ui->filterLineEdit, SIGNAL(textChanged(QString)),
+            m_filesProxyModel, SLOT(setFilterFixedString(QString)));
+
+    QSettings settings;
+    ui->splitter->restoreState(settings.value("CoverageDeltaDialog/splitter").toByteArray());
+}
+
+CoverageDeltaDialog::~CoverageDeltaDialog()
+{
+    delete ui;
+}
+
+void CoverageDeltaDialog::storeGeometry()
+{
+    QSettings settings;
+    settings.setValue("CoverageDeltaDialog/size", size());
+    settings.setValue("CoverageDeltaDialog/pos", pos());
+    settings.setValue("CoverageDeltaDialog/splitter", ui->splitter->saveState());
+    settings.sync();
+}
+
+QStandardItem* CoverageDeltaDialog::createItem(const QString &text, const QVariant &sortValue)
+{
+    QStandardItem *item = new QStandardItem(text);
+    item->setEditable(false);
+    item->setData(sortValue, sortRole);
+    return item;
+}
+
+QStandardItem* CoverageDeltaDialog::createCountItem(qint64 count, const QColor &color)
+{
+    QStandardItem *item = createItem(count > 0 ? QString::number(count) : QString(), count);
+    item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    if (count > 0 && color.isValid())
+    {
+        item->setBackground(color);
+    }
+    return item;
+}
+
+void CoverageDeltaDialog::initialize(const CoverageDelta &delta, const QString &olderRun,
+                                     const QString &newerRun)
+{
+    m_filesModel->clear();
+    m_filesModel->setHorizontalHeaderLabels(QStringList() << "Source file" << "Lost lines"
+                                            << "Gained lines" << "Lost functions"
+                                            << "Gained functions" << "Added lines"
+                                            << "Removed lines");
+    ui->detailsTextEdit->clear();
+    m_fileDeltas = delta.getFileDeltas();
+
+    for (int i = 0; i < m_fileDeltas.size(); ++i)
+    {
+        const CoverageDelta::FileDelta &fileDelta = m_fileDeltas.at(i);
+        QString name = fileDelta.scope.isEmpty() ? fileDelta.path
+                                                 : fileDelta.scope + ": " + fileDelta.path;
+        QList<QStandardItem*> rowItems;
+        QStandardItem *fileItem = createItem(name, name.toLower());
+        fileItem->setData(i, fileDeltaRole);
+        fileItem->setToolTip(fileDelta.path);
+        rowItems << fileItem
+                 << createCountItem(fileDelta.lostLines.size(), lostColor)
+                 << createCountItem(fileDelta.gainedLines.size(), gainedColor)
+                 << createCountItem(fileDelta.lostFunctions.size(), lostColor)
+                 << createCountItem(fileDelta.gainedFunctions.size(), gainedColor)
+                 << createCountItem(fileDelta.addedLines, QColor())
+                 << createCountItem(fileDelta.removedLines, QColor());
+        m_filesModel->appendRow(rowItems);
+    }
+
+    ui->descriptionLabel->setText(tr("%1 compared to %2: %3 of %4 source files changed, "
+                                     "%5 lines lost and %6 lines gained coverage")
+                                  .arg(newerRun).arg(olderRun).arg(m_fileDeltas.size())
+                                  .arg(delta.getComparedFiles()).arg(delta.getLostLines())
+                                  .arg(delta.getGainedLines()));
+    // the deltas come ordered by impact, the view keeps that order until a header is clicked
+    m_filesProxyModel->sort(-1);
+    ui->filesTableView->horizontalHeader()->setSortIndicator(-1, Qt::AscendingOrder);
+    ui->filesTableView->resizeColumnsToContents();
+    if (not m_fileDeltas.isEmpty())
+    {
+        QModelIndex first = m_filesProxyModel->index(0, FileColumn);
+        ui->filesTableView->setCurrentIndex(first);
+        showFileDelta(first);
+    }
+}
+
+void CoverageDeltaDialog::showFileDelta(const QModelIndex &index)
+{
+    QModelIndex fileIndex = m_filesProxyModel->mapToSource(index.sibling(index.row(), FileColumn));
+    QStandardItem *fileItem = m_filesModel->itemFromIndex(fileIndex);
+    if (not fileItem)
+    {
+        return;
+    }
+    int fileDeltaIndex = fileItem->data(fileDeltaRole).toInt();
+    if (fileDeltaIndex < 0 || fileDeltaIndex >= m_fileDeltas.size())
+    {
+        return;
+    }
+    const CoverageDelta::FileDelta &fileDelta = m_fileDeltas.at(fileDeltaIndex);
+    QStringList details;
+    details << fileDelta.path << "";
+    if (not fileDelta.lostLines.isEmpty())
+    {
+        details << tr("Lines losing coverage:") << CoverageDelta::formatLines(fileDelta.lostLines)
+                << "";
+    }
+    if (not fileDelta.gainedLines.isEmpty())
+    {
+        details << tr("Lines gaining coverage:")
+                << CoverageDelta::formatLines(fileDelta.gainedLines) << "";
+    }
+    if (not fileDelta.lostFunctions.isEmpty())
+    {
+        details << tr("Functions losing coverage:") << fileDelta.lostFunctions << "";
+    }
+    if (not fileDelta.gainedFunctions.isEmpty())
+    {
+        details << tr("Functions gaining coverage:") << fileDelta.gainedFunctions << "";
+    }
+    if (fileDelta.addedLines > 0 || fileDelta.removedLines > 0)
+    {
+        details << tr("%1 instrumented lines added, %2 removed.")
+                   .arg(fileDelta.addedLines).arg(fileDelta.removedLines);
+    }
+    ui->detailsTextEdit->setPlainText(details.join("\n"));
+}
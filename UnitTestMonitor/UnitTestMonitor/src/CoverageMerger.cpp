@@ -0,0 +1,338 @@
+/**
+  * @file CoverageMerger.cpp
+  *
+  * @class CoverageMerger
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Merges the coverage of all libraries of a branch into project and branch coverage
+  * @details Like lcov -a the merger adds up the execution counts a source file has in the
+  *          tracefiles of several libraries, so a header shared by libraries counts once. The
+  *          latest run of every library is read from its CoverageHistory. The source files are
+  *          split into chunks merged in parallel on a pool; a chunk is handled one source file at
+  *          a time, only that file is decoded from the histories holding it, so memory stays
+  *          bounded by one file per library. The copies of a file are merged pairwise in a tree,
+  *          first within each project and then the project results into the branch result.
+  *          Branches are counted per file only, the copy covering most of them is taken. The
+  *          partial results of the chunks are added up in a tree as well. Libraries known from
+  *          their genhtml report only have no file coverage and are left out.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#include "CoverageMerger.h"
+
+#include <QRunnable>
+#include <QSet>
+#include <QThreadPool>
+#include <Model/Project.h>
+#include <Model/Library.h>
+
+using Model::Branch;
+using Model::Coverage;
+using Model::CoverageHistory;
+using Model::FileCoverage;
+using Model::Library;
+using Model::Project;
+
+namespace
+{
+
+// source files per task, small enough to spread the work, large enough to be worth a task
+const int chunkSize = 64;
+
+} // namespace
+
+/**
+  * @brief Merges one chunk of source files on a pool thread.
+  * @details Each task fills only its own partial result.
+  */
+class MergeChunkTask : public QRunnable
+{
+public:
+    MergeChunkTask(const QList<CoverageMerger::Source> *sources, const QStringList &paths,
+                   CoverageMerger::Partial *partial)
+        : m_sources(sources),
+          m_paths(paths),
+          m_partial(partial)
+    {
+    }
+
+    void run()
+    {
+        CoverageMerger::mergeChunk(*m_sources, m_paths, *m_partial);
+    }
+
+private:
+    const QList<CoverageMerger::Source> *m_sources;
+    QStringList m_paths;
+    CoverageMerger::Partial *m_partial;
+};
+
+void CoverageMerger::Counts::add(const FileCoverage &fileCoverage)
+{
+    linesFound += fileCoverage.getLines().size();
+    linesHit += fileCoverage.getLinesHit();
+    functionsFound += fileCoverage.getFunctionNames().size();
+    functionsHit += fileCoverage.getFunctionsHit();
+    branchesFound += fileCoverage.getBranchesFound();
+    branchesHit += fileCoverage.getBranchesHit();
+}
+
+void CoverageMerger::Counts::add(const Counts &other)
+{
+    linesFound += other.linesFound;
+    linesHit += other.linesHit;
+    functionsFound += other.functionsFound;
+    functionsHit += other.functionsHit;
+    branchesFound += other.branchesFound;
+    branchesHit += other.branchesHit;
+}
+
+Coverage CoverageMerger::Counts::toCoverage() const
+{
+    Coverage result;
+    result.withLines(linesFound, linesHit)
+            .withFunctions(functionsFound, functionsHit)
+            .withBranches(branchesFound, branchesHit);
+    return result;
+}
+
+void CoverageMerger::Partial::add(const Partial &other)
+{
+    for (QMap<QString, Counts>::const_iterator it = other.projects.constBegin();
+         it != other.projects.constEnd(); ++it)
+    {
+        projects[it.key()].add(it.value());
+    }
+    branch.add(other.branch);
+    files += other.files;
+}
+
+QList<CoverageMerger::Source> CoverageMerger::collectSources(
+        const QSharedPointer<Branch> &branch, QString &signature)
+{
+    QList<Source> result;
+    QStringList signatureParts;
+    if (branch.isNull())
+    {
+        signature = QString();
+        return result;
+    }
+    signatureParts << branch->getPath();
+    foreach (const QSharedPointer<Project> &project, branch->getProjects())
+    {
+        foreach (const QSharedPointer<Library> &library, project->getLibraries())
+        {
+            Source source;
+            source.project = project->getName();
+            source.history = library->getCoverageHistory();
+            QList<qint64> timestamps = source.history.getTimestamps();
+            if (timestamps.isEmpty())
+            {
+                continue;
+            }
+            source.timestamp = timestamps.last();
+            signatureParts << QString("%1/%2@%3").arg(source.project).arg(library->getName())
+                              .arg(source.timestamp);
+            result.append(source);
+        }
+    }
+    signature = signatureParts.join("\n");
+    return result;
+}
+
+CoverageMerger::Result CoverageMerger::merge(const QList<Source> &sources,
+                                             const QString &signature)
+{
+    Result result;
+    result.signature = signature;
+    result.sources = sources.size();
+
+    QSet<QString> pathSet;
+    foreach (const Source &source, sources)
+    {
+        pathSet.unite(QSet<QString>::fromList(source.history.getPaths()));
+        qint64 projectTimestamp = result.projectTimestamps.value(source.project, -1);
+        result.projectTimestamps.insert(source.project, qMax(projectTimestamp, source.timestamp));
+        result.branchTimestamp = qMax(result.branchTimestamp, source.timestamp);
+    }
+    QStringList paths = pathSet.toList();
+    pathSet.clear();
+    qSort(paths);
+
+    QList<QStringList> chunks;
+    for (int i = 0; i < paths.size(); i += chunkSize)
+    {
+        chunks.append(paths.mid(i, chunkSize));
+    }
+    QVector<Partial> partials(chunks.size());
+    if (chunks.size() > 1)
+    {
+        QThreadPool pool;
+        for (int i = 0; i < chunks.size(); ++i)
+        {
+            pool.start(new MergeChunkTask(&sources, chunks.at(i), &partials[i]));
+        }
+        pool.waitForDone();
+    }
+    else if (not chunks.isEmpty())
+    {
+        mergeChunk(sources, chunks.first(), partials[0]);
+    }
+
+    // neighbouring partials are added up pairwise until one is left
+    for (int step = 1; step < partials.size(); step *= 2)
+    {
+        for (int i = 0; i + step < partials.size(); i += 2 * step)
+        {
+            partials[i].add(partials.at(i + step));
+        }
+    }
+    if (not partials.isEmpty())
+    {
+        const Partial &total = partials.first();
+        for (QMap<QString, Counts>::const_iterator it = total.projects.constBegin();
+             it != total.projects.constEnd(); ++it)
+        {
+            result.projects.insert(it.key(), it.value().toCoverage());
+        }
+        result.branch = total.branch.toCoverage();
+        result.files = total.files;
+    }
+    return result;
+}
+
+void CoverageMerger::mergeChunk(const QList<Source> &sources, const QStringList &paths,
+                                Partial &partial)
+{
+    foreach (const QString &path, paths)
+    {
+        // only this source file is decoded, from every library holding it in its latest run
+        QMap<QString, QList<FileCoverage> > projectFiles;
+        foreach (const Source &source, sources)
+        {
+            FileCoverage fileCoverage = source.history.getFileCoverage(path, source.timestamp);
+            if (not fileCoverage.getPath().isEmpty())
+            {
+                projectFiles[source.project].append(fileCoverage);
+            }
+        }
+        if (projectFiles.isEmpty())
+        {
+            continue;
+        }
+        QList<FileCoverage> branchFiles;
+        for (QMap<QString, QList<FileCoverage> >::const_iterator it = projectFiles.constBegin();
+             it != projectFiles.constEnd(); ++it)
+        {
+            FileCoverage projectFile = reduce(it.value());
+            partial.projects[it.key()].add(projectFile);
+            branchFiles.append(projectFile);
+        }
+        partial.branch.add(reduce(branchFiles));
+        ++partial.files;
+    }
+}
+
+FileCoverage CoverageMerger::reduce(QList<FileCoverage> fileCoverages)
+{
+    if (fileCoverages.isEmpty())
+    {
+        return FileCoverage();
+    }
+    // pairwise rounds keep the merged arrays balanced, no copy is merged more than log n times
+    while (fileCoverages.size() > 1)
+    {
+        QList<FileCoverage> merged;
+        for (int i = 0; i + 1 < fileCoverages.size(); i += 2)
+        {
+            merged.append(mergeFiles(fileCoverages.at(i), fileCoverages.at(i + 1)));
+        }
+        if (fileCoverages.size() % 2 != 0)
+        {
+            merged.append(fileCoverages.last());
+        }
+        fileCoverages = merged;
+    }
+    return fileCoverages.first();
+}
+
+FileCoverage CoverageMerger::mergeFiles(const FileCoverage &left, const FileCoverage &right)
+{
+    const QVector<qint64> leftLines = left.getLines();
+    const QVector<qint64> leftHits = left.getLineHits();
+    const QVector<qint64> rightLines = right.getLines();
+    const QVector<qint64> rightHits = right.getLineHits();
+    QVector<qint64> lines;
+    QVector<qint64> lineHits;
+    lines.reserve(qMax(leftLines.size(), rightLines.size()));
+    lineHits.reserve(lines.capacity());
+    int l = 0, r = 0;
+    while (l < leftLines.size() || r < rightLines.size())
+    {
+        if (r == rightLines.size() || (l < leftLines.size() && leftLines.at(l) < rightLines.at(r)))
+        {
+            lines.append(leftLines.at(l));
+            lineHits.append(leftHits.at(l));
+            ++l;
+        }
+        else if (l == leftLines.size() || rightLines.at(r) < leftLines.at(l))
+        {
+            lines.append(rightLines.at(r));
+            lineHits.append(rightHits.at(r));
+            ++r;
+        }
+        else
+        {
+            lines.append(leftLines.at(l));
+            lineHits.append(leftHits.at(l) + rightHits.at(r));
+            ++l;
+            ++r;
+        }
+    }
+
+    const QStringList leftNames = left.getFunctionNames();
+    const QVector<qint64> leftFunctionHits = left.getFunctionHits();
+    const QStringList rightNames = right.getFunctionNames();
+    const QVector<qint64> rightFunctionHits = right.getFunctionHits();
+    QStringList functionNames;
+    QVector<qint64> functionHits;
+    l = 0;
+    r = 0;
+    while (l < leftNames.size() || r < rightNames.size())
+    {
+        int order = l == leftNames.size() ? 1 : r == rightNames.size()
+                                                ? -1 : leftNames.at(l).compare(rightNames.at(r));
+        if (order < 0)
+        {
+            functionNames.append(leftNames.at(l));
+            functionHits.append(leftFunctionHits.at(l));
+            ++l;
+        }
+        else if (order > 0)
+        {
+            functionNames.append(rightNames.at(r));
+            functionHits.append(rightFunctionHits.at(r));
+            ++r;
+        }
+        else
+        {
+            functionNames.append(leftNames.at(l));
+            functionHits.append(leftFunctionHits.at(l) + rightFunctionHits.at(r));
+            ++l;
+            ++r;
+        }
+    }
+
+    // single branches are not known, the copy covering most of them stands for the file
+    const FileCoverage &branches =
+            right.getBranchesHit() > left.getBranchesHit() ? right : left;
+
+    FileCoverage result;
+    result.withPath(left.getPath().isEmpty() ? right.getPath() : left.getPath())
+            .withLines(lines, lineHits)
+            .withFunctions(functionNames, functionHits)
+            .withBranches(branches.getBranchesFound(), branches.getBranchesHit());
+    return result;
+}
@@ -0,0 +1,236 @@
+/**
+  * @file CoverageViewDialog.cpp
+  *
+  * @class CoverageViewDialog
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Dialog showing the coverage of a library from its lcov tracefile
+  * @details The CoverageViewDialog lists the source files of a tracefile with their line,
+  *          function, and branch coverage, and shows the selected source file with the execution
+  *          count of every line next to it. No html is rendered: the file table is filled from one
+  *          parse of the tracefile and the source view only asks a SourceCoverageModel for the
+  *          rows it paints. The genhtml report can still be opened from the dialog if the
+  *          application was built with WebKit.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#include "CoverageViewDialog.h"
+#include "ui_CoverageViewDialog.h"
+
+#include <QApplication>
+#include <QColor>
+#include <QFileInfo>
+#include <QHeaderView>
+#include <QSettings>
+#include <QSortFilterProxyModel>
+#include <QStandardItemModel>
+#include <LcovInfoParser.h>
+#include <SourceCoverageModel.h>
+
+using Model::Coverage;
+using Model::FileCoverage;
+
+namespace
+{
+
+const int sortRole = Qt::UserRole + 1;
+const int sourceFileRole = Qt::UserRole + 2;
+
+enum Column
+{
+    FileColumn = 0,
+    LinesColumn,
+    LineRateColumn,
+    FunctionRateColumn,
+    BranchRateColumn
+};
+
+// rates below this are tinted like failed tests
+const double lowRate = 50.0;
+
+} // namespace
+
+CoverageViewDialog::CoverageViewDialog(QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::CoverageViewDialog),
+    m_filesModel(0),
+    m_filesProxyModel(0),
+    m_sourceModel(0)
+{
+    ui->setupUi(this);
+    m_filesModel = new QStandardItemModel(this);
+    m_filesProxyModel = new QSortFilterProxyModel(this);
+    m_filesProxyModel->setSourceModel(m_filesModel);
+    m_filesProxyModel->setSortRole(sortRole);
+    m_filesProxyModel->setFilterKeyColumn(FileColumn);
+    m_filesProxyModel->setFilterCaseSensitivity(Qt::CaseInsensitive);
+    ui->filesTableView->setModel(m_filesProxyModel);
+    ui->filesTableView->setSortingEnabled(true);
+
+    // rows of equal height are laid out without asking the model, only visible rows are read
+    m_sourceModel = new SourceCoverageModel(this);
+    ui->sourceTableView->setModel(m_sourceModel);
+    QHeaderView *verticalHeader = ui->sourceTableView->verticalHeader();
+    verticalHeader->setSectionResizeMode(QHeaderView::Fixed);
+    verticalHeader->setDefaultSectionSize(ui->sourceTableView->fontMetrics().height() + 2);
+    ui->sourceTableView->setColumnWidth(SourceCoverageModel::LineColumn,
+                                        ui->sourceTableView->fontMetrics().width("0000000"));
+    ui->sourceTableView->setColumnWidth(SourceCoverageModel::HitsColumn,
+                                        ui->sourceTableView->fontMetrics().width("000000000"));
+
+    connect(this, SIGNAL(finished(int)), SLOT(storeGeometry()));
+    connect(ui->filesTableView, SIGNAL(activated(QModelIndex)),
+            SLOT(showSourceFile(QModelIndex)));
+    connect(ui->filesTableView, SIGNAL(clicked(QModelIndex)), SLOT(showSourceFile(QModelIndex)));
+    connect(ui->filterLineEdit, SIGNAL(textChanged(QString)),
+            m_filesProxyModel, SLOT(setFilterFixedString(QString)));
+    connect(ui->nextUncoveredPushButton, SIGNAL(clicked()), SLOT(showNextUncoveredLine()));
+    connect(ui->reportPushButton, SIGNAL(clicked()), SLOT(requestReport()));
+
+    QSettings settings;
+    ui->splitter->restoreState(settings.value("CoverageViewDialog/splitter").toByteArray());
+}
+
+CoverageViewDialog::~CoverageViewDialog()
+{
+    delete ui;
+}
+
+void CoverageViewDialog::storeGeometry()
+{
+    QSettings settings;
+    settings.setValue("CoverageViewDialog/size", size());
+    settings.setValue("CoverageViewDialog/pos", pos());
+    settings.setValue("CoverageViewDialog/splitter", ui->splitter->saveState());
+    settings.sync();
+}
+
+QStandardItem* CoverageViewDialog::createItem(const QString &text, const QVariant &sortValue)
+{
+    QStandardItem *item = new QStandardItem(text);
+    item->setEditable(false);
+    item->setData(sortValue, sortRole);
+    return item;
+}
+
+QStandardItem* CoverageViewDialog::createRateItem(qint64 found, qint64 hit)
+{
+    if (found <= 0)
+    {
+        // files without functions or branches sort below all measured ones
+        return createItem("n/a", -1.0);
+    }
+    double rate = 100.0 * hit / found;
+    QStandardItem *item = createItem(QString("%1 %").arg(rate, 0, 'f', 1), rate);
+    item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    if (rate < lowRate)
+    {
+        item->setBackground(QColor::fromRgb(240, 130, 130, 230));
+    }
+    return item;
+}
+
+bool CoverageViewDialog::initializeForTracefile(const QString &infoPath, const QString &lcovPath)
+{
+    m_filesModel->clear();
+    m_filesModel->setHorizontalHeaderLabels(QStringList() << "Source file" << "Lines"
+                                            << "Lines [%]" << "Functions [%]" << "Branches [%]");
+    m_sourceModel->clear();
+    m_sourceFiles.clear();
+    m_lcovPath = lcovPath;
+    ui->reportPushButton->setEnabled(not lcovPath.isEmpty());
+    ui->descriptionLabel->setText("");
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    LcovInfoParser parser;
+    bool parsed = parser.parse(infoPath);
+    if (parsed)
+    {
+        m_sourceFiles = parser.getFileCoverages();
+    }
+    QApplication::restoreOverrideCursor();
+    if (not parsed)
+    {
+        ui->descriptionLabel->setText(tr("%1 cannot be read.").arg(infoPath));
+        return false;
+    }
+
+    for (int i = 0; i < m_sourceFiles.size(); ++i)
+    {
+        const FileCoverage &sourceFile = m_sourceFiles.at(i);
+        QString path = sourceFile.getPath();
+        qint64 linesFound = sourceFile.getLines().size();
+        qint64 linesHit = sourceFile.getLinesHit();
+        QList<QStandardItem*> rowItems;
+        QStandardItem *fileItem = createItem(path, path.toLower());
+        fileItem->setData(i, sourceFileRole);
+        fileItem->setToolTip(path);
+        QStandardItem *linesItem = createItem(QString("%1 / %2").arg(linesHit).arg(linesFound),
+                                              linesFound - linesHit);
+        linesItem->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        rowItems << fileItem << linesItem
+                 << createRateItem(linesFound, linesHit)
+                 << createRateItem(sourceFile.getFunctionNames().size(),
+                                   sourceFile.getFunctionsHit())
+                 << createRateItem(sourceFile.getBranchesFound(), sourceFile.getBranchesHit());
+        m_filesModel->appendRow(rowItems);
+    }
+
+    Coverage coverage = parser.getCoverage();
+    ui->descriptionLabel->setText(tr("%1: %2 source files, %3 of %4 lines covered")
+                                  .arg(infoPath).arg(m_sourceFiles.size())
+                                  .arg(coverage.getLinesHit()).arg(coverage.getLinesFound()));
+    ui->filesTableView->sortByColumn(LineRateColumn, Qt::AscendingOrder);
+    ui->filesTableView->resizeColumnsToContents();
+    return true;
+}
+
+void CoverageViewDialog::showSourceFile(const QModelIndex &index)
+{
+    QModelIndex fileIndex = m_filesProxyModel->mapToSource(index.sibling(index.row(), FileColumn));
+    QStandardItem *fileItem = m_filesModel->itemFromIndex(fileIndex);
+    if (not fileItem)
+    {
+        return;
+    }
+    int sourceFileIndex = fileItem->data(sourceFileRole).toInt();
+    if (sourceFileIndex < 0 || sourceFileIndex >= m_sourceFiles.size())
+    {
+        return;
+    }
+    const FileCoverage &sourceFile = m_sourceFiles.at(sourceFileIndex);
+    if (not m_sourceModel->setSourceFile(sourceFile))
+    {
+        ui->descriptionLabel->setText(
+                    tr("%1 cannot be read, only its instrumented lines are shown.")
+                    .arg(sourceFile.getPath()));
+    }
+    else
+    {
+        ui->descriptionLabel->setText(sourceFile.getPath());
+    }
+    showNextUncoveredLine();
+}
+
+void CoverageViewDialog::showNextUncoveredLine()
+{
+    QModelIndex current = ui->sourceTableView->currentIndex();
+    int row = m_sourceModel->nextUncoveredRow(current.isValid() ? current.row() : -1);
+    if (row < 0)
+    {
+        return;
+    }
+    QModelIndex index = m_sourceModel->index(row, SourceCoverageModel::SourceColumn);
+    ui->sourceTableView->setCurrentIndex(index);
+    ui->sourceTableView->scrollTo(index, QAbstractItemView::PositionAtCenter);
+}
+
+void CoverageViewDialog::requestReport()
+{
+    if (not m_lcovPath.isEmpty())
+    {
+        emit reportRequested(m_lcovPath);
+    }
+}
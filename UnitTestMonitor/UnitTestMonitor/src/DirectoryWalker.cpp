@@ -0,0 +1,256 @@
+/**
+  * @file DirectoryWalker.cpp
+  *
+  * @class DirectoryWalker
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Lists directories and probes files with few file system calls
+  * @details On Linux the walker lists a directory with getdents64 and takes the file type from
+  *          d_type, so telling directories from files needs no stat. A directory is opened with
+  *          openat relative to its open parent, and files are probed with one fstatat relative
+  *          to their directory, so the path above it is not resolved again. The walker
+  *          counts its system calls and estimates the calls a QDir/QFileInfo walk of the same
+  *          tree would have made. Elsewhere isSupported() is false and callers keep using QDir.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#include "DirectoryWalker.h"
+
+#include <QFile>
+
+#ifdef Q_OS_LINUX
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+#ifdef Q_OS_LINUX
+struct LinuxDirent64
+{
+    quint64 d_ino;
+    qint64 d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[1];
+};
+
+const int direntBufferSize = 32 * 1024;
+#endif
+
+// system calls of a QDir::entryInfoList(): open, fstat, getdents64 until it returns 0, close
+const int qdirListingSyscalls = 5;
+
+} // namespace
+
+DirectoryWalker::DirectoryWalker()
+    : m_syscalls(0),
+      m_estimatedQDirSyscalls(0)
+{
+}
+
+bool DirectoryWalker::isSupported()
+{
+#ifdef Q_OS_LINUX
+    return true;
+#else
+    return false;
+#endif
+}
+
+qint64 DirectoryWalker::getSyscalls() const
+{
+    return m_syscalls;
+}
+
+qint64 DirectoryWalker::getEstimatedQDirSyscalls() const
+{
+    return m_estimatedQDirSyscalls;
+}
+
+qint64 DirectoryWalker::getSavedSyscalls() const
+{
+    return m_estimatedQDirSyscalls - m_syscalls;
+}
+
+int DirectoryWalker::openDirectory(const QString &path)
+{
+#ifdef Q_OS_LINUX
+    return openAt(AT_FDCWD, QFile::encodeName(path));
+#else
+    Q_UNUSED(path);
+    return -1;
+#endif
+}
+
+int DirectoryWalker::openDirectory(int directoryFd, const QString &name)
+{
+    if (directoryFd < 0)
+    {
+        return -1;
+    }
+    return openAt(directoryFd, QFile::encodeName(name));
+}
+
+bool DirectoryWalker::listDirectories(const QString &path, QStringList &names)
+{
+    int directoryFd = openDirectory(path);
+    if (directoryFd < 0)
+    {
+        return false;
+    }
+    QStringList files;
+    bool result = listEntries(directoryFd, names, files);
+    closeDirectory(directoryFd);
+    return result;
+}
+
+bool DirectoryWalker::listEntries(int directoryFd, QStringList &directories, QStringList &files)
+{
+#ifdef Q_OS_LINUX
+    m_estimatedQDirSyscalls += qdirListingSyscalls;
+    if (directoryFd < 0)
+    {
+        return false;
+    }
+    QList<QByteArray> directoryEntries, fileEntries;
+    bool result = readEntries(directoryFd, directoryEntries, &fileEntries);
+    foreach (const QByteArray &entry, directoryEntries)
+    {
+        directories.append(QFile::decodeName(entry));
+    }
+    foreach (const QByteArray &entry, fileEntries)
+    {
+        files.append(QFile::decodeName(entry));
+    }
+    return result;
+#else
+    Q_UNUSED(directoryFd);
+    Q_UNUSED(directories);
+    Q_UNUSED(files);
+    return false;
+#endif
+}
+
+bool DirectoryWalker::statFile(int directoryFd, const QString &name, qint64 &modified,
+                               qint64 &size)
+{
+    // QFileInfo::exists() followed by the size and time getters
+    ++m_estimatedQDirSyscalls;
+    return statAt(directoryFd, QFile::encodeName(name), modified, size);
+}
+
+int DirectoryWalker::openAt(int directoryFd, const QByteArray &path)
+{
+#ifdef Q_OS_LINUX
+    ++m_syscalls;
+    return ::openat(directoryFd, path.constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+#else
+    Q_UNUSED(directoryFd);
+    Q_UNUSED(path);
+    return -1;
+#endif
+}
+
+void DirectoryWalker::closeDirectory(int directoryFd)
+{
+#ifdef Q_OS_LINUX
+    if (directoryFd < 0)
+    {
+        return;
+    }
+    ++m_syscalls;
+    ::close(directoryFd);
+#else
+    Q_UNUSED(directoryFd);
+#endif
+}
+
+bool DirectoryWalker::readEntries(int directoryFd, QList<QByteArray> &directories,
+                                  QList<QByteArray> *files)
+{
+#ifdef Q_OS_LINUX
+    QByteArray buffer(direntBufferSize, Qt::Uninitialized);
+    while (true)
+    {
+        ++m_syscalls;
+        long bytes = ::syscall(SYS_getdents64, directoryFd, buffer.data(), buffer.size());
+        if (bytes < 0)
+        {
+            return false;
+        }
+        if (bytes == 0)
+        {
+            return true;
+        }
+        for (long offset = 0; offset < bytes;)
+        {
+            const LinuxDirent64 *entry =
+                    reinterpret_cast<const LinuxDirent64*>(buffer.constData() + offset);
+            offset += entry->d_reclen;
+            const char *name = entry->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))
+            {
+                continue;
+            }
+            bool isDirectory = entry->d_type == DT_DIR;
+            bool isFile = entry->d_type == DT_REG;
+            if (entry->d_type == DT_UNKNOWN || entry->d_type == DT_LNK)
+            {
+                // file systems without d_type and symbolic links need a stat, like QDir::Dirs
+                struct stat status;
+                ++m_syscalls;
+                bool exists = ::fstatat(directoryFd, name, &status, 0) == 0;
+                isDirectory = exists && S_ISDIR(status.st_mode);
+                isFile = exists && S_ISREG(status.st_mode);
+            }
+            if (isDirectory)
+            {
+                directories.append(QByteArray(name));
+            }
+            else if (isFile && files)
+            {
+                files->append(QByteArray(name));
+            }
+        }
+    }
+#else
+    Q_UNUSED(directoryFd);
+    Q_UNUSED(directories);
+    Q_UNUSED(files);
+    return false;
+#endif
+}
+
+bool DirectoryWalker::statAt(int directoryFd, const QByteArray &path,
+                             qint64 &modified, qint64 &size)
+{
+#ifdef Q_OS_LINUX
+    if (directoryFd < 0)
+    {
+        return false;
+    }
+    struct stat status;
+    ++m_syscalls;
+    if (::fstatat(directoryFd, path.constData(), &status, 0) != 0 || not S_ISREG(status.st_mode))
+    {
+        return false;
+    }
+    // milliseconds like QFileInfo::lastModified(), so fingerprints of both walks compare equal
+    modified = static_cast<qint64>(status.st_mtim.tv_sec) * 1000 + status.st_mtim.tv_nsec / 1000000;
+    size = status.st_size;
+    return true;
+#else
+    Q_UNUSED(directoryFd);
+    Q_UNUSED(path);
+    Q_UNUSED(modified);
+    Q_UNUSED(size);
+    return false;
+#endif
+}
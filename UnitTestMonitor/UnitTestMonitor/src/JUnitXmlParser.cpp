@@ -0,0 +1,276 @@
+/**
+  * @file JUnitXmlParser.cpp
+  *
+  * @class JUnitXmlParser
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Parses JUnit xml reports into the model
+  * @details The JUnit xml parser streams reports written by GoogleTest or ctest through a
+  *          QXmlStreamReader reading directly from the file. Every testsuite becomes a testcase
+  *          and every testcase element becomes a test function result with its time and failure
+  *          message. Test output captured in system-out or system-err is skipped.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#include "JUnitXmlParser.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QXmlStreamReader>
+
+#include <Model/Testrun.h>
+
+using Model::Library;
+using Model::Testcase;
+using Model::Testrun;
+using Model::Testfunction;
+
+namespace
+{
+
+// failure texts may contain whole stack traces, only the beginning is kept
+const int maximumMessageLength = 4096;
+
+// the fail log of a testsuite keeps its first failures, the others are only counted
+const int maximumLoggedFailures = 100;
+
+} // namespace
+
+JUnitXmlParser::JUnitXmlParser()
+    : m_timestamp(0),
+      m_bytesParsed(0),
+      m_testsuiteStartLine(0),
+      m_passed(0),
+      m_failed(0),
+      m_skipped(0),
+      m_testsuiteDuration(-1.0),
+      m_inTestcase(false),
+      m_testcaseLine(0),
+      m_testcaseDuration(-1.0),
+      m_inMessage(false)
+{
+}
+
+bool JUnitXmlParser::isJUnitXml(const QString &reportFilePath)
+{
+    QFile reportFile(reportFilePath);
+    if (not reportFile.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+    return isJUnitXmlHead(reportFile.read(1024));
+}
+
+bool JUnitXmlParser::isJUnitXmlHead(const QByteArray &head)
+{
+    // only the first 1024 bytes of a report are looked at
+    QByteArray start = head.left(1024);
+    return start.contains("<testsuites") || start.contains("<testsuite ");
+}
+
+qint64 JUnitXmlParser::getBytesParsed() const
+{
+    return m_bytesParsed;
+}
+
+bool JUnitXmlParser::parse(const QString &reportFilePath,
+                           const QSharedPointer<Library> &library,
+                           qint64 timestamp)
+{
+    QFileInfo reportFileInfo(reportFilePath);
+    if (library.isNull() || not reportFileInfo.exists())
+    {
+        return false;
+    }
+
+    QFile reportFile(reportFilePath);
+    if (not reportFile.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    m_reportFilePath = reportFilePath;
+    m_library = library;
+    m_timestamp = timestamp;
+    m_testcase.clear();
+    m_inTestcase = false;
+    m_inMessage = false;
+
+    // the reader pulls the file in small blocks, no document is built
+    QXmlStreamReader reader(&reportFile);
+    while (not reader.atEnd())
+    {
+        reader.readNext();
+        if (reader.isStartElement())
+        {
+            handleStartElement(reader);
+        }
+        else if (reader.isEndElement())
+        {
+            handleEndElement(reader);
+        }
+        else if (reader.isCharacters() && m_inMessage
+                 && m_message.size() < maximumMessageLength)
+        {
+            m_message.append(reader.text().left(maximumMessageLength - m_message.size()));
+        }
+    }
+    m_bytesParsed = reportFile.pos();
+    m_library.clear();
+    return not reader.hasError();
+}
+
+void JUnitXmlParser::handleStartElement(QXmlStreamReader &reader)
+{
+    QXmlStreamAttributes attributes = reader.attributes();
+    QStringRef name = reader.name();
+
+    if (name == "testsuite")
+    {
+        QString testsuiteName = attributes.value("name").toString();
+        m_testsuiteStartLine = static_cast<int>(reader.lineNumber()) - 1;
+        m_passed = 0;
+        m_failed = 0;
+        m_skipped = 0;
+        m_testsuiteDuration = -1.0;
+        if (attributes.hasAttribute("time"))
+        {
+            m_testsuiteDuration = attributes.value("time").toString().toDouble() * 1000.0;
+        }
+        m_testfunctions.clear();
+        m_failLog.clear();
+
+        m_testcase = m_library->getTestcase(testsuiteName);
+        if (m_testcase.isNull())
+        {
+            m_testcase = QSharedPointer<Testcase>(new Testcase());
+            m_testcase->withName(testsuiteName);
+            m_library->addTestcase(m_testcase);
+        }
+    }
+    else if (name == "testcase" && not m_testcase.isNull())
+    {
+        m_inTestcase = true;
+        m_testcaseName = attributes.value("name").toString();
+        m_testcaseFile = attributes.value("file").toString();
+        m_testcaseLine = attributes.value("line").toString().toInt();
+        m_testcaseDuration = -1.0;
+        if (attributes.hasAttribute("time"))
+        {
+            m_testcaseDuration = attributes.value("time").toString().toDouble() * 1000.0;
+        }
+        m_incident = "pass";
+        m_message.clear();
+        // GoogleTest marks disabled tests, ctest marks tests that were not run
+        QStringRef status = attributes.value("status");
+        QStringRef result = attributes.value("result");
+        if (status == "notrun" || status == "disabled" || result == "skipped"
+                || result == "suppressed")
+        {
+            m_incident = "skip";
+        }
+        else if (status == "fail")
+        {
+            m_incident = "fail";
+        }
+    }
+    else if (m_inTestcase && (name == "failure" || name == "error"))
+    {
+        m_incident = "fail";
+        m_inMessage = true;
+        if (not m_message.isEmpty())
+        {
+            m_message.append("\n");
+        }
+        m_message.append(attributes.value("message").toString().left(maximumMessageLength));
+        m_message.append("\n");
+    }
+    else if (m_inTestcase && name == "skipped")
+    {
+        m_incident = "skip";
+    }
+}
+
+void JUnitXmlParser::handleEndElement(QXmlStreamReader &reader)
+{
+    QStringRef name = reader.name();
+    if (name == "failure" || name == "error")
+    {
+        m_inMessage = false;
+    }
+    else if (name == "testcase" && m_inTestcase)
+    {
+        recordTestcase();
+        m_inTestcase = false;
+    }
+    else if (name == "testsuite" && not m_testcase.isNull())
+    {
+        endTestsuite(static_cast<int>(reader.lineNumber()) - 1);
+    }
+}
+
+void JUnitXmlParser::recordTestcase()
+{
+    if (m_incident == "pass")
+    {
+        ++m_passed;
+    }
+    else if (m_incident == "fail")
+    {
+        ++m_failed;
+        if (m_failed <= maximumLoggedFailures)
+        {
+            m_failLog << QString("FAIL!  : %1::%2() %3")
+                         .arg(m_testcase->getName()).arg(m_testcaseName).arg(m_message.trimmed());
+            if (not m_testcaseFile.isEmpty())
+            {
+                m_failLog << QString("   Loc: [%1(%2)]").arg(m_testcaseFile).arg(m_testcaseLine);
+            }
+        }
+    }
+    else
+    {
+        ++m_skipped;
+    }
+
+    Testfunction testfunction;
+    testfunction.withName(m_testcaseName).withIncident(m_incident)
+            .withLocation(m_testcaseFile, m_testcaseLine)
+            .withDuration(m_testcaseDuration);
+    m_testfunctions.append(testfunction);
+    m_message.clear();
+}
+
+void JUnitXmlParser::endTestsuite(int endLine)
+{
+    m_testcase->withTlogPath(m_reportFilePath, m_testsuiteStartLine, endLine);
+    if (m_testcase->getTestrun(m_timestamp).isNull())
+    {
+        QString failLogAsString("");
+        if (m_failed > maximumLoggedFailures)
+        {
+            m_failLog << QString("... and %1 more failures")
+                         .arg(m_failed - maximumLoggedFailures);
+        }
+        if (m_failed > 0)
+        {
+            failLogAsString = m_failLog.join("\n");
+        }
+
+        QSharedPointer<Testrun> testrun(new Testrun());
+        testrun->withFailLog(failLogAsString)
+                .withResults(m_passed, m_failed, m_skipped)
+                .withDuration(m_testsuiteDuration)
+                .withTimestamp(m_timestamp);
+        foreach (const Testfunction &testfunction, m_testfunctions)
+        {
+            m_testcase->recordTestfunction(testrun, testfunction);
+        }
+        m_testcase->addTestrun(testrun);
+    }
+    m_testcase.clear();
+    m_testfunctions.clear();
+    m_failLog.clear();
+}
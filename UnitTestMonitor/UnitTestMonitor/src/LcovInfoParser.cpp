@@ -0,0 +1,324 @@
+/**
+  * @file LcovInfoParser.cpp
+  *
+  * @class LcovInfoParser
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Sums up the coverage of an lcov tracefile
+  * @details The parser memory maps a .info tracefile and walks its records line by line without
+  *          decoding them into strings. DA, FN, FNDA, and BRDA records are counted per source
+  *          file, so a source file listed by several sections, as headers are in tracefiles of
+  *          several test binaries, counts once with the union of its hits. A section without DA
+  *          records contributes its LF and LH summary instead. If a tracefile cannot be mapped it
+  *          is read into memory and parsed the same way. The execution counts of every source file
+  *          are handed out as FileCoverages, for viewers and comparisons.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#include "LcovInfoParser.h"
+
+#include <QFile>
+#include <QMap>
+#include <QtAlgorithms>
+#include <cstring>
+
+using Model::Coverage;
+using Model::FileCoverage;
+
+namespace
+{
+
+bool hasPrefix(const char *begin, const char *end, const char *prefix, int length)
+{
+    return end - begin >= length && std::memcmp(begin, prefix, length) == 0;
+}
+
+// reads a decimal number and moves begin behind it, -1 if there is none
+qint64 readNumber(const char *&begin, const char *end)
+{
+    const char *digits = begin;
+    bool negative = begin < end && *begin == '-';
+    if (negative)
+    {
+        ++begin;
+    }
+    qint64 result = 0;
+    const char *first = begin;
+    while (begin < end && *begin >= '0' && *begin <= '9')
+    {
+        result = result * 10 + (*begin - '0');
+        ++begin;
+    }
+    if (begin == first)
+    {
+        begin = digits;
+        return -1;
+    }
+    return negative ? -result : result;
+}
+
+// moves begin behind the next comma, returns false if there is none
+bool skipComma(const char *&begin, const char *end)
+{
+    const char *comma = static_cast<const char*>(std::memchr(begin, ',', end - begin));
+    if (not comma)
+    {
+        return false;
+    }
+    begin = comma + 1;
+    return true;
+}
+
+} // namespace
+
+LcovInfoParser::LcovInfoParser()
+    : m_source(0),
+      m_sectionHasLines(false),
+      m_sectionLinesFound(-1),
+      m_sectionLinesHit(-1),
+      m_summaryLinesFound(0),
+      m_summaryLinesHit(0)
+{
+}
+
+void LcovInfoParser::reset()
+{
+    m_sources.clear();
+    m_source = 0;
+    m_sectionHasLines = false;
+    m_sectionLinesFound = -1;
+    m_sectionLinesHit = -1;
+    m_summaryLinesFound = 0;
+    m_summaryLinesHit = 0;
+}
+
+bool LcovInfoParser::parse(const QString &infoFilePath)
+{
+    QFile infoFile(infoFilePath);
+    if (not infoFile.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    qint64 size = infoFile.size();
+    const uchar *data = size > 0 ? infoFile.map(0, size) : 0;
+    if (not data)
+    {
+        QByteArray content = infoFile.readAll();
+        parseData(content.constData(), content.size());
+        return true;
+    }
+
+    parseData(reinterpret_cast<const char*>(data), size);
+    infoFile.unmap(const_cast<uchar*>(data));
+    return true;
+}
+
+void LcovInfoParser::parseData(const char *data, qint64 size)
+{
+    reset();
+    const char *end = data + size;
+    const char *begin = data;
+    while (begin < end)
+    {
+        const char *lineEnd = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+        if (not lineEnd)
+        {
+            lineEnd = end;
+        }
+        const char *recordEnd = lineEnd;
+        if (recordEnd > begin && recordEnd[-1] == '\r')
+        {
+            --recordEnd;
+        }
+        handleRecord(begin, recordEnd);
+        begin = lineEnd + 1;
+    }
+    closeSection();
+}
+
+void LcovInfoParser::handleRecord(const char *begin, const char *end)
+{
+    if (hasPrefix(begin, end, "SF:", 3))
+    {
+        closeSection();
+        m_source = &m_sources[QByteArray(begin + 3, end - begin - 3)];
+        return;
+    }
+    if (hasPrefix(begin, end, "end_of_record", 13))
+    {
+        closeSection();
+        return;
+    }
+    if (not m_source)
+    {
+        // TN: and whatever precedes the first source file
+        return;
+    }
+
+    if (hasPrefix(begin, end, "DA:", 3))
+    {
+        // DA:<line>,<count>[,<checksum>]
+        begin += 3;
+        qint64 line = readNumber(begin, end);
+        qint64 count = skipComma(begin, end) ? readNumber(begin, end) : -1;
+        if (line >= 0)
+        {
+            m_source->lines[line] += qMax(Q_INT64_C(0), count);
+            m_sectionHasLines = true;
+        }
+    }
+    else if (hasPrefix(begin, end, "FNDA:", 5))
+    {
+        // FNDA:<count>,<name>
+        begin += 5;
+        qint64 count = readNumber(begin, end);
+        if (skipComma(begin, end))
+        {
+            m_source->functions[QByteArray(begin, end - begin)] += qMax(Q_INT64_C(0), count);
+        }
+    }
+    else if (hasPrefix(begin, end, "FN:", 3))
+    {
+        // FN:<line>,<name> or FN:<line>,<end line>,<name> since lcov 2
+        begin += 3;
+        readNumber(begin, end);
+        if (not skipComma(begin, end))
+        {
+            return;
+        }
+        const char *name = begin;
+        if (readNumber(begin, end) >= 0 && begin < end && *begin == ',')
+        {
+            name = begin + 1;
+        }
+        QByteArray function(name, end - name);
+        if (not m_source->functions.contains(function))
+        {
+            m_source->functions.insert(function, 0);
+        }
+    }
+    else if (hasPrefix(begin, end, "BRDA:", 5))
+    {
+        // BRDA:<line>,<block>,<branch>,<taken>, where taken is - if the block never ran
+        begin += 5;
+        const char *taken = end;
+        while (taken > begin && taken[-1] != ',')
+        {
+            --taken;
+        }
+        if (taken == begin)
+        {
+            return;
+        }
+        const char *count = taken;
+        bool &hit = m_source->branches[QByteArray(begin, taken - 1 - begin)];
+        hit = hit || readNumber(count, end) > 0;
+    }
+    else if (hasPrefix(begin, end, "LF:", 3))
+    {
+        begin += 3;
+        m_sectionLinesFound = readNumber(begin, end);
+    }
+    else if (hasPrefix(begin, end, "LH:", 3))
+    {
+        begin += 3;
+        m_sectionLinesHit = readNumber(begin, end);
+    }
+}
+
+void LcovInfoParser::closeSection()
+{
+    if (m_source && not m_sectionHasLines && m_sectionLinesFound > 0)
+    {
+        m_summaryLinesFound += m_sectionLinesFound;
+        m_summaryLinesHit += qMax(Q_INT64_C(0), m_sectionLinesHit);
+    }
+    m_source = 0;
+    m_sectionHasLines = false;
+    m_sectionLinesFound = -1;
+    m_sectionLinesHit = -1;
+}
+
+Coverage LcovInfoParser::getCoverage() const
+{
+    qint64 linesFound = m_summaryLinesFound, linesHit = m_summaryLinesHit;
+    qint64 functionsFound = 0, functionsHit = 0;
+    qint64 branchesFound = 0, branchesHit = 0;
+    QHash<QByteArray, SourceCoverage>::const_iterator it = m_sources.constBegin();
+    for (; it != m_sources.constEnd(); ++it)
+    {
+        linesFound += it->lines.size();
+        foreach (qint64 count, it->lines)
+        {
+            linesHit += count > 0 ? 1 : 0;
+        }
+        functionsFound += it->functions.size();
+        foreach (qint64 count, it->functions)
+        {
+            functionsHit += count > 0 ? 1 : 0;
+        }
+        branchesFound += it->branches.size();
+        foreach (bool hit, it->branches)
+        {
+            branchesHit += hit ? 1 : 0;
+        }
+    }
+    Coverage result;
+    result.withLines(linesFound, linesHit)
+            .withFunctions(functionsFound, functionsHit)
+            .withBranches(branchesFound, branchesHit);
+    return result;
+}
+
+int LcovInfoParser::getSourceFilesCount() const
+{
+    return m_sources.size();
+}
+
+QList<FileCoverage> LcovInfoParser::getFileCoverages() const
+{
+    // ordered by path, so two lists can be walked side by side
+    QMap<QString, FileCoverage> fileCoverages;
+    QHash<QByteArray, SourceCoverage>::const_iterator it = m_sources.constBegin();
+    for (; it != m_sources.constEnd(); ++it)
+    {
+        QList<qint64> lineNumbers = it->lines.keys();
+        qSort(lineNumbers);
+        QVector<qint64> lines, lineHits;
+        lines.reserve(lineNumbers.size());
+        lineHits.reserve(lineNumbers.size());
+        foreach (qint64 line, lineNumbers)
+        {
+            lines.append(line);
+            lineHits.append(it->lines.value(line));
+        }
+
+        QList<QByteArray> functionKeys = it->functions.keys();
+        qSort(functionKeys);
+        QStringList functionNames;
+        QVector<qint64> functionHits;
+        functionHits.reserve(functionKeys.size());
+        foreach (const QByteArray &function, functionKeys)
+        {
+            functionNames.append(QString::fromUtf8(function));
+            functionHits.append(it->functions.value(function));
+        }
+
+        qint64 branchesHit = 0;
+        foreach (bool hit, it->branches)
+        {
+            branchesHit += hit ? 1 : 0;
+        }
+
+        FileCoverage fileCoverage;
+        fileCoverage.withPath(QString::fromUtf8(it.key()))
+                .withLines(lines, lineHits)
+                .withFunctions(functionNames, functionHits)
+                .withBranches(it->branches.size(), branchesHit);
+        fileCoverages.insert(fileCoverage.getPath(), fileCoverage);
+    }
+    return fileCoverages.values();
+}
@@ -0,0 +1,243 @@
+/**
+  * @file LcovSummaryParser.cpp
+  *
+  * @class LcovSummaryParser
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Reads the headline numbers of a genhtml report without rendering it
+  * @details The parser reads the index.html of a genhtml report in small chunks and only looks at
+  *          its table cells, until the ruler below the header or a limit of bytes is reached. It
+  *          takes the hit and total counts of the Lines, Functions, and Branches rows and the
+  *          value of the Date row. genhtml before and since lcov 2 order the counts differently,
+  *          so the smaller count of a row is taken as hit. The rate cells are skipped, the rates
+  *          are computed from the counts.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#include "LcovSummaryParser.h"
+
+#include <QFile>
+
+using Model::Coverage;
+
+namespace
+{
+
+// the header of a genhtml report fits easily, a file list is never read
+const qint64 readChunkSize = 16 * 1024;
+const qint64 maxHeaderSize = 256 * 1024;
+
+// cells of a row label: the three cells right of it hold hit, total, and rate
+const int countCellsPerRow = 3;
+
+QByteArray cellText(const QByteArray &content)
+{
+    // drops nested tags and entities, genhtml header cells hold plain numbers and dates
+    QByteArray result;
+    bool inTag = false;
+    for (int i = 0; i < content.size(); ++i)
+    {
+        char character = content.at(i);
+        if (character == '<' || character == '>')
+        {
+            inTag = character == '<';
+            continue;
+        }
+        if (inTag)
+        {
+            continue;
+        }
+        if (character == '&')
+        {
+            int end = content.indexOf(';', i);
+            if (end > i)
+            {
+                result.append(' ');
+                i = end;
+                continue;
+            }
+        }
+        result.append(character);
+    }
+    return result.trimmed();
+}
+
+} // namespace
+
+LcovSummaryParser::LcovSummaryParser()
+    : m_label(NoLabel),
+      m_cells(0),
+      m_complete(false)
+{
+}
+
+void LcovSummaryParser::reset()
+{
+    m_label = NoLabel;
+    m_counts.clear();
+    m_cells = 0;
+    m_complete = false;
+    m_coverage = Coverage();
+    m_date.clear();
+}
+
+bool LcovSummaryParser::parse(const QString &reportFilePath)
+{
+    reset();
+    QFile reportFile(reportFilePath);
+    if (not reportFile.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    QByteArray buffer;
+    qint64 read = 0;
+    while (not m_complete && read < maxHeaderSize)
+    {
+        QByteArray chunk = reportFile.read(readChunkSize);
+        if (chunk.isEmpty())
+        {
+            break;
+        }
+        read += chunk.size();
+        buffer.append(chunk);
+        buffer.remove(0, parseData(buffer));
+    }
+    closeLabel();
+    return m_coverage.getLinesFound() > 0;
+}
+
+int LcovSummaryParser::parseData(const QByteArray &data)
+{
+    // returns the bytes of complete cells, an incomplete cell is left for the next chunk
+    int position = 0;
+    while (not m_complete)
+    {
+        int cellBegin = data.indexOf("<td", position);
+        if (cellBegin < 0)
+        {
+            // keep a tail that may start a cell
+            return qMax(position, data.size() - 2);
+        }
+        int tagEnd = data.indexOf('>', cellBegin);
+        int cellEnd = tagEnd < 0 ? -1 : data.indexOf("</td>", tagEnd);
+        if (cellEnd < 0)
+        {
+            return cellBegin;
+        }
+
+        QByteArray tag = data.mid(cellBegin, tagEnd - cellBegin);
+        QByteArray cssClass;
+        int classBegin = tag.indexOf("class=\"");
+        if (classBegin >= 0)
+        {
+            classBegin += 7;
+            cssClass = tag.mid(classBegin, tag.indexOf('"', classBegin) - classBegin);
+        }
+        handleCell(cssClass, cellText(data.mid(tagEnd + 1, cellEnd - tagEnd - 1)));
+        position = cellEnd + 5;
+    }
+    return position;
+}
+
+void LcovSummaryParser::handleCell(const QByteArray &cssClass, const QByteArray &text)
+{
+    if (cssClass == "ruler")
+    {
+        // the header ends here, the file list follows
+        closeLabel();
+        m_complete = true;
+        return;
+    }
+    if (cssClass == "headerItem")
+    {
+        closeLabel();
+        if (text == "Lines:")
+        {
+            m_label = LinesLabel;
+        }
+        else if (text == "Functions:")
+        {
+            m_label = FunctionsLabel;
+        }
+        else if (text == "Branches:")
+        {
+            m_label = BranchesLabel;
+        }
+        else if (text == "Date:")
+        {
+            m_label = DateLabel;
+        }
+        return;
+    }
+    if (m_label == DateLabel)
+    {
+        if (cssClass.startsWith("headerValue"))
+        {
+            m_date = QString::fromUtf8(text);
+            m_label = NoLabel;
+        }
+        return;
+    }
+    if (m_label == NoLabel || not cssClass.startsWith("headerCovTableEntry"))
+    {
+        return;
+    }
+    ++m_cells;
+    if (not text.contains('%'))
+    {
+        bool ok = false;
+        qint64 count = text.toLongLong(&ok);
+        if (ok)
+        {
+            m_counts.append(count);
+        }
+    }
+    if (m_cells == countCellsPerRow)
+    {
+        closeLabel();
+    }
+}
+
+void LcovSummaryParser::closeLabel()
+{
+    if (m_counts.size() == 2)
+    {
+        qint64 hit = qMin(m_counts.at(0), m_counts.at(1));
+        qint64 found = qMax(m_counts.at(0), m_counts.at(1));
+        if (m_label == LinesLabel)
+        {
+            m_coverage.withLines(found, hit);
+        }
+        else if (m_label == FunctionsLabel)
+        {
+            m_coverage.withFunctions(found, hit);
+        }
+        else if (m_label == BranchesLabel)
+        {
+            m_coverage.withBranches(found, hit);
+        }
+    }
+    m_label = NoLabel;
+    m_counts.clear();
+    m_cells = 0;
+}
+
+bool LcovSummaryParser::isComplete() const
+{
+    return m_complete;
+}
+
+Coverage LcovSummaryParser::getCoverage() const
+{
+    Coverage result = m_coverage;
+    result.withReportDate(m_date);
+    return result;
+}
+
+QString LcovSummaryParser::getDate() const
+{
+    return m_date;
+}
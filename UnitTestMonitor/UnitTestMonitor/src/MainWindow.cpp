@@ -16,6 +16,7 @@
 
 #include <QtCore>
 #include <QFileDialog>
+#include <QInputDialog>
 #include <QMessageBox>
 #include <QIcon>
 #include <QMenu>
@@ -24,6 +25,7 @@
 #include <QFutureWatcher>
 #include <QLayoutItem>
 #include <QPushButton>
+#include <QProgressBar>
 #include <QtConcurrent>
 
 #include <Model/MonitorSet.h>
@@ -32,29 +34,73 @@
 #include "Model/Library.h"
 #include "Model/Testcase.h"
 #include "Model/Testrun.h"
+#include "Model/Testfunction.h"
 #include <MonitorSetReader.h>
 #include <MonitorSetWriter.h>
 #include <AboutDialog.h>
 #include <TlogViewDialog.h>
+#include <SlowTestsDialog.h>
+#ifdef UTM_WITH_WEBKIT
 #include <LcovBrowserDialog.h>
+#endif
+#include <CoverageViewDialog.h>
+#include <CoverageDeltaDialog.h>
+#include <CoverageDelta.h>
+#include <BranchLayoutMatcher.h>
 
 using Model::MonitorSet;
 using Model::Branch;
+using Model::BranchLayout;
 using Model::Project;
 using Model::Library;
 using Model::Testcase;
 using Model::Testrun;
+using Model::Testfunction;
+using Model::Coverage;
+using Model::FileCoverage;
+
+namespace
+{
+
+// tells the rows of the branch tree apart, function rows may have no children just like testcases
+const int itemKindRole = Qt::UserRole + 4;
+
+// minimum time between two rebuilds of the tree while a scan publishes libraries
+const int scanPreviewInterval = 500;
+
+enum ItemKind
+{
+    ProjectItem = 1,
+    LibraryItem,
+    TestcaseItem,
+    TestfunctionItem,
+    CoverageItem
+};
+
+} // namespace
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
     ui(new Ui::MainWindow),
     m_branchTableModel(),
+    m_scanProgress(new ScanProgress()),
+    m_scanProgressBar(0),
+    m_cancelScanButton(0),
+    m_shownPublications(0),
+    m_backgroundScan(false),
+    m_scanRunning(false),
     m_ioBlocked(0),
     m_selectedLibrary(0),
     m_selectedTestcase(0),
     m_selectedTestrun(-1),
+    m_comparedTestrun(-1),
     tlogViewDialog(0),
-    lcovBrowserDialog(0)
+    slowTestsDialog(0),
+    lcovBrowserDialog(0),
+    coverageViewDialog(0),
+    coverageDeltaDialog(0),
+    m_runGroupWindow(0),
+    m_backgroundBytesPerSecond(0)
 {
     ui->setupUi(this);
     m_recentFilesMenu = new QMenu("&Recent Files");
@@ -67,6 +113,19 @@ MainWindow::MainWindow(QWidget *parent) :
     m_branchTableModel = new QStandardItemModel(ui->branchTestsTreeView);
     ui->branchTestsTreeView->setModel(m_branchTableModel);
 
+    m_scanProgressBar = new QProgressBar(ui->statusBar);
+    m_scanProgressBar->setMinimumWidth(320);
+    m_scanProgressBar->setVisible(false);
+    m_cancelScanButton = new QPushButton(tr("Cancel Scan"), ui->statusBar);
+    m_cancelScanButton->setVisible(false);
+    ui->statusBar->addPermanentWidget(m_scanProgressBar);
+    ui->statusBar->addPermanentWidget(m_cancelScanButton);
+    connect(m_cancelScanButton, SIGNAL(clicked()), SLOT(cancelScan()));
+
+    QMenu *branchToolsMenu = new QMenu(ui->branchTabsToolsMenu);
+    branchToolsMenu->addAction(tr("Edit Branch Layout..."), this, SLOT(editBranchLayout()));
+    ui->branchTabsToolsMenu->setMenu(branchToolsMenu);
+
     m_openPollTimer.setInterval(1000);
     m_openPollTimer.setSingleShot(false);
     m_savePollTimer.setInterval(1000);
@@ -80,6 +139,11 @@ MainWindow::MainWindow(QWidget *parent) :
             this, SLOT(handleFinishedSaveMonitorSet()));
     connect(&m_scanPollTimer, SIGNAL(timeout()),
             this, SLOT(handleFinishedScanBranch()));
+    connect(&m_branchWatcher, SIGNAL(librariesChanged()), SLOT(processWatchedBranches()));
+    connect(&m_branchPoller, SIGNAL(librariesChanged(const QString &, const QStringList &)),
+            &m_branchWatcher, SLOT(addPendingLibraries(const QString &, const QStringList &)));
+    connect(&m_branchPollTimer, SIGNAL(timeout()), SLOT(pollBranches()));
+    connect(&m_coverageMergeWatcher, SIGNAL(finished()), SLOT(handleFinishedCoverageMerge()));
     connect(&m_branchTabsSignalMapper, SIGNAL(mapped(const QString &)),
                  this, SLOT(branchTabClicked(const QString &)));
     connect(ui->branchTestsTreeView, SIGNAL(expanded(QModelIndex)), SLOT(adjustColumnSize()));
@@ -108,6 +172,44 @@ MainWindow::MainWindow(QWidget *parent) :
     }
     updateRecentFilesMenu();
 
+    bool parallelScan = settings.value("BranchScanner/parallelScan", true).toBool();
+    int maxThreadCount = settings.value(
+                "BranchScanner/maxThreadCount", QThread::idealThreadCount()).toInt();
+    bool incrementalScan = settings.value("BranchScanner/incrementalScan", true).toBool();
+    bool contentHashing = settings.value("BranchScanner/contentHashing", false).toBool();
+    bool nativeWalk = settings.value("BranchScanner/nativeWalk", true).toBool();
+    bool batchedReads = settings.value("BranchScanner/batchedReads", false).toBool();
+    bool tailIngestion = settings.value("BranchScanner/tailIngestion", true).toBool();
+    // scans triggered by the branch watcher always run in the background, on a build host all
+    // scans may be told to
+    bool backgroundScan = settings.value("BranchScanner/backgroundScan", false).toBool();
+    m_backgroundBytesPerSecond = settings.value(
+                "BranchScanner/backgroundBytesPerSecond", 8 * 1024 * 1024).toLongLong();
+    m_branchScanner.withParallelScan(parallelScan, maxThreadCount)
+            .withIncrementalScan(incrementalScan, contentHashing)
+            .withNativeWalk(nativeWalk)
+            .withBatchedReads(batchedReads)
+            .withTailIngestion(tailIngestion)
+            .withBackgroundScan(backgroundScan, m_backgroundBytesPerSecond)
+            .withProgress(m_scanProgress);
+    m_branchWatcher.setDebounceInterval(
+                settings.value("BranchWatcher/debounceInterval", 2000).toInt());
+    // file systems like NFS send no notifications of other hosts' writes, so every branch is
+    // also probed on an interval adapted to how often its tlogs change
+    m_branchPoller.withIntervals(settings.value("BranchPoller/minInterval", 30).toInt(),
+                                 settings.value("BranchPoller/maxInterval", 1800).toInt());
+    if (settings.value("BranchPoller/enabled", true).toBool())
+    {
+        m_branchPollTimer.setInterval(5000);
+        m_branchPollTimer.setSingleShot(false);
+        m_branchPollTimer.start();
+    }
+    m_benchmarkTrend.withNoiseThreshold(
+                settings.value("BenchmarkTrend/noiseThreshold", 5.0).toDouble())
+            .withWindow(settings.value("BenchmarkTrend/window", 5).toInt());
+    m_runGroupWindow = Q_INT64_C(60000) *
+            settings.value("BranchView/runGroupMinutes", 15).toInt();
+
     if (settings.contains("MainWindow/size"))
     {
         QVariant var = settings.value("MainWindow/size");
@@ -171,9 +273,13 @@ void MainWindow::resetUi()
         ui->addBranchToolButton->setEnabled(false);
         ui->removeBranchToolButton->setEnabled(false);
         ui->updateBranchToolButton->setEnabled(false);
+        ui->watchBranchToolButton->setEnabled(false);
+        ui->watchBranchToolButton->setChecked(false);
 
         ui->viewLcovToolButton->setEnabled(false);
+        ui->compareCoverageToolButton->setEnabled(false);
         ui->viewTlogToolButton->setEnabled(false);
+        ui->slowTestsToolButton->setEnabled(false);
         ui->deleteTestrunToolButton->setEnabled(false);
     }
 }
@@ -190,14 +296,26 @@ MainWindow::~MainWindow()
 
 void MainWindow::updateTools()
 {
+    if (m_ioBlocked != 0)
+    {
+        // the pending I/O operation may change the branches, enableIOActions(true) comes back here
+        enableIOActions(false);
+        return;
+    }
     bool modelHasBranches = hasBranches();
     bool isBranchSelected = not m_selectedBranch.isNull();
     ui->addBranchToolButton->setEnabled(true);
     ui->removeBranchToolButton->setEnabled(modelHasBranches && isBranchSelected);
     ui->updateBranchToolButton->setEnabled(modelHasBranches && isBranchSelected);
+    ui->watchBranchToolButton->setEnabled(modelHasBranches && isBranchSelected);
+    ui->watchBranchToolButton->setChecked(isBranchSelected && m_selectedBranch->isWatched());
+    ui->branchTabsToolsMenu->setVisible(modelHasBranches);
+    ui->branchTabsToolsMenu->setEnabled(modelHasBranches && isBranchSelected);
 
     ui->viewLcovToolButton->setEnabled(isLibrarySelected());
+    ui->compareCoverageToolButton->setEnabled(isBranchSelected && isComparisonSelected());
     ui->viewTlogToolButton->setEnabled(isTestSelected());
+    ui->slowTestsToolButton->setEnabled(modelHasBranches && isBranchSelected);
     ui->deleteTestrunToolButton->setEnabled(isTestrunSelected());
 }
 
@@ -221,6 +339,11 @@ bool MainWindow::isTestrunSelected()
     return m_selectedTestrun >= 0;
 }
 
+bool MainWindow::isComparisonSelected()
+{
+    return isTestrunSelected() && m_comparedTestrun >= 0 && m_comparedTestrun != m_selectedTestrun;
+}
+
 void MainWindow::on_actionNewMonitorSet_triggered()
 {
     if (not m_ioBlocked.testAndSetAcquire(0, 1))
@@ -250,6 +373,7 @@ void MainWindow::on_actionNewMonitorSet_triggered()
         pushRecentMonitorSetFile(m_currentMonitorSetFile);
 
         m_monitorSet = QSharedPointer<MonitorSet>(new MonitorSet());
+        m_branchWatcher.unwatchAll();
 
         MonitorSetWriter writer(fileName);
         QFuture<bool> future = QtConcurrent::run(writer, &MonitorSetWriter::write, m_monitorSet);
@@ -357,14 +481,19 @@ void MainWindow::on_addBranchToolButton_clicked()
     QString branchPath = QFileDialog::getExistingDirectory(
                 this, tr("New Monitor Set"), lastFileDialogPath);
 
-    if (not branchPath.isNull() && not branchPath.isEmpty())
+    // a new branch starts with the layout given to the last one
+    BranchLayout layout = BranchLayout::fromRules(
+                settings.value("BranchLayout/rules", BranchLayout().toRules()).toStringList());
+    if (not branchPath.isNull() && not branchPath.isEmpty() &&
+            askBranchLayout(QFileInfo(branchPath).fileName(), layout))
     {
         lastFileDialogPath = QFileInfo(branchPath).absoluteFilePath();
         settings.setValue("lastBranchDialogPath", lastFileDialogPath);
+        settings.setValue("BranchLayout/rules", layout.toRules());
 
-        BranchScanner scanner;
+        startScanProgress();
         QFuture<QSharedPointer<Branch> > future =
-                QtConcurrent::run(scanner, &BranchScanner::scanBranch, branchPath);
+                QtConcurrent::run(m_branchScanner, &BranchScanner::scanBranch, branchPath, layout);
         watcherScanBranch.setFuture(future);
         m_scanPollTimer.start(10);
     }
@@ -388,6 +517,8 @@ void MainWindow::on_removeBranchToolButton_clicked()
 
     if (not m_selectedBranch.isNull())
     {
+        m_branchWatcher.unwatchBranch(m_selectedBranch->getPath());
+        m_branchPoller.forgetBranch(m_selectedBranch->getPath());
         m_monitorSet->removeBranch(m_selectedBranch);
     }
 
@@ -423,9 +554,171 @@ void MainWindow::on_updateBranchToolButton_clicked()
 
     if (not branch.isNull())
     {
-        BranchScanner scanner;
+        startScanProgress();
+        QFuture<QSharedPointer<Branch> > future =
+                QtConcurrent::run(m_branchScanner, &BranchScanner::updateBranch, branch);
+        watcherScanBranch.setFuture(future);
+        m_scanPollTimer.start(10);
+    }
+    else
+    {
+        m_ioBlocked = 0;
+        enableIOActions(true);
+    }
+}
+
+void MainWindow::editBranchLayout()
+{
+    if (not m_ioBlocked.testAndSetAcquire(0, 1))
+    {
+        ui->statusBar->showMessage(
+                    tr("MainWindow: Failed to edit branch layout as I/O operation is pending."),
+                    5000);
+        return;
+    }
+    enableIOActions(false);
+
+    QSharedPointer<Branch> branch = m_selectedBranch;
+    BranchLayout layout;
+    if (not branch.isNull())
+    {
+        layout = branch->getLayout();
+    }
+    if (not branch.isNull() && askBranchLayout(branch->getName(), layout)
+            && layout != branch->getLayout())
+    {
+        // libraries are found by the new layout, those it no longer matches are kept
+        branch->withLayout(layout);
+        QSettings settings;
+        settings.setValue("BranchLayout/rules", layout.toRules());
+        startScanProgress();
+        QFuture<QSharedPointer<Branch> > future =
+                QtConcurrent::run(m_branchScanner, &BranchScanner::updateBranch, branch);
+        watcherScanBranch.setFuture(future);
+        m_scanPollTimer.start(10);
+    }
+    else
+    {
+        m_ioBlocked = 0;
+        enableIOActions(true);
+    }
+}
+
+bool MainWindow::askBranchLayout(const QString &branchName, BranchLayout &layout)
+{
+    QString rules = layout.toRules().join("\n");
+    while (true)
+    {
+        bool accepted = false;
+        rules = QInputDialog::getMultiLineText(
+                    this, tr("Layout of %1").arg(branchName),
+                    tr("One rule per line, templates are relative to the branch directory:\n"
+                       "tlog <template>, lcov <template>, skip-project <glob>, "
+                       "skip-library <glob>.\n"
+                       "Templates use {project}, {library}, * and ? within a directory name "
+                       "and ** for any number of directories."),
+                    rules, &accepted);
+        if (not accepted)
+        {
+            return false;
+        }
+        QStringList invalidRules;
+        BranchLayout edited = BranchLayout::fromRules(rules.split('\n'), &invalidRules);
+        BranchLayoutMatcher matcher(edited);
+        if (invalidRules.isEmpty() && matcher.isValid())
+        {
+            layout = edited;
+            return true;
+        }
+        QMessageBox::warning(this, tr("Invalid Branch Layout"),
+                             invalidRules.isEmpty()
+                             ? matcher.getError()
+                             : tr("Unknown rule \"%1\".").arg(invalidRules.first()));
+    }
+}
+
+void MainWindow::on_watchBranchToolButton_clicked()
+{
+    if (not m_ioBlocked.testAndSetAcquire(0, 1))
+    {
+        ui->statusBar->showMessage(
+                    tr("MainWindow: Failed to watch branch as I/O operation is pending."),
+                    5000);
+        updateTools();
+        return;
+    }
+    enableIOActions(false);
+
+    QSharedPointer<Branch> branch = m_selectedBranch;
+    if (branch.isNull())
+    {
+        m_ioBlocked = 0;
+        enableIOActions(true);
+        return;
+    }
+
+    bool watched = not branch->isWatched();
+    branch->withWatched(watched);
+    if (watched)
+    {
+        m_branchWatcher.watchBranch(branch);
+    }
+    else
+    {
+        m_branchWatcher.unwatchBranch(branch->getPath());
+    }
+
+    QFileInfo fileInfo(m_currentMonitorSetFile);
+    if (fileInfo.exists() && fileInfo.isFile())
+    {
+        MonitorSetWriter writer(m_currentMonitorSetFile);
+        QFuture<bool> futureSave = QtConcurrent::run(writer, &MonitorSetWriter::write, m_monitorSet);
+        watcherSaveMonitorSet.setFuture(futureSave);
+        m_savePollTimer.start(10);
+    }
+    else
+    {
+        m_ioBlocked = 0;
+        enableIOActions(true);
+    }
+}
+
+void MainWindow::processWatchedBranches()
+{
+    if (not m_branchWatcher.hasPendingLibraries() || m_monitorSet.isNull())
+    {
+        return;
+    }
+    if (not m_ioBlocked.testAndSetAcquire(0, 1))
+    {
+        // retry when the pending I/O operation is finished
+        QTimer::singleShot(1000, this, SLOT(processWatchedBranches()));
+        return;
+    }
+    enableIOActions(false);
+
+    QString branchPath = m_branchWatcher.pendingBranches().first();
+    QStringList libraryKeys = m_branchWatcher.takePendingLibraries(branchPath);
+    QSharedPointer<Branch> branch;
+    foreach (const QSharedPointer<Branch> &candidate, m_monitorSet->getBranches())
+    {
+        if (candidate->getPath() == branchPath)
+        {
+            branch = candidate;
+        }
+    }
+
+    if (not branch.isNull() && not libraryKeys.isEmpty())
+    {
+        ui->statusBar->showMessage(tr("Updating %1 changed libraries of branch %2.")
+                                   .arg(libraryKeys.size()).arg(branch->getName()), 5000);
+        m_backgroundScan = true;
+        startScanProgress();
+        BranchScanner backgroundScanner(m_branchScanner);
+        backgroundScanner.withBackgroundScan(true, m_backgroundBytesPerSecond);
         QFuture<QSharedPointer<Branch> > future =
-                QtConcurrent::run(scanner, &BranchScanner::updateBranch, branch);
+                QtConcurrent::run(backgroundScanner, &BranchScanner::updateLibraries,
+                                  branch, libraryKeys);
         watcherScanBranch.setFuture(future);
         m_scanPollTimer.start(10);
     }
@@ -443,37 +736,196 @@ void MainWindow::on_viewLcovToolButton_clicked()
     {
         return;
     }
-    QVariant lcovPathData = libraryItem->data(Qt::UserRole + 1);
-    if (lcovPathData.isValid())
+    QString lcovPath = libraryItem->data(Qt::UserRole + 1).toString();
+    QString infoPath = libraryItem->data(Qt::UserRole + 2).toString();
+
+    // the native viewer needs the tracefile, the genhtml report is the fallback
+    QSettings settings;
+    bool preferReport = false;
+#ifdef UTM_WITH_WEBKIT
+    preferReport = settings.value("CoverageViewDialog/preferReport", false).toBool();
+#endif
+    if (infoPath.isEmpty() || not QFileInfo(infoPath).isFile() || preferReport)
     {
-        QString lcovPath = lcovPathData.toString();
-        if (not lcovBrowserDialog)
+        showLcovReport(lcovPath);
+        return;
+    }
+
+    if (not coverageViewDialog)
+    {
+        coverageViewDialog = new CoverageViewDialog(this);
+        connect(coverageViewDialog, SIGNAL(reportRequested(QString)),
+                SLOT(showLcovReport(QString)));
+    }
+#ifdef UTM_WITH_WEBKIT
+    coverageViewDialog->initializeForTracefile(infoPath, lcovPath);
+#else
+    coverageViewDialog->initializeForTracefile(infoPath);
+#endif
+    coverageViewDialog->show();
+
+    if (settings.contains("CoverageViewDialog/size"))
+    {
+        QVariant var = settings.value("CoverageViewDialog/size");
+        if (var.canConvert<QSize>())
         {
-            lcovBrowserDialog = new LcovBrowserDialog(this);
+            coverageViewDialog->resize(var.toSize());
         }
-        lcovBrowserDialog->initializeForLcov(lcovPath);
-        lcovBrowserDialog->show();
+    }
+    if (settings.contains("CoverageViewDialog/pos"))
+    {
+        QVariant var = settings.value("CoverageViewDialog/pos");
+        if (var.canConvert<QPoint>())
+        {
+            coverageViewDialog->move(var.toPoint());
+        }
+    }
+}
 
-        QSettings settings;
-        if (settings.contains("LcovBrowserDialog/size"))
+void MainWindow::on_compareCoverageToolButton_clicked()
+{
+    if (not isComparisonSelected() || m_selectedBranch.isNull())
+    {
+        return;
+    }
+    if (m_ioBlocked != 0)
+    {
+        ui->statusBar->showMessage(
+                    tr("MainWindow: Failed to compare coverage as I/O operation is pending."),
+                    5000);
+        return;
+    }
+    qint64 olderRun = qMin(m_comparedTestrun, m_selectedTestrun);
+    qint64 newerRun = qMax(m_comparedTestrun, m_selectedTestrun);
+
+    // a selected library is compared alone, otherwise every library of the branch
+    QList<QSharedPointer<Library> > libraries;
+    if (m_selectedLibrary)
+    {
+        QStandardItem *projectItem = m_selectedLibrary->parent();
+        QSharedPointer<Project> project = projectItem
+                ? m_selectedBranch->getProject(projectItem->text()) : QSharedPointer<Project>();
+        if (not project.isNull())
         {
-            QVariant var = settings.value("LcovBrowserDialog/size");
-            if (var.canConvert<QSize>())
+            QSharedPointer<Library> library = project->getLibrary(m_selectedLibrary->text());
+            if (not library.isNull())
             {
-                lcovBrowserDialog->resize(var.toSize());
+                libraries << library;
             }
         }
-        if (settings.contains("LcovBrowserDialog/pos"))
+    }
+    else
+    {
+        foreach (const QSharedPointer<Project> &project, m_selectedBranch->getProjects())
         {
-            QVariant var = settings.value("LcovBrowserDialog/pos");
-            if (var.canConvert<QPoint>())
-            {
-                lcovBrowserDialog->move(var.toPoint());
-            }
+            libraries << project->getLibraries();
         }
+    }
 
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    CoverageDelta delta;
+    int comparedLibraries = 0;
+    foreach (const QSharedPointer<Library> &library, libraries)
+    {
+        QList<FileCoverage> older = getColumnFileCoverages(library, olderRun);
+        QList<FileCoverage> newer = getColumnFileCoverages(library, newerRun);
+        if (older.isEmpty() || newer.isEmpty())
+        {
+            continue;
+        }
+        QString scope = libraries.size() > 1 ? library->getName() : QString();
+        delta.compare(scope, older, newer);
+        ++comparedLibraries;
     }
+    QApplication::restoreOverrideCursor();
+    if (comparedLibraries == 0)
+    {
+        QMessageBox::information(
+                    this, tr("Compare coverage"),
+                    tr("Line coverage of both runs is not known. It is recorded for runs "
+                       "whose lcov tracefile was scanned."));
+        return;
+    }
+
+    if (not coverageDeltaDialog)
+    {
+        coverageDeltaDialog = new CoverageDeltaDialog(this);
+    }
+    coverageDeltaDialog->initialize(
+                delta, QDateTime::fromMSecsSinceEpoch(olderRun).toString("dd.MM. hh:mm"),
+                QDateTime::fromMSecsSinceEpoch(newerRun).toString("dd.MM. hh:mm"));
+    coverageDeltaDialog->show();
 
+    QSettings settings;
+    if (settings.contains("CoverageDeltaDialog/size"))
+    {
+        QVariant var = settings.value("CoverageDeltaDialog/size");
+        if (var.canConvert<QSize>())
+        {
+            coverageDeltaDialog->resize(var.toSize());
+        }
+    }
+    if (settings.contains("CoverageDeltaDialog/pos"))
+    {
+        QVariant var = settings.value("CoverageDeltaDialog/pos");
+        if (var.canConvert<QPoint>())
+        {
+            coverageDeltaDialog->move(var.toPoint());
+        }
+    }
+}
+
+QList<FileCoverage> MainWindow::getColumnFileCoverages(const QSharedPointer<Library> &library,
+                                                      qint64 columnKey) const
+{
+    // timestamps come oldest first, the latest coverage of a column wins
+    QList<FileCoverage> result;
+    foreach (qint64 timestamp, library->getFileCoverageTimestamps())
+    {
+        if (getRunColumnKey(timestamp) == columnKey)
+        {
+            result = library->getFileCoverages(timestamp);
+        }
+    }
+    return result;
+}
+
+void MainWindow::showLcovReport(const QString &lcovPath)
+{
+    if (lcovPath.isEmpty())
+    {
+        return;
+    }
+#ifdef UTM_WITH_WEBKIT
+    if (not lcovBrowserDialog)
+    {
+        lcovBrowserDialog = new LcovBrowserDialog(this);
+    }
+    lcovBrowserDialog->initializeForLcov(lcovPath);
+    lcovBrowserDialog->show();
+
+    QSettings settings;
+    if (settings.contains("LcovBrowserDialog/size"))
+    {
+        QVariant var = settings.value("LcovBrowserDialog/size");
+        if (var.canConvert<QSize>())
+        {
+            lcovBrowserDialog->resize(var.toSize());
+        }
+    }
+    if (settings.contains("LcovBrowserDialog/pos"))
+    {
+        QVariant var = settings.value("LcovBrowserDialog/pos");
+        if (var.canConvert<QPoint>())
+        {
+            lcovBrowserDialog->move(var.toPoint());
+        }
+    }
+#else
+    QMessageBox::information(this, tr("Coverage"),
+                             tr("The library has no lcov tracefile, and this build cannot show "
+                                "the genhtml report\n%1").arg(lcovPath));
+#endif
 }
 
 void MainWindow::on_viewTlogToolButton_clicked()
@@ -519,6 +971,45 @@ void MainWindow::on_viewTlogToolButton_clicked()
     }
 }
 
+void MainWindow::on_slowTestsToolButton_clicked()
+{
+    if (m_selectedBranch.isNull())
+    {
+        return;
+    }
+    if (m_ioBlocked != 0)
+    {
+        ui->statusBar->showMessage(
+                    tr("MainWindow: Failed to show slow tests as I/O operation is pending."),
+                    5000);
+        return;
+    }
+    if (not slowTestsDialog)
+    {
+        slowTestsDialog = new SlowTestsDialog(this);
+    }
+    slowTestsDialog->initializeForBranch(m_selectedBranch);
+    slowTestsDialog->show();
+
+    QSettings settings;
+    if (settings.contains("SlowTestsDialog/size"))
+    {
+        QVariant var = settings.value("SlowTestsDialog/size");
+        if (var.canConvert<QSize>())
+        {
+            slowTestsDialog->resize(var.toSize());
+        }
+    }
+    if (settings.contains("SlowTestsDialog/pos"))
+    {
+        QVariant var = settings.value("SlowTestsDialog/pos");
+        if (var.canConvert<QPoint>())
+        {
+            slowTestsDialog->move(var.toPoint());
+        }
+    }
+}
+
 void MainWindow::on_deleteTestrunToolButton_clicked()
 {
     if (not m_ioBlocked.testAndSetAcquire(0, 1))
@@ -542,7 +1033,14 @@ void MainWindow::on_deleteTestrunToolButton_clicked()
         {
             foreach (const QSharedPointer<Testcase> &testcase, library->getTestcases())
             {
-                testcase->deleteTestrun(timestamp);
+                // a column may hold the testruns of several tlogs written within the same build
+                foreach (const QSharedPointer<Testrun> &testrun, testcase->getTestruns())
+                {
+                    if (getRunColumnKey(testrun->getTimestamp()) == timestamp)
+                    {
+                        testcase->deleteTestrun(testrun->getTimestamp());
+                    }
+                }
             }
         }
     }
@@ -562,6 +1060,19 @@ void MainWindow::on_deleteTestrunToolButton_clicked()
         initializeBranchTableModel();
     }
     m_selectedTestrun = -1;
+    m_comparedTestrun = -1;
+}
+
+void MainWindow::handleFinishedCoverageMerge()
+{
+    m_mergedCoverage = m_coverageMergeWatcher.result();
+    if (m_scanRunning)
+    {
+        // the tree is rebuilt when the scan is finished, it shows the result then
+        return;
+    }
+    // a result for an outdated branch state starts the next merge
+    initializeBranchTableModel();
 }
 
 void MainWindow::handleFinishedOpenMonitorSet()
@@ -576,6 +1087,15 @@ void MainWindow::handleFinishedOpenMonitorSet()
 
     m_monitorSet = monitorSet;
 
+    m_branchWatcher.unwatchAll();
+    foreach (const QSharedPointer<Branch> &branch, m_monitorSet->getBranches())
+    {
+        if (branch->isWatched())
+        {
+            m_branchWatcher.watchBranch(branch);
+        }
+    }
+
     initializeBranchTableModel();
     updateBranchTabs();
     ui->stackedWidget->setCurrentIndex(1);
@@ -616,11 +1136,38 @@ void MainWindow::handleFinishedScanBranch()
     QFuture<QSharedPointer<Branch> > future = watcherScanBranch.future();
     if (not future.isResultReadyAt(0))
     {
+        updateScanProgress();
         return;
     }
     m_scanPollTimer.stop();
+    bool cancelled = m_scanProgress->isCancelled();
+    stopScanProgress();
     QSharedPointer<Branch> branch = future.result();
+    if (branch.isNull())
+    {
+        // cancelled scan of a new branch
+        ui->statusBar->showMessage(tr("Scan cancelled."), 5000);
+        m_backgroundScan = false;
+        m_ioBlocked = 0;
+        initializeBranchTableModel();
+        enableIOActions(true);
+        if (m_branchWatcher.hasPendingLibraries())
+        {
+            QTimer::singleShot(0, this, SLOT(processWatchedBranches()));
+        }
+        return;
+    }
+    if (cancelled)
+    {
+        ui->statusBar->showMessage(
+                    tr("Scan cancelled, libraries parsed so far are kept."), 5000);
+    }
     m_monitorSet->addBranch(branch);
+    if (branch->isWatched())
+    {
+        // pick up libraries that were added by the scan
+        m_branchWatcher.watchBranch(branch);
+    }
 
     QFileInfo fileInfo(m_currentMonitorSetFile);
     if (fileInfo.exists() && fileInfo.isFile())
@@ -637,7 +1184,100 @@ void MainWindow::handleFinishedScanBranch()
         initializeBranchTableModel();
     }
     updateBranchTabs();
-    branchTabClicked(branch->getName());
+    if (not m_backgroundScan)
+    {
+        branchTabClicked(branch->getName());
+    }
+    m_backgroundScan = false;
+    if (m_branchWatcher.hasPendingLibraries())
+    {
+        QTimer::singleShot(0, this, SLOT(processWatchedBranches()));
+    }
+}
+
+void MainWindow::startScanProgress()
+{
+    m_scanRunning = true;
+    m_scanProgress->reset();
+    m_scanProgressBar->setRange(0, 0);
+    m_scanProgressBar->setFormat(tr("Discovering libraries"));
+    m_scanProgressBar->setVisible(true);
+    m_cancelScanButton->setEnabled(true);
+    m_cancelScanButton->setVisible(true);
+}
+
+void MainWindow::updateScanProgress()
+{
+    int publications = m_scanProgress->getPublications();
+    if (not m_backgroundScan && publications != m_shownPublications &&
+            (m_shownPublications == 0 || m_scanPreviewTimer.elapsed() >= scanPreviewInterval))
+    {
+        QSharedPointer<Branch> branch = m_scanProgress->getBranch();
+        if (not branch.isNull())
+        {
+            // show what is parsed so far, libraries still busy are shown without testcases
+            m_scanPreviewBranch = branch;
+            m_shownPublications = publications;
+            m_scanPreviewTimer.restart();
+            initializeBranchTableModel();
+            enableIOActions(false);
+        }
+    }
+
+    int pendingLibraries = m_scanProgress->getPendingLibraries();
+    if (pendingLibraries == 0)
+    {
+        // still discovering, the number of tlogs to parse is unknown
+        m_scanProgressBar->setRange(0, 0);
+        m_scanProgressBar->setFormat(tr("Discovered %1 libraries")
+                                     .arg(m_scanProgress->getDiscoveredLibraries()));
+        return;
+    }
+
+    int parsedLibraries = m_scanProgress->getParsedLibraries();
+    QString format = tr("%1 of %2 libraries, %3 of %4 MB")
+            .arg(parsedLibraries).arg(pendingLibraries)
+            .arg(m_scanProgress->getBytesRead() / (1024.0 * 1024.0), 0, 'f', 1)
+            .arg(m_scanProgress->getPendingBytes() / (1024.0 * 1024.0), 0, 'f', 1);
+    qint64 remainingMsecs = m_scanProgress->getRemainingMsecs();
+    if (remainingMsecs >= 0)
+    {
+        format.append(tr(", %1 s left").arg((remainingMsecs + 999) / 1000));
+    }
+    m_scanProgressBar->setRange(0, pendingLibraries);
+    m_scanProgressBar->setValue(parsedLibraries);
+    m_scanProgressBar->setFormat(format);
+}
+
+void MainWindow::stopScanProgress()
+{
+    m_scanProgressBar->setVisible(false);
+    m_cancelScanButton->setVisible(false);
+    m_scanPreviewBranch.clear();
+    m_shownPublications = 0;
+    m_scanRunning = false;
+}
+
+bool MainWindow::isLibraryBusy(const QSharedPointer<Library> &library) const
+{
+    return not m_scanPreviewBranch.isNull() && m_scanProgress->isBusy(library.data());
+}
+
+void MainWindow::pollBranches()
+{
+    // the probes copy the branches, which must not happen while a scan modifies them
+    if (m_monitorSet.isNull() || m_ioBlocked != 0)
+    {
+        return;
+    }
+    m_branchPoller.poll(m_monitorSet->getBranches());
+}
+
+void MainWindow::cancelScan()
+{
+    m_scanProgress->cancel();
+    m_cancelScanButton->setEnabled(false);
+    m_scanProgressBar->setFormat(tr("Cancelling after the current libraries"));
 }
 
 void MainWindow::enableIOActions(bool enabled)
@@ -652,43 +1292,112 @@ void MainWindow::enableIOActions(bool enabled)
     ui->addBranchToolButton->setEnabled(enabled);
     ui->removeBranchToolButton->setEnabled(enabled);
     ui->updateBranchToolButton->setEnabled(enabled);
+    ui->watchBranchToolButton->setEnabled(enabled);
+    ui->branchTabsToolsMenu->setEnabled(enabled);
+    ui->slowTestsToolButton->setEnabled(enabled);
     ui->deleteTestrunToolButton->setEnabled(enabled);
+    ui->compareCoverageToolButton->setEnabled(enabled);
 }
 
 void MainWindow::initializeBranchTableModel()
 {
+    // until a scan publishes its branch it adds projects and libraries and changes testruns on
+    // its worker thread, the tree is rebuilt once handleFinishedScanBranch has the result
+    if (m_scanRunning && m_scanPreviewBranch.isNull())
+    {
+        if (m_shownBranch != m_selectedBranch)
+        {
+            // the tree of another branch would act on the selected one
+            m_branchTableModel->clear();
+            m_headerTimestamps.clear();
+            m_shownBranch.clear();
+        }
+        updateTools();
+        return;
+    }
     m_branchTableModel->clear();
 
-    if (not m_selectedBranch.isNull())
+    // while a scan runs the tree shows the branch it publishes
+    QSharedPointer<Branch> branch = m_scanPreviewBranch.isNull() ? m_selectedBranch
+                                                                 : m_scanPreviewBranch;
+    m_shownBranch = branch;
+    if (not branch.isNull())
     {
         QStandardItem *rootItem = m_branchTableModel->invisibleRootItem();
 
         int columnCount = 1;
+        bool hasBenchmarks = false;
         QList<qint64> testrunKeys;
         QMap<qint64, QSharedPointer<Testrun> > runsMap;
 
-        foreach (const QSharedPointer<Project> &project, m_selectedBranch->getProjects())
+        foreach (const QSharedPointer<Project> &project, branch->getProjects())
         {
             foreach (const QSharedPointer<Library> &library, project->getLibraries())
             {
+                if (isLibraryBusy(library))
+                {
+                    continue;
+                }
                 foreach (const QSharedPointer<Testcase> &testcase, library->getTestcases())
                 {
-                    columnCount = qMax(columnCount, testcase->getTestrunsCount() + 1);
                     // collect timestamps
                     QList<QSharedPointer<Testrun> > testrunsUnsorted = testcase->getTestruns();
                     foreach (const QSharedPointer<Testrun> &testrun, testrunsUnsorted)
                     {
                         qint64 timestamp = testrun->getTimestamp();
                         runsMap.insert(timestamp, testrun);
+                        hasBenchmarks = hasBenchmarks ||
+                                not testrun->getBenchmarkResults().isEmpty();
+                    }
+                }
+                // a tracefile written after the tlogs may open a column of its own
+                foreach (qint64 timestamp, library->getCoverages().keys())
+                {
+                    if (not runsMap.contains(timestamp))
+                    {
+                        runsMap.insert(timestamp, QSharedPointer<Testrun>());
                     }
                 }
             }
         }
-        testrunKeys = runsMap.keys();
+        testrunKeys = groupRunColumns(runsMap.keys());
         runsMap.clear();
+        columnCount = qMax(columnCount, testrunKeys.size() + 1);
+
+        // benchmark trends get a column right of the latest testrun
+        int trendColumn = 0;
+        if (hasBenchmarks)
+        {
+            trendColumn = testrunKeys.size() + 1;
+            columnCount = qMax(columnCount, trendColumn + 1);
+        }
 
         m_branchTableModel->setColumnCount(columnCount);
 
+        // projects and the branch show the merged coverage of their libraries once it is known,
+        // the histories are only read while no scan changes them
+        bool showMergedCoverage = false;
+        if (not m_scanRunning)
+        {
+            QString signature;
+            QList<CoverageMerger::Source> sources =
+                    CoverageMerger::collectSources(branch, signature);
+            showMergedCoverage = not sources.isEmpty() && m_mergedCoverage.signature == signature;
+            if (not showMergedCoverage && not sources.isEmpty() &&
+                    not m_coverageMergeWatcher.isRunning())
+            {
+                m_coverageMergeWatcher.setFuture(
+                            QtConcurrent::run(&CoverageMerger::merge, sources, signature));
+            }
+        }
+        if (showMergedCoverage)
+        {
+            QMap<qint64, Coverage> branchCoverage;
+            branchCoverage.insert(m_mergedCoverage.branchTimestamp, m_mergedCoverage.branch);
+            appendCoverageRow(rootItem, columnCount, testrunKeys, branchCoverage,
+                              tr("Branch coverage"));
+        }
+
         QIcon iconPassed(":/images/passed.png");
         QIcon iconFailed(":/images/failed.png");
         QIcon iconSkipped(":/images/skipped.png");
@@ -697,10 +1406,19 @@ void MainWindow::initializeBranchTableModel()
         QMap<int, qint64> timestamps;
 
 
-        foreach (const QSharedPointer<Project> &project, m_selectedBranch->getProjects())
+        foreach (const QSharedPointer<Project> &project, branch->getProjects())
         {
             QString projectName = project->getName();
             QStandardItem *projectItem = new QStandardItem(projectName);
+            projectItem->setData(ProjectItem, itemKindRole);
+            if (showMergedCoverage && m_mergedCoverage.projects.contains(projectName))
+            {
+                QMap<qint64, Coverage> projectCoverage;
+                projectCoverage.insert(m_mergedCoverage.projectTimestamps.value(projectName),
+                                       m_mergedCoverage.projects.value(projectName));
+                appendCoverageRow(projectItem, columnCount, testrunKeys, projectCoverage,
+                                  tr("Merged coverage"));
+            }
             QMap<int, QPair<int, QIcon> > iconsProject;
             QMap<int, int> passedProject;
             QMap<int, int> failedProject;
@@ -710,11 +1428,23 @@ void MainWindow::initializeBranchTableModel()
             {
                 QStandardItem *libraryItem = new QStandardItem(library->getName());
                 libraryItem->setData(library->getLcovPath());
+                libraryItem->setData(library->getInfoPath(), Qt::UserRole + 2);
+                libraryItem->setData(LibraryItem, itemKindRole);
                 QMap<int, QPair<int, QIcon> > iconsLibrary;
                 QMap<int, int> passedLibrary;
                 QMap<int, int> failedLibrary;
                 QMap<int, int> skippedLibrary;
 
+                if (isLibraryBusy(library))
+                {
+                    libraryItem->setText(tr("%1 (scanning)").arg(library->getName()));
+                    appendFilledRow(projectItem, columnCount, libraryItem, iconsLibrary,
+                                    passedLibrary, failedLibrary, skippedLibrary);
+                    continue;
+                }
+
+                appendCoverageRow(libraryItem, columnCount, testrunKeys, library->getCoverages());
+
                 foreach (const QSharedPointer<Testcase> &testcase, library->getTestcases())
                 {
                     QStandardItem *testcaseItem = new QStandardItem(testcase->getName());
@@ -722,8 +1452,10 @@ void MainWindow::initializeBranchTableModel()
                     testcaseItem->setData(testcase->getTlogPath(), Qt::UserRole + 1);
                     testcaseItem->setData(testcase->getTlogStartLine(), Qt::UserRole + 2);
                     testcaseItem->setData(testcase->getTlogEndLine(), Qt::UserRole + 3);
+                    testcaseItem->setData(TestcaseItem, itemKindRole);
 
                     QList<QStandardItem*> testcaseItems;
+                    QList<QSharedPointer<Testrun> > columnTestruns;
                     int column = 1;
 
                     QList<qint64> currentTestrunKeys;
@@ -731,7 +1463,8 @@ void MainWindow::initializeBranchTableModel()
                     QList<QSharedPointer<Testrun> > testrunsUnsorted = testcase->getTestruns();
                     foreach (const QSharedPointer<Testrun> &testrun, testrunsUnsorted)
                     {
-                        runsMap.insert(testrun->getTimestamp(), testrun);
+                        // testruns come oldest first, the latest of a column wins
+                        runsMap.insert(getRunColumnKey(testrun->getTimestamp()), testrun);
                     }
 
                     currentTestrunKeys = runsMap.keys();
@@ -742,7 +1475,7 @@ void MainWindow::initializeBranchTableModel()
                     {
                         qint64 runsMapKey = currentTestrunKeys.takeLast();
                         QSharedPointer<Testrun> testrun = runsMap.value(runsMapKey);
-                        timestamps.insert(column, testrun->getTimestamp());
+                        timestamps.insert(column, runsMapKey);
 
                         int failedTestrun = testrun->getFailed();
                         int skippedTestrun = testrun->getSkipped();
@@ -842,11 +1575,43 @@ void MainWindow::initializeBranchTableModel()
                             QStringList failLogs = testrun->getFailLogs();
                             testrunItem->setData(failLogs.join("\n"));
                         }
+                        if (testrun->isInProgress())
+                        {
+                            // the tlog is still being written, early fails show up already
+                            testrunItem->setText(tr("%1 (running)").arg(text));
+                            if (failedTestrun <= 0)
+                            {
+                                testrunItem->setToolTip(tr("The testcase is still running."));
+                            }
+                        }
+                        else if (testrun->isAborted())
+                        {
+                            // the tlog stopped growing before the testcase's totals were written
+                            testrunItem->setText(tr("%1 (aborted)").arg(text));
+                            if (failedTestrun <= 0)
+                            {
+                                testrunItem->setToolTip(tr("The testcase did not finish."));
+                            }
+                        }
                         testcaseItems << testrunItem;
+                        columnTestruns << testrun;
                         ++column;
                     } // foreach testruns
 
                     testcaseItems.insert(0, testcaseItem);
+                    int regressions = appendFunctionRows(
+                                testcaseItem, columnCount, trendColumn, testcase, columnTestruns);
+                    if (trendColumn > 0)
+                    {
+                        QStandardItem *trendItem = new QStandardItem("");
+                        trendItem->setTextAlignment(Qt::AlignCenter);
+                        if (regressions > 0)
+                        {
+                            trendItem->setText(QString("%1 slower").arg(regressions));
+                            trendItem->setBackground(QColor::fromRgb(240, 130, 130, 230));
+                        }
+                        testcaseItems << trendItem;
+                    }
 
                     libraryItem->appendRow(testcaseItems);
                 } // foreach testcases
@@ -866,6 +1631,10 @@ void MainWindow::initializeBranchTableModel()
                     toString("dd.MM. hh:mm");
             headerLabels << timeLabel;
         }
+        if (trendColumn > 0)
+        {
+            headerLabels << "Trend";
+        }
         m_branchTableModel->setHorizontalHeaderLabels(headerLabels);
         m_headerTimestamps = timestamps;
 
@@ -875,6 +1644,42 @@ void MainWindow::initializeBranchTableModel()
     updateTools();
 }
 
+QList<qint64> MainWindow::groupRunColumns(const QList<qint64> &timestamps)
+{
+    // testruns are keyed on their tlog's modification time, the tlogs of one build are written
+    // within minutes and share a column keyed on the latest of them
+    m_runColumnKeys.clear();
+    QList<qint64> columnKeys;
+    QList<qint64> group;
+    foreach (qint64 timestamp, timestamps)
+    {
+        if (not group.isEmpty() && timestamp - group.first() > m_runGroupWindow)
+        {
+            foreach (qint64 member, group)
+            {
+                m_runColumnKeys.insert(member, group.last());
+            }
+            columnKeys << group.last();
+            group.clear();
+        }
+        group << timestamp;
+    }
+    foreach (qint64 member, group)
+    {
+        m_runColumnKeys.insert(member, group.last());
+    }
+    if (not group.isEmpty())
+    {
+        columnKeys << group.last();
+    }
+    return columnKeys;
+}
+
+qint64 MainWindow::getRunColumnKey(qint64 timestamp) const
+{
+    return m_runColumnKeys.value(timestamp, timestamp);
+}
+
 void MainWindow::fillMissingRuns(const QList<qint64> testrunKeys,
                                  QMap<qint64, QSharedPointer<Testrun> > &runsMap)
 {
@@ -890,6 +1695,192 @@ void MainWindow::fillMissingRuns(const QList<qint64> testrunKeys,
     }
 }
 
+void MainWindow::appendCoverageRow(
+        QStandardItem *parentItem, int columnCount, const QList<qint64> &testrunKeys,
+        const QMap<qint64, Coverage> &coverages, const QString &title)
+{
+    if (not parentItem || coverages.isEmpty())
+    {
+        return;
+    }
+
+    // coverages come oldest first, the latest of a column wins
+    QMap<qint64, Coverage> columnCoverages;
+    QMap<qint64, Coverage>::const_iterator it = coverages.constBegin();
+    for (; it != coverages.constEnd(); ++it)
+    {
+        columnCoverages.insert(getRunColumnKey(it.key()), it.value());
+    }
+
+    QList<QStandardItem*> rowItems;
+    QStandardItem *coverageItem = new QStandardItem(title.isEmpty() ? tr("Coverage") : title);
+    coverageItem->setData(CoverageItem, itemKindRole);
+    rowItems << coverageItem;
+    for (int c = 1; c < columnCount; ++c)
+    {
+        QStandardItem *rateItem = new QStandardItem("");
+        rateItem->setTextAlignment(Qt::AlignRight);
+        int keyIndex = testrunKeys.size() - c;
+        if (keyIndex >= 0 && columnCoverages.contains(testrunKeys.at(keyIndex)))
+        {
+            Coverage coverage = columnCoverages.value(testrunKeys.at(keyIndex));
+            QString text = tr("L %1").arg(formatRate(coverage.getLineRate()));
+            if (coverage.getFunctionsFound() > 0)
+            {
+                text.append(tr("  F %1").arg(formatRate(coverage.getFunctionRate())));
+            }
+            if (coverage.getBranchesFound() > 0)
+            {
+                text.append(tr("  B %1").arg(formatRate(coverage.getBranchRate())));
+            }
+
+            // the line rate moves against the next older column with a coverage
+            for (int older = keyIndex - 1; older >= 0; --older)
+            {
+                if (not columnCoverages.contains(testrunKeys.at(older)))
+                {
+                    continue;
+                }
+                double olderRate = columnCoverages.value(testrunKeys.at(older)).getLineRate();
+                double change = coverage.getLineRate() - olderRate;
+                if (olderRate >= 0.0 && coverage.getLineRate() >= 0.0 &&
+                        (change >= 0.05 || change <= -0.05))
+                {
+                    text.append(QString(" (%1%2)").arg(change > 0.0 ? "+" : "")
+                                .arg(change, 0, 'f', 1));
+                    rateItem->setBackground(change > 0.0 ? QColor::fromRgb(130, 255, 130, 230)
+                                                         : QColor::fromRgb(240, 130, 130, 230));
+                }
+                break;
+            }
+            rateItem->setText(text);
+            QString toolTip = tr("lines: %1 of %2\nfunctions: %3 of %4\nbranches: %5 of %6")
+                    .arg(coverage.getLinesHit()).arg(coverage.getLinesFound())
+                    .arg(coverage.getFunctionsHit()).arg(coverage.getFunctionsFound())
+                    .arg(coverage.getBranchesHit()).arg(coverage.getBranchesFound());
+            if (not coverage.getReportDate().isEmpty())
+            {
+                toolTip.append(tr("\nreport of %1").arg(coverage.getReportDate()));
+            }
+            rateItem->setToolTip(toolTip);
+        }
+        rowItems << rateItem;
+    }
+    parentItem->appendRow(rowItems);
+}
+
+QString MainWindow::formatRate(double rate) const
+{
+    return rate < 0.0 ? QString("n/a") : QString("%1%").arg(rate, 0, 'f', 1);
+}
+
+int MainWindow::appendFunctionRows(
+        QStandardItem *testcaseItem, int columnCount, int trendColumn,
+        const QSharedPointer<Testcase> &testcase,
+        const QList<QSharedPointer<Testrun> > &columnTestruns)
+{
+    int regressions = 0;
+    if (not testcaseItem || testcase.isNull())
+    {
+        return regressions;
+    }
+
+    QList<QSharedPointer<Testrun> > testruns = testcase->getTestruns();
+    QStringList functionNames = testcase->getFunctionNames();
+    for (int functionId = 0; functionId < functionNames.size(); ++functionId)
+    {
+        QList<QStandardItem*> rowItems;
+        QStandardItem *functionItem = new QStandardItem(functionNames.at(functionId));
+        functionItem->setData(TestfunctionItem, itemKindRole);
+        rowItems << functionItem;
+        for (int c = 1; c < columnCount; ++c)
+        {
+            QStandardItem *stateItem = new QStandardItem("");
+            stateItem->setTextAlignment(Qt::AlignCenter);
+            stateItem->setBackground(QColor::fromRgb(190, 190, 190, 230));
+            if (c == trendColumn)
+            {
+                QList<double> values;
+                QString unit;
+                foreach (const QSharedPointer<Testrun> &testrun, testruns)
+                {
+                    Model::BenchmarkResult result = testrun->getBenchmarkResult(functionId);
+                    if (not result.isEmpty())
+                    {
+                        values << result.getValue();
+                        unit = result.getUnit();
+                    }
+                }
+                BenchmarkTrend::Rating rating = m_benchmarkTrend.rate(values);
+                if (rating != BenchmarkTrend::Unrated)
+                {
+                    stateItem->setText(QString("%1%2 %")
+                                       .arg(m_benchmarkTrend.getChange() > 0.0 ? "+" : "")
+                                       .arg(m_benchmarkTrend.getChange(), 0, 'f', 1));
+                    stateItem->setToolTip(QString("median of recent runs: %1 %2")
+                                          .arg(m_benchmarkTrend.getMedian()).arg(unit));
+                }
+                if (rating == BenchmarkTrend::Regressed)
+                {
+                    stateItem->setBackground(QColor::fromRgb(240, 130, 130, 230));
+                    ++regressions;
+                }
+                else if (rating == BenchmarkTrend::Improved)
+                {
+                    stateItem->setBackground(QColor::fromRgb(130, 255, 130, 230));
+                }
+            }
+            else if (c - 1 < columnTestruns.size())
+            {
+                const QSharedPointer<Testrun> &testrun = columnTestruns.at(c - 1);
+                Testfunction::State state = testrun->getFunctionState(functionId);
+                stateItem->setText(Testfunction::incidentFromState(state));
+                switch (state)
+                {
+                case Testfunction::Failed:
+                case Testfunction::UnexpectedPass:
+                    stateItem->setBackground(QColor::fromRgb(240, 130, 130, 230));
+                    break;
+                case Testfunction::Skipped:
+                    stateItem->setBackground(QColor::fromRgb(255, 221, 0, 230));
+                    break;
+                case Testfunction::Passed:
+                case Testfunction::ExpectedFailure:
+                    stateItem->setBackground(QColor::fromRgb(130, 255, 130, 230));
+                    break;
+                default:
+                    break;
+                }
+
+                QStringList toolTip;
+                QPair<QString, int> location = testcase->getFunctionLocation(functionId);
+                if (not location.first.isEmpty())
+                {
+                    toolTip << QString("%1(%2)").arg(location.first).arg(location.second);
+                }
+                double duration = testrun->getFunctionDuration(functionId);
+                if (duration >= 0.0)
+                {
+                    toolTip << QString("%1 ms").arg(duration);
+                }
+                Model::BenchmarkResult result = testrun->getBenchmarkResult(functionId);
+                if (not result.isEmpty())
+                {
+                    stateItem->setText(
+                                QString("%1 %2").arg(result.getValue()).arg(result.getUnit()));
+                    toolTip << QString("%1 per iteration, %2 iterations, %3")
+                               .arg(result.getUnit()).arg(result.getIterations())
+                               .arg(result.getBackend());
+                }
+                stateItem->setToolTip(toolTip.join("\n"));
+            }
+            rowItems << stateItem;
+        }
+        testcaseItem->appendRow(rowItems);
+    }
+    return regressions;
+}
+
 void MainWindow::appendFilledRow(
         QStandardItem *parentItem, int columnCount,
         QStandardItem *firstItem, const QMap<int, QPair<int, QIcon> > &icons,
@@ -1002,6 +1993,8 @@ void MainWindow::branchTabClicked(const QString &text)
     }
     QLayoutItem* item;
     m_selectedBranch.clear();
+    m_selectedTestrun = -1;
+    m_comparedTestrun = -1;
     int tabs = ui->branchTabsBarLayout->count();
     for (int i = 0; i < tabs; ++i)
     {
@@ -1086,6 +2079,7 @@ void MainWindow::openRecentMonitorSetFile()
 
 void MainWindow::itemClicked(QModelIndex index)
 {
+    qint64 previousTestrun = m_selectedTestrun;
     m_selectedLibrary = 0;
     m_selectedTestcase = 0;
     m_selectedTestrun = -1;
@@ -1096,6 +2090,11 @@ void MainWindow::itemClicked(QModelIndex index)
         {
 
             m_selectedTestrun = m_headerTimestamps.value(clickColumn);
+            // the run clicked before is the one coverage gets compared to
+            if (previousTestrun >= 0 && previousTestrun != m_selectedTestrun)
+            {
+                m_comparedTestrun = previousTestrun;
+            }
         }
         QModelIndex firstColumnOfClick = index;
         if (index.column() > 0)
@@ -1103,14 +2102,20 @@ void MainWindow::itemClicked(QModelIndex index)
             firstColumnOfClick = index.sibling(index.row(), 0);
         }
         QStandardItem* item = m_branchTableModel->itemFromIndex(firstColumnOfClick);
-        if (not firstColumnOfClick.child(0, 0).isValid())
+        int itemKind = item ? item->data(itemKindRole).toInt() : 0;
+        if (itemKind == TestfunctionItem || itemKind == CoverageItem)
+        {
+            // test function rows act on the tlog of their testcase, coverage rows on the lcov
+            // report of their library
+            item = item->parent();
+            itemKind = item ? item->data(itemKindRole).toInt() : 0;
+        }
+        if (itemKind == TestcaseItem)
         {
-            // is testcase row
             m_selectedTestcase = item;
         }
-        else if (not firstColumnOfClick.child(0, 0).child(0, 0).isValid())
+        else if (itemKind == LibraryItem)
         {
-            // is library row
             m_selectedLibrary = item;
         }
     }
@@ -0,0 +1,154 @@
+/**
+  * @file BenchmarkResult.cpp
+  *
+  * @class Model::BenchmarkResult
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Model element representing the QBENCHMARK result of a test function within a testrun.
+  * @details A benchmark result is the value per iteration, the number of iterations, the unit of
+  *          the value, and the measurement backend (walltime, tickcounter, callgrind, or perf).
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#include "Model/BenchmarkResult.h"
+
+namespace Model
+{
+
+BenchmarkResult::BenchmarkResult()
+    : m_value(-1.0),
+      m_iterations(0)
+{
+}
+
+BenchmarkResult::BenchmarkResult(const BenchmarkResult &other)
+    : m_value(other.m_value),
+      m_iterations(other.m_iterations),
+      m_unit(other.m_unit),
+      m_backend(other.m_backend)
+{
+}
+
+BenchmarkResult& BenchmarkResult::operator=(const BenchmarkResult &other)
+{
+    m_value = other.m_value;
+    m_iterations = other.m_iterations;
+    m_unit = other.m_unit;
+    m_backend = other.m_backend;
+    return *this;
+}
+
+BenchmarkResult& BenchmarkResult::withValue(const double value)
+{
+    m_value = value;
+    return *this;
+}
+
+BenchmarkResult& BenchmarkResult::withIterations(const int iterations)
+{
+    m_iterations = iterations;
+    return *this;
+}
+
+BenchmarkResult& BenchmarkResult::withUnit(const QString &unit)
+{
+    m_unit = unit;
+    return *this;
+}
+
+BenchmarkResult& BenchmarkResult::withBackend(const QString &backend)
+{
+    m_backend = backend;
+    return *this;
+}
+
+double BenchmarkResult::getValue() const
+{
+    return m_value;
+}
+
+int BenchmarkResult::getIterations() const
+{
+    return m_iterations;
+}
+
+QString BenchmarkResult::getUnit() const
+{
+    return m_unit;
+}
+
+QString BenchmarkResult::getBackend() const
+{
+    return m_backend;
+}
+
+bool BenchmarkResult::isEmpty() const
+{
+    return m_value < 0.0;
+}
+
+QString BenchmarkResult::backendFromUnit(const QString &unit)
+{
+    if (unit == "msecs" || unit == "nsecs")
+    {
+        return "walltime";
+    }
+    if (unit == "CPU ticks")
+    {
+        return "tickcounter";
+    }
+    if (unit == "instruction reads")
+    {
+        return "callgrind";
+    }
+    // everything else is one of the event counters of the perf backend
+    return "perf";
+}
+
+QString BenchmarkResult::unitFromMetric(const QString &metric)
+{
+    // metric names of the testlib xml logger and the units the plain text logger prints for them
+    static const char *const metrics[][2] =
+    {
+        { "WalltimeMilliseconds", "msecs" },
+        { "WalltimeNanoseconds", "nsecs" },
+        { "CPUTicks", "CPU ticks" },
+        { "InstructionReads", "instruction reads" },
+        { "Events", "events" },
+        { "BytesAllocated", "bytes" },
+        { "CPUMigrations", "CPU migrations" },
+        { "CPUCycles", "CPU cycles" },
+        { "RefCPUCycles", "CPU cycles" },
+        { "BusCycles", "bus cycles" },
+        { "StalledCycles", "stalled cycles" },
+        { "Instructions", "instructions" },
+        { "BranchInstructions", "branch instructions" },
+        { "BranchMisses", "branch misses" },
+        { "CacheReferences", "cache references" },
+        { "CacheReads", "cache loads" },
+        { "CacheWrites", "cache stores" },
+        { "CachePrefetches", "cache prefetches" },
+        { "CacheMisses", "cache misses" },
+        { "CacheReadMisses", "cache load misses" },
+        { "CacheWriteMisses", "cache store misses" },
+        { "CachePrefetchMisses", "cache prefetch misses" },
+        { "ContextSwitches", "context switches" },
+        { "PageFaults", "page faults" },
+        { "MinorPageFaults", "minor page faults" },
+        { "MajorPageFaults", "major page faults" },
+        { "AlignmentFaults", "alignment faults" },
+        { "EmulationFaults", "emulation faults" }
+    };
+    for (unsigned int i = 0; i < sizeof(metrics) / sizeof(metrics[0]); ++i)
+    {
+        if (metric == metrics[i][0])
+        {
+            return metrics[i][1];
+        }
+    }
+    return metric;
+}
+
+} // namespace Model
@@ -19,12 +19,15 @@ namespace Model
 {
 
 Branch::Branch()
+    : m_watched(false)
 {
 }
 
 Branch::Branch(const Branch &other)
     : m_path(other.m_path),
       m_name(other.m_name),
+      m_watched(other.m_watched),
+      m_layout(other.m_layout),
       m_projects(other.m_projects)
 {
 }
@@ -41,6 +44,18 @@ Branch& Branch::withName(const QString &name)
     return *this;
 }
 
+Branch& Branch::withWatched(bool watched)
+{
+    m_watched = watched;
+    return *this;
+}
+
+Branch& Branch::withLayout(const BranchLayout &layout)
+{
+    m_layout = layout;
+    return *this;
+}
+
 QString Branch::getPath() const
 {
     return m_path;
@@ -51,6 +66,16 @@ QString Branch::getName() const
     return m_name;
 }
 
+bool Branch::isWatched() const
+{
+    return m_watched;
+}
+
+BranchLayout Branch::getLayout() const
+{
+    return m_layout;
+}
+
 QSharedPointer<Project> Branch::getProject(const QString &name) const
 {
     QSharedPointer<Project> result;
@@ -0,0 +1,219 @@
+/**
+  * @file BranchLayout.cpp
+  *
+  * @class Model::BranchLayout
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Model element describing where a branch keeps its test output.
+  * @details A layout has path templates for tlogs, lcov reports, and lcov tracefiles, relative to
+  *          the branch directory, and glob patterns of project and library names to skip. A
+  *          template names its project and library with {project} and {library} and may use the
+  *          globs * and ? within a path segment or ** for any number of directories. The templates
+  *          of a kind are tried in their order. A tracefile is optional, a library without one
+  *          just has no coverage numbers. A default constructed layout describes the
+  *          <project>/_/tests/<library>/tlog and <project>/_/testcoverage/<library>/index.html
+  *          structure with the tracefile next to the report. As rules a layout reads and writes
+  *          one line per template or pattern.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#include "Model/BranchLayout.h"
+
+namespace Model
+{
+
+namespace
+{
+
+const QString tlogRule = "tlog";
+const QString lcovRule = "lcov";
+const QString infoRule = "info";
+const QString skipProjectRule = "skip-project";
+const QString skipLibraryRule = "skip-library";
+
+} // namespace
+
+BranchLayout::BranchLayout()
+    : m_tlogTemplates(QStringList() << "{project}/_/tests/{library}/tlog"
+                      << "{project}/_/tests/{library}/tlog.xml"
+                      << "{project}/_/tests/{library}/junit.xml"),
+      m_lcovTemplates(QStringList() << "{project}/_/testcoverage/{library}/index.html"),
+      m_infoTemplates(QStringList() << "{project}/_/testcoverage/{library}/{library}.info"
+                      << "{project}/_/testcoverage/{library}/coverage.info"),
+      m_projectExcludes(QStringList() << "_"),
+      m_libraryExcludes(QStringList() << "_" << "*Test")
+{
+}
+
+BranchLayout::BranchLayout(const BranchLayout &other)
+    : m_tlogTemplates(other.m_tlogTemplates),
+      m_lcovTemplates(other.m_lcovTemplates),
+      m_infoTemplates(other.m_infoTemplates),
+      m_projectExcludes(other.m_projectExcludes),
+      m_libraryExcludes(other.m_libraryExcludes)
+{
+}
+
+BranchLayout& BranchLayout::operator=(const BranchLayout &other)
+{
+    m_tlogTemplates = other.m_tlogTemplates;
+    m_lcovTemplates = other.m_lcovTemplates;
+    m_infoTemplates = other.m_infoTemplates;
+    m_projectExcludes = other.m_projectExcludes;
+    m_libraryExcludes = other.m_libraryExcludes;
+    return *this;
+}
+
+bool BranchLayout::operator==(const BranchLayout &other) const
+{
+    return m_tlogTemplates == other.m_tlogTemplates
+            && m_lcovTemplates == other.m_lcovTemplates
+            && m_infoTemplates == other.m_infoTemplates
+            && m_projectExcludes == other.m_projectExcludes
+            && m_libraryExcludes == other.m_libraryExcludes;
+}
+
+bool BranchLayout::operator!=(const BranchLayout &other) const
+{
+    return not (*this == other);
+}
+
+BranchLayout BranchLayout::fromRules(const QStringList &rules, QStringList *invalidRules)
+{
+    // one rule per line: "<kind> <template or pattern>", empty lines and # comments are skipped
+    BranchLayout result;
+    result.m_tlogTemplates.clear();
+    result.m_lcovTemplates.clear();
+    result.m_infoTemplates.clear();
+    result.m_projectExcludes.clear();
+    result.m_libraryExcludes.clear();
+    foreach (const QString &line, rules)
+    {
+        QString rule = line.trimmed();
+        if (rule.isEmpty() || rule.startsWith('#'))
+        {
+            continue;
+        }
+        QString kind = rule.section(' ', 0, 0);
+        QString value = rule.section(' ', 1).trimmed();
+        if (value.isEmpty())
+        {
+            kind.clear();
+        }
+        if (kind == tlogRule)
+        {
+            result.m_tlogTemplates.append(value);
+        }
+        else if (kind == lcovRule)
+        {
+            result.m_lcovTemplates.append(value);
+        }
+        else if (kind == infoRule)
+        {
+            result.m_infoTemplates.append(value);
+        }
+        else if (kind == skipProjectRule)
+        {
+            result.m_projectExcludes.append(value);
+        }
+        else if (kind == skipLibraryRule)
+        {
+            result.m_libraryExcludes.append(value);
+        }
+        else if (invalidRules)
+        {
+            invalidRules->append(line);
+        }
+    }
+    return result;
+}
+
+QStringList BranchLayout::toRules() const
+{
+    QStringList result;
+    foreach (const QString &pathTemplate, m_tlogTemplates)
+    {
+        result.append(QString("%1 %2").arg(tlogRule).arg(pathTemplate));
+    }
+    foreach (const QString &pathTemplate, m_lcovTemplates)
+    {
+        result.append(QString("%1 %2").arg(lcovRule).arg(pathTemplate));
+    }
+    foreach (const QString &pathTemplate, m_infoTemplates)
+    {
+        result.append(QString("%1 %2").arg(infoRule).arg(pathTemplate));
+    }
+    foreach (const QString &pattern, m_projectExcludes)
+    {
+        result.append(QString("%1 %2").arg(skipProjectRule).arg(pattern));
+    }
+    foreach (const QString &pattern, m_libraryExcludes)
+    {
+        result.append(QString("%1 %2").arg(skipLibraryRule).arg(pattern));
+    }
+    return result;
+}
+
+BranchLayout& BranchLayout::withTlogTemplates(const QStringList &templates)
+{
+    m_tlogTemplates = templates;
+    return *this;
+}
+
+BranchLayout& BranchLayout::withLcovTemplates(const QStringList &templates)
+{
+    m_lcovTemplates = templates;
+    return *this;
+}
+
+BranchLayout& BranchLayout::withInfoTemplates(const QStringList &templates)
+{
+    m_infoTemplates = templates;
+    return *this;
+}
+
+BranchLayout& BranchLayout::withProjectExcludes(const QStringList &patterns)
+{
+    m_projectExcludes = patterns;
+    return *this;
+}
+
+BranchLayout& BranchLayout::withLibraryExcludes(const QStringList &patterns)
+{
+    m_libraryExcludes = patterns;
+    return *this;
+}
+
+QStringList BranchLayout::getTlogTemplates() const
+{
+    return m_tlogTemplates;
+}
+
+QStringList BranchLayout::getLcovTemplates() const
+{
+    return m_lcovTemplates;
+}
+
+QStringList BranchLayout::getInfoTemplates() const
+{
+    return m_infoTemplates;
+}
+
+QStringList BranchLayout::getProjectExcludes() const
+{
+    return m_projectExcludes;
+}
+
+QStringList BranchLayout::getLibraryExcludes() const
+{
+    return m_libraryExcludes;
+}
+
+bool BranchLayout::isDefault() const
+{
+    return *this == BranchLayout();
+}
+
+} // namespace Model
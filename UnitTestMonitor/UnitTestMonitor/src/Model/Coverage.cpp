@@ -0,0 +1,146 @@
+/**
+  * @file Coverage.cpp
+  *
+  * @class Model::Coverage
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Model element holding the code coverage of a library at one point in time.
+  * @details A coverage counts the instrumented and the executed lines, functions, and branches of
+  *          an lcov tracefile or of the header of a genhtml report, which also tells the date the
+  *          report was generated. A rate is a percentage, or -1 if nothing of its kind was found.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#include "Model/Coverage.h"
+
+namespace Model
+{
+
+namespace
+{
+
+double rate(qint64 found, qint64 hit)
+{
+    return found > 0 ? 100.0 * hit / found : -1.0;
+}
+
+} // namespace
+
+Coverage::Coverage()
+    : m_linesFound(0),
+      m_linesHit(0),
+      m_functionsFound(0),
+      m_functionsHit(0),
+      m_branchesFound(0),
+      m_branchesHit(0)
+{
+}
+
+Coverage::Coverage(const Coverage &other)
+    : m_linesFound(other.m_linesFound),
+      m_linesHit(other.m_linesHit),
+      m_functionsFound(other.m_functionsFound),
+      m_functionsHit(other.m_functionsHit),
+      m_branchesFound(other.m_branchesFound),
+      m_branchesHit(other.m_branchesHit),
+      m_reportDate(other.m_reportDate)
+{
+}
+
+Coverage& Coverage::operator=(const Coverage &other)
+{
+    m_linesFound = other.m_linesFound;
+    m_linesHit = other.m_linesHit;
+    m_functionsFound = other.m_functionsFound;
+    m_functionsHit = other.m_functionsHit;
+    m_branchesFound = other.m_branchesFound;
+    m_branchesHit = other.m_branchesHit;
+    m_reportDate = other.m_reportDate;
+    return *this;
+}
+
+Coverage& Coverage::withLines(qint64 found, qint64 hit)
+{
+    m_linesFound = found;
+    m_linesHit = hit;
+    return *this;
+}
+
+Coverage& Coverage::withFunctions(qint64 found, qint64 hit)
+{
+    m_functionsFound = found;
+    m_functionsHit = hit;
+    return *this;
+}
+
+Coverage& Coverage::withBranches(qint64 found, qint64 hit)
+{
+    m_branchesFound = found;
+    m_branchesHit = hit;
+    return *this;
+}
+
+Coverage& Coverage::withReportDate(const QString &date)
+{
+    m_reportDate = date;
+    return *this;
+}
+
+qint64 Coverage::getLinesFound() const
+{
+    return m_linesFound;
+}
+
+qint64 Coverage::getLinesHit() const
+{
+    return m_linesHit;
+}
+
+qint64 Coverage::getFunctionsFound() const
+{
+    return m_functionsFound;
+}
+
+qint64 Coverage::getFunctionsHit() const
+{
+    return m_functionsHit;
+}
+
+qint64 Coverage::getBranchesFound() const
+{
+    return m_branchesFound;
+}
+
+qint64 Coverage::getBranchesHit() const
+{
+    return m_branchesHit;
+}
+
+QString Coverage::getReportDate() const
+{
+    return m_reportDate;
+}
+
+double Coverage::getLineRate() const
+{
+    return rate(m_linesFound, m_linesHit);
+}
+
+double Coverage::getFunctionRate() const
+{
+    return rate(m_functionsFound, m_functionsHit);
+}
+
+double Coverage::getBranchRate() const
+{
+    return rate(m_branchesFound, m_branchesHit);
+}
+
+bool Coverage::isEmpty() const
+{
+    return m_linesFound == 0 && m_functionsFound == 0 && m_branchesFound == 0;
+}
+
+} // namespace Model
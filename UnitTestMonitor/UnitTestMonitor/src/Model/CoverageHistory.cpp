@@ -0,0 +1,627 @@
+/**
+  * @file CoverageHistory.cpp
+  *
+  * @class Model::CoverageHistory
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Model element holding the per-file coverage of every run of a library in compact form.
+  * @details The history keeps one column per source file. A column holds an entry per run with
+  *          the headline numbers of the file and the offset of its record in the byte stream of
+  *          the column. A record stores the execution counts of the lines and functions as varints
+  *          and only those that changed since the previous record of the file, marked in a bitmap
+  *          of the lines and one of the functions; a run changing no count costs a few bytes.
+  *          Line numbers and function names are stored in keyframes only, written whenever they
+  *          change and every 64 records, so reading any run decodes at most 64 records of a file.
+  *          The coverage of a file over time is read from the entries without decoding anything.
+  *          Runs are appended in order of their timestamps, an older run rebuilds the history.
+  *          All data lives in implicitly shared Qt containers, copies of a history are cheap.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#include "Model/CoverageHistory.h"
+
+#include <QDataStream>
+#include <QtAlgorithms>
+
+namespace Model
+{
+
+namespace
+{
+
+// a record repeats line numbers and function names after this many delta records at the latest
+const int keyframeInterval = 64;
+
+const quint32 fileMagic = 0x55544d43; // "UTMC"
+const quint32 fileVersion = 1;
+
+enum RecordFlag
+{
+    KeyframeFlag = 0x01,
+    LineHitsChangedFlag = 0x02,
+    FunctionHitsChangedFlag = 0x04
+};
+
+void appendVarint(QByteArray &data, quint64 value)
+{
+    while (value >= 0x80)
+    {
+        data.append(char((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    data.append(char(value));
+}
+
+bool readVarint(const char *&data, const char *end, quint64 &value)
+{
+    value = 0;
+    for (int shift = 0; data < end && shift < 64; shift += 7)
+    {
+        quint8 byte = quint8(*data++);
+        value |= quint64(byte & 0x7f) << shift;
+        if (not (byte & 0x80))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+quint32 countHit(const QVector<qint64> &hits)
+{
+    quint32 result = 0;
+    foreach (qint64 count, hits)
+    {
+        result += count > 0 ? 1 : 0;
+    }
+    return result;
+}
+
+// appends a bitmap of the counts differing from the previous ones, then the new counts
+bool appendChangedHits(QByteArray &data, const QVector<qint64> &previous,
+                       const QVector<qint64> &current)
+{
+    QByteArray bitmap((current.size() + 7) / 8, '\0');
+    QByteArray counts;
+    for (int i = 0; i < current.size(); ++i)
+    {
+        if (current.at(i) != previous.at(i))
+        {
+            bitmap[i / 8] = char(bitmap.at(i / 8) | (1 << (i % 8)));
+            appendVarint(counts, quint64(qMax(Q_INT64_C(0), current.at(i))));
+        }
+    }
+    if (counts.isEmpty())
+    {
+        return false;
+    }
+    data.append(bitmap).append(counts);
+    return true;
+}
+
+bool readChangedHits(const char *&data, const char *end, QVector<qint64> &hits)
+{
+    int bitmapSize = (hits.size() + 7) / 8;
+    if (end - data < bitmapSize)
+    {
+        return false;
+    }
+    const char *bitmap = data;
+    data += bitmapSize;
+    for (int i = 0; i < hits.size(); ++i)
+    {
+        if (bitmap[i / 8] & (1 << (i % 8)))
+        {
+            quint64 count = 0;
+            if (not readVarint(data, end, count))
+            {
+                return false;
+            }
+            hits[i] = qint64(count);
+        }
+    }
+    return true;
+}
+
+bool readCounts(const char *&data, const char *end, int size, QVector<qint64> &counts)
+{
+    counts.resize(size);
+    for (int i = 0; i < size; ++i)
+    {
+        quint64 count = 0;
+        if (not readVarint(data, end, count))
+        {
+            return false;
+        }
+        counts[i] = qint64(count);
+    }
+    return true;
+}
+
+bool isBeforeByPath(const FileCoverage &left, const FileCoverage &right)
+{
+    return left.getPath() < right.getPath();
+}
+
+} // namespace
+
+CoverageHistory::CoverageHistory()
+{
+}
+
+CoverageHistory::CoverageHistory(const CoverageHistory &other)
+    : m_timestamps(other.m_timestamps),
+      m_columns(other.m_columns)
+{
+}
+
+CoverageHistory& CoverageHistory::operator=(const CoverageHistory &other)
+{
+    m_timestamps = other.m_timestamps;
+    m_columns = other.m_columns;
+    return *this;
+}
+
+bool CoverageHistory::addRun(qint64 timestamp, const QList<FileCoverage> &fileCoverages)
+{
+    if (fileCoverages.isEmpty() || containsRun(timestamp))
+    {
+        return false;
+    }
+    if (not m_timestamps.isEmpty() && timestamp < m_timestamps.last())
+    {
+        // records are deltas to the run before, an older run is put in place by rebuilding
+        QMap<qint64, QList<FileCoverage> > runs;
+        foreach (qint64 runTimestamp, m_timestamps)
+        {
+            runs.insert(runTimestamp, getFileCoverages(runTimestamp));
+        }
+        runs.insert(timestamp, fileCoverages);
+        m_timestamps.clear();
+        m_columns.clear();
+        for (QMap<qint64, QList<FileCoverage> >::const_iterator it = runs.constBegin();
+             it != runs.constEnd(); ++it)
+        {
+            addRun(it.key(), it.value());
+        }
+        return true;
+    }
+
+    qint32 run = m_timestamps.size();
+    m_timestamps.append(timestamp);
+    QList<FileCoverage> sorted = fileCoverages;
+    qStableSort(sorted.begin(), sorted.end(), isBeforeByPath);
+    QString previousPath;
+    for (int i = 0; i < sorted.size(); ++i)
+    {
+        const FileCoverage &fileCoverage = sorted.at(i);
+        if (i > 0 && fileCoverage.getPath() == previousPath)
+        {
+            continue;
+        }
+        previousPath = fileCoverage.getPath();
+        appendRecord(m_columns[previousPath], run, fileCoverage);
+    }
+    return true;
+}
+
+void CoverageHistory::appendRecord(Column &column, qint32 run, const FileCoverage &fileCoverage)
+{
+    const QVector<qint64> lines = fileCoverage.getLines();
+    const QVector<qint64> lineHits = fileCoverage.getLineHits();
+    const QStringList functionNames = fileCoverage.getFunctionNames();
+    const QVector<qint64> functionHits = fileCoverage.getFunctionHits();
+
+    Entry entry;
+    entry.run = run;
+    entry.offset = column.data.size();
+    entry.linesFound = lines.size();
+    entry.linesHit = countHit(lineHits);
+    entry.functionsFound = functionNames.size();
+    entry.functionsHit = countHit(functionHits);
+    entry.branchesFound = quint32(fileCoverage.getBranchesFound());
+    entry.branchesHit = quint32(fileCoverage.getBranchesHit());
+
+    FileCoverage previous;
+    int lastKeyframe = -1;
+    for (int i = column.entries.size() - 1; i >= 0 && lastKeyframe < 0; --i)
+    {
+        lastKeyframe = column.entries.at(i).keyframe ? i : -1;
+    }
+    entry.keyframe = column.entries.isEmpty() || lastKeyframe < 0 ||
+            column.entries.size() - lastKeyframe >= keyframeInterval ||
+            not decode(QString(), column, column.entries.size() - 1, previous) ||
+            previous.getLines() != lines || previous.getFunctionNames() != functionNames;
+
+    QByteArray record;
+    if (entry.keyframe)
+    {
+        record.append(char(KeyframeFlag));
+        appendVarint(record, lines.size());
+        qint64 previousLine = 0;
+        foreach (qint64 line, lines)
+        {
+            appendVarint(record, quint64(line - previousLine));
+            previousLine = line;
+        }
+        foreach (qint64 count, lineHits)
+        {
+            appendVarint(record, quint64(qMax(Q_INT64_C(0), count)));
+        }
+        appendVarint(record, functionNames.size());
+        foreach (const QString &name, functionNames)
+        {
+            QByteArray utf8 = name.toUtf8();
+            appendVarint(record, utf8.size());
+            record.append(utf8);
+        }
+        foreach (qint64 count, functionHits)
+        {
+            appendVarint(record, quint64(qMax(Q_INT64_C(0), count)));
+        }
+    }
+    else
+    {
+        record.append('\0');
+        char flags = 0;
+        if (appendChangedHits(record, previous.getLineHits(), lineHits))
+        {
+            flags |= LineHitsChangedFlag;
+        }
+        if (appendChangedHits(record, previous.getFunctionHits(), functionHits))
+        {
+            flags |= FunctionHitsChangedFlag;
+        }
+        record[0] = flags;
+    }
+    appendVarint(record, entry.branchesFound);
+    appendVarint(record, entry.branchesHit);
+
+    column.data.append(record);
+    column.entries.append(entry);
+}
+
+bool CoverageHistory::containsRun(qint64 timestamp) const
+{
+    return qBinaryFind(m_timestamps.constBegin(), m_timestamps.constEnd(), timestamp)
+            != m_timestamps.constEnd();
+}
+
+QList<qint64> CoverageHistory::getTimestamps() const
+{
+    return m_timestamps.toList();
+}
+
+QStringList CoverageHistory::getPaths() const
+{
+    return m_columns.keys();
+}
+
+int CoverageHistory::findEntry(const Column &column, qint32 run)
+{
+    int low = 0;
+    int high = column.entries.size() - 1;
+    while (low <= high)
+    {
+        int middle = (low + high) / 2;
+        qint32 middleRun = column.entries.at(middle).run;
+        if (middleRun == run)
+        {
+            return middle;
+        }
+        if (middleRun < run)
+        {
+            low = middle + 1;
+        }
+        else
+        {
+            high = middle - 1;
+        }
+    }
+    return -1;
+}
+
+QList<FileCoverage> CoverageHistory::getFileCoverages(qint64 timestamp) const
+{
+    QList<FileCoverage> result;
+    QVector<qint64>::const_iterator found =
+            qBinaryFind(m_timestamps.constBegin(), m_timestamps.constEnd(), timestamp);
+    if (found == m_timestamps.constEnd())
+    {
+        return result;
+    }
+    qint32 run = found - m_timestamps.constBegin();
+    // columns are ordered by path, so are the results
+    for (QMap<QString, Column>::const_iterator it = m_columns.constBegin();
+         it != m_columns.constEnd(); ++it)
+    {
+        int entryIndex = findEntry(it.value(), run);
+        FileCoverage fileCoverage;
+        if (entryIndex >= 0 && decode(it.key(), it.value(), entryIndex, fileCoverage))
+        {
+            result.append(fileCoverage);
+        }
+    }
+    return result;
+}
+
+FileCoverage CoverageHistory::getFileCoverage(const QString &path, qint64 timestamp) const
+{
+    FileCoverage result;
+    QVector<qint64>::const_iterator found =
+            qBinaryFind(m_timestamps.constBegin(), m_timestamps.constEnd(), timestamp);
+    if (found == m_timestamps.constEnd() || not m_columns.contains(path))
+    {
+        return result;
+    }
+    const Column &column = m_columns[path];
+    int entryIndex = findEntry(column, found - m_timestamps.constBegin());
+    if (entryIndex < 0 || not decode(path, column, entryIndex, result))
+    {
+        result = FileCoverage();
+    }
+    return result;
+}
+
+QMap<qint64, Coverage> CoverageHistory::getFileHistory(const QString &path) const
+{
+    QMap<qint64, Coverage> result;
+    if (not m_columns.contains(path))
+    {
+        return result;
+    }
+    foreach (const Entry &entry, m_columns[path].entries)
+    {
+        result.insert(m_timestamps.at(entry.run), toCoverage(entry));
+    }
+    return result;
+}
+
+QMap<qint64, FileCoverage> CoverageHistory::getFileTimeline(const QString &path) const
+{
+    QMap<qint64, FileCoverage> result;
+    if (not m_columns.contains(path))
+    {
+        return result;
+    }
+    // one pass over the records, every record builds on the one decoded before
+    const Column &column = m_columns[path];
+    const char *end = column.data.constData() + column.data.size();
+    FileCoverage fileCoverage;
+    fileCoverage.withPath(path);
+    foreach (const Entry &entry, column.entries)
+    {
+        const char *record = column.data.constData() + entry.offset;
+        if (not decodeRecord(record, end, entry.keyframe, fileCoverage))
+        {
+            break;
+        }
+        result.insert(m_timestamps.at(entry.run), fileCoverage);
+    }
+    return result;
+}
+
+bool CoverageHistory::decode(const QString &path, const Column &column, int entryIndex,
+                             FileCoverage &fileCoverage)
+{
+    if (entryIndex < 0 || entryIndex >= column.entries.size())
+    {
+        return false;
+    }
+    int first = entryIndex;
+    while (first > 0 && not column.entries.at(first).keyframe)
+    {
+        --first;
+    }
+    if (not column.entries.at(first).keyframe)
+    {
+        return false;
+    }
+    fileCoverage = FileCoverage();
+    fileCoverage.withPath(path);
+    const char *end = column.data.constData() + column.data.size();
+    for (int i = first; i <= entryIndex; ++i)
+    {
+        const Entry &entry = column.entries.at(i);
+        const char *record = column.data.constData() + entry.offset;
+        if (not decodeRecord(record, end, entry.keyframe, fileCoverage))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool CoverageHistory::decodeRecord(const char *&data, const char *end, bool keyframe,
+                                   FileCoverage &fileCoverage)
+{
+    if (data >= end)
+    {
+        return false;
+    }
+    quint8 flags = quint8(*data++);
+    if (bool(flags & KeyframeFlag) != keyframe)
+    {
+        return false;
+    }
+    quint64 value = 0;
+    if (keyframe)
+    {
+        if (not readVarint(data, end, value) || value > quint64(end - data))
+        {
+            return false;
+        }
+        QVector<qint64> lines(int(value));
+        qint64 line = 0;
+        for (int i = 0; i < lines.size(); ++i)
+        {
+            if (not readVarint(data, end, value))
+            {
+                return false;
+            }
+            line += qint64(value);
+            lines[i] = line;
+        }
+        QVector<qint64> lineHits;
+        if (not readCounts(data, end, lines.size(), lineHits) ||
+                not readVarint(data, end, value) || value > quint64(end - data))
+        {
+            return false;
+        }
+        QStringList functionNames;
+        int functionCount = int(value);
+        for (int i = 0; i < functionCount; ++i)
+        {
+            if (not readVarint(data, end, value) || value > quint64(end - data))
+            {
+                return false;
+            }
+            functionNames.append(QString::fromUtf8(data, int(value)));
+            data += value;
+        }
+        QVector<qint64> functionHits;
+        if (not readCounts(data, end, functionCount, functionHits))
+        {
+            return false;
+        }
+        fileCoverage.withLines(lines, lineHits).withFunctions(functionNames, functionHits);
+    }
+    else
+    {
+        if (flags & LineHitsChangedFlag)
+        {
+            QVector<qint64> lineHits = fileCoverage.getLineHits();
+            if (not readChangedHits(data, end, lineHits))
+            {
+                return false;
+            }
+            fileCoverage.withLines(fileCoverage.getLines(), lineHits);
+        }
+        if (flags & FunctionHitsChangedFlag)
+        {
+            QVector<qint64> functionHits = fileCoverage.getFunctionHits();
+            if (not readChangedHits(data, end, functionHits))
+            {
+                return false;
+            }
+            fileCoverage.withFunctions(fileCoverage.getFunctionNames(), functionHits);
+        }
+    }
+    quint64 branchesFound = 0;
+    quint64 branchesHit = 0;
+    if (not readVarint(data, end, branchesFound) || not readVarint(data, end, branchesHit))
+    {
+        return false;
+    }
+    fileCoverage.withBranches(qint64(branchesFound), qint64(branchesHit));
+    return true;
+}
+
+Coverage CoverageHistory::toCoverage(const Entry &entry)
+{
+    Coverage result;
+    result.withLines(entry.linesFound, entry.linesHit)
+            .withFunctions(entry.functionsFound, entry.functionsHit)
+            .withBranches(entry.branchesFound, entry.branchesHit);
+    return result;
+}
+
+bool CoverageHistory::isEmpty() const
+{
+    return m_timestamps.isEmpty();
+}
+
+void CoverageHistory::write(QDataStream &stream) const
+{
+    stream << m_timestamps;
+    stream << qint32(m_columns.size());
+    for (QMap<QString, Column>::const_iterator it = m_columns.constBegin();
+         it != m_columns.constEnd(); ++it)
+    {
+        stream << it.key() << qint32(it.value().entries.size());
+        foreach (const Entry &entry, it.value().entries)
+        {
+            stream << entry.run << entry.offset << entry.keyframe
+                   << entry.linesFound << entry.linesHit
+                   << entry.functionsFound << entry.functionsHit
+                   << entry.branchesFound << entry.branchesHit;
+        }
+        stream << it.value().data;
+    }
+}
+
+bool CoverageHistory::read(QDataStream &stream)
+{
+    m_timestamps.clear();
+    m_columns.clear();
+    QVector<qint64> timestamps;
+    QMap<QString, Column> columns;
+    qint32 columnCount = 0;
+    stream >> timestamps >> columnCount;
+    for (qint32 c = 0; c < columnCount && stream.status() == QDataStream::Ok; ++c)
+    {
+        QString path;
+        qint32 entryCount = 0;
+        stream >> path >> entryCount;
+        Column column;
+        for (qint32 e = 0; e < entryCount && stream.status() == QDataStream::Ok; ++e)
+        {
+            Entry entry;
+            stream >> entry.run >> entry.offset >> entry.keyframe
+                   >> entry.linesFound >> entry.linesHit
+                   >> entry.functionsFound >> entry.functionsHit
+                   >> entry.branchesFound >> entry.branchesHit;
+            column.entries.append(entry);
+        }
+        stream >> column.data;
+        // records are only decoded within their column, offsets and runs must stay in range
+        for (int e = 0; e < column.entries.size(); ++e)
+        {
+            const Entry &entry = column.entries.at(e);
+            if (entry.run < 0 || entry.run >= timestamps.size() ||
+                    entry.offset < 0 || entry.offset >= column.data.size() ||
+                    (e == 0 && not entry.keyframe) ||
+                    (e > 0 && entry.run <= column.entries.at(e - 1).run))
+            {
+                return false;
+            }
+        }
+        columns.insert(path, column);
+    }
+    if (stream.status() != QDataStream::Ok)
+    {
+        return false;
+    }
+    m_timestamps = timestamps;
+    m_columns = columns;
+    return true;
+}
+
+QString CoverageHistory::getFileName(const QString &monitorSetFileName)
+{
+    QString baseName = monitorSetFileName;
+    if (baseName.endsWith(".utm"))
+    {
+        baseName.chop(4);
+    }
+    return baseName + ".utmcov";
+}
+
+void CoverageHistory::writeFileHeader(QDataStream &stream)
+{
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << fileMagic << fileVersion;
+}
+
+bool CoverageHistory::readFileHeader(QDataStream &stream)
+{
+    stream.setVersion(QDataStream::Qt_5_0);
+    quint32 magic = 0;
+    quint32 version = 0;
+    stream >> magic >> version;
+    return stream.status() == QDataStream::Ok && magic == fileMagic && version == fileVersion;
+}
+
+} // namespace Model
@@ -0,0 +1,153 @@
+/**
+  * @file FileCoverage.cpp
+  *
+  * @class Model::FileCoverage
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Model element holding the line and function coverage of one source file.
+  * @details The instrumented lines are kept in ascending order with the execution count of each
+  *          line at the same index, the functions in ascending order of their names the same way.
+  *          Sorted arrays let viewers look up a line by binary search and let comparisons walk two
+  *          files side by side.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#include "Model/FileCoverage.h"
+
+#include <QtAlgorithms>
+
+namespace Model
+{
+
+namespace
+{
+
+qint64 countHit(const QVector<qint64> &hits)
+{
+    qint64 result = 0;
+    foreach (qint64 count, hits)
+    {
+        result += count > 0 ? 1 : 0;
+    }
+    return result;
+}
+
+} // namespace
+
+FileCoverage::FileCoverage()
+    : m_branchesFound(0),
+      m_branchesHit(0)
+{
+}
+
+FileCoverage::FileCoverage(const FileCoverage &other)
+    : m_path(other.m_path),
+      m_lines(other.m_lines),
+      m_lineHits(other.m_lineHits),
+      m_functionNames(other.m_functionNames),
+      m_functionHits(other.m_functionHits),
+      m_branchesFound(other.m_branchesFound),
+      m_branchesHit(other.m_branchesHit)
+{
+}
+
+FileCoverage& FileCoverage::operator=(const FileCoverage &other)
+{
+    m_path = other.m_path;
+    m_lines = other.m_lines;
+    m_lineHits = other.m_lineHits;
+    m_functionNames = other.m_functionNames;
+    m_functionHits = other.m_functionHits;
+    m_branchesFound = other.m_branchesFound;
+    m_branchesHit = other.m_branchesHit;
+    return *this;
+}
+
+FileCoverage& FileCoverage::withPath(const QString &path)
+{
+    m_path = path;
+    return *this;
+}
+
+FileCoverage& FileCoverage::withLines(const QVector<qint64> &lines, const QVector<qint64> &hits)
+{
+    m_lines = lines;
+    m_lineHits = hits;
+    m_lineHits.resize(lines.size());
+    return *this;
+}
+
+FileCoverage& FileCoverage::withFunctions(const QStringList &names, const QVector<qint64> &hits)
+{
+    m_functionNames = names;
+    m_functionHits = hits;
+    m_functionHits.resize(names.size());
+    return *this;
+}
+
+FileCoverage& FileCoverage::withBranches(qint64 found, qint64 hit)
+{
+    m_branchesFound = found;
+    m_branchesHit = hit;
+    return *this;
+}
+
+QString FileCoverage::getPath() const
+{
+    return m_path;
+}
+
+QVector<qint64> FileCoverage::getLines() const
+{
+    return m_lines;
+}
+
+QVector<qint64> FileCoverage::getLineHits() const
+{
+    return m_lineHits;
+}
+
+QStringList FileCoverage::getFunctionNames() const
+{
+    return m_functionNames;
+}
+
+QVector<qint64> FileCoverage::getFunctionHits() const
+{
+    return m_functionHits;
+}
+
+qint64 FileCoverage::getLinesHit() const
+{
+    return countHit(m_lineHits);
+}
+
+qint64 FileCoverage::getFunctionsHit() const
+{
+    return countHit(m_functionHits);
+}
+
+qint64 FileCoverage::getBranchesFound() const
+{
+    return m_branchesFound;
+}
+
+qint64 FileCoverage::getBranchesHit() const
+{
+    return m_branchesHit;
+}
+
+qint64 FileCoverage::getHits(qint64 line) const
+{
+    QVector<qint64>::const_iterator it = qBinaryFind(m_lines.constBegin(), m_lines.constEnd(),
+                                                     line);
+    if (it == m_lines.constEnd())
+    {
+        return -1;
+    }
+    return m_lineHits.at(it - m_lines.constBegin());
+}
+
+} // namespace Model
@@ -0,0 +1,121 @@
+/**
+  * @file Fingerprint.cpp
+  *
+  * @class Model::Fingerprint
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Model element identifying the state of a scanned file.
+  * @details A fingerprint is the modification time, the size, and optionally a content hash of a
+  *          tlog or lcov file as seen by the last scan.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#include "Model/Fingerprint.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+
+namespace Model
+{
+
+Fingerprint::Fingerprint()
+    : m_modified(-1),
+      m_size(-1)
+{
+}
+
+Fingerprint::Fingerprint(const Fingerprint &other)
+    : m_modified(other.m_modified),
+      m_size(other.m_size),
+      m_hash(other.m_hash)
+{
+}
+
+Fingerprint& Fingerprint::operator=(const Fingerprint &other)
+{
+    m_modified = other.m_modified;
+    m_size = other.m_size;
+    m_hash = other.m_hash;
+    return *this;
+}
+
+Fingerprint Fingerprint::fromFileInfo(const QFileInfo &fileInfo)
+{
+    Fingerprint result;
+    if (fileInfo.exists())
+    {
+        result.withModified(fileInfo.lastModified().toMSecsSinceEpoch())
+                .withSize(fileInfo.size());
+    }
+    return result;
+}
+
+QByteArray Fingerprint::hashFile(const QString &filePath)
+{
+    QFile file(filePath);
+    if (not file.open(QIODevice::ReadOnly))
+    {
+        return QByteArray();
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    while (not file.atEnd())
+    {
+        hash.addData(file.read(64 * 1024));
+    }
+    return hash.result().toHex();
+}
+
+Fingerprint& Fingerprint::withModified(const qint64 modified)
+{
+    m_modified = modified;
+    return *this;
+}
+
+Fingerprint& Fingerprint::withSize(const qint64 size)
+{
+    m_size = size;
+    return *this;
+}
+
+Fingerprint& Fingerprint::withHash(const QByteArray &hash)
+{
+    m_hash = hash;
+    return *this;
+}
+
+qint64 Fingerprint::getModified() const
+{
+    return m_modified;
+}
+
+qint64 Fingerprint::getSize() const
+{
+    return m_size;
+}
+
+QByteArray Fingerprint::getHash() const
+{
+    return m_hash;
+}
+
+bool Fingerprint::isEmpty() const
+{
+    return m_modified < 0 || m_size < 0;
+}
+
+bool Fingerprint::hasSameMetaData(const Fingerprint &other) const
+{
+    return not isEmpty() && m_modified == other.m_modified && m_size == other.m_size;
+}
+
+bool Fingerprint::hasSameHash(const Fingerprint &other) const
+{
+    return not m_hash.isEmpty() && m_size == other.m_size && m_hash == other.m_hash;
+}
+
+} // namespace Model
@@ -7,7 +7,9 @@
   * @license LGPL v2.1
   *
   * @brief Model element representing a library folder within a project.
-  * @details A library has a collection of testcases.
+  * @details A library has a collection of testcases and the coverage of its lcov tracefile per
+  *          testrun, keyed on the modification time of the tracefile. The coverage of every
+  *          source file per testrun is kept in the library's CoverageHistory.
   *
   * @author Robert Wloch, robert@rowlo.de
   *************************************************************************************************/
@@ -26,6 +28,13 @@ Library::Library(const Library &other)
     : m_path(other.m_path),
       m_name(other.m_name),
       m_lcovPath(other.m_lcovPath),
+      m_tlogPath(other.m_tlogPath),
+      m_infoPath(other.m_infoPath),
+      m_tlogFingerprint(other.m_tlogFingerprint),
+      m_lcovFingerprint(other.m_lcovFingerprint),
+      m_infoFingerprint(other.m_infoFingerprint),
+      m_coverages(other.m_coverages),
+      m_coverageHistory(other.m_coverageHistory),
       m_testcases(other.m_testcases)
 {
 }
@@ -63,6 +72,100 @@ QString Library::getLcovPath() const
     return m_lcovPath;
 }
 
+Library& Library::withTlogPath(const QString &path)
+{
+    m_tlogPath = path;
+    return *this;
+}
+
+QString Library::getTlogPath() const
+{
+    return m_tlogPath;
+}
+
+Library& Library::withInfoPath(const QString &path)
+{
+    m_infoPath = path;
+    return *this;
+}
+
+QString Library::getInfoPath() const
+{
+    return m_infoPath;
+}
+
+Library& Library::withTlogFingerprint(const Fingerprint &fingerprint)
+{
+    m_tlogFingerprint = fingerprint;
+    return *this;
+}
+
+Library& Library::withLcovFingerprint(const Fingerprint &fingerprint)
+{
+    m_lcovFingerprint = fingerprint;
+    return *this;
+}
+
+Fingerprint Library::getTlogFingerprint() const
+{
+    return m_tlogFingerprint;
+}
+
+Fingerprint Library::getLcovFingerprint() const
+{
+    return m_lcovFingerprint;
+}
+
+Library& Library::withInfoFingerprint(const Fingerprint &fingerprint)
+{
+    m_infoFingerprint = fingerprint;
+    return *this;
+}
+
+Fingerprint Library::getInfoFingerprint() const
+{
+    return m_infoFingerprint;
+}
+
+void Library::addCoverage(qint64 timestamp, const Coverage &coverage)
+{
+    if (not coverage.isEmpty())
+    {
+        m_coverages.insert(timestamp, coverage);
+    }
+}
+
+QMap<qint64, Coverage> Library::getCoverages() const
+{
+    return m_coverages;
+}
+
+void Library::addFileCoverages(qint64 timestamp, const QList<FileCoverage> &fileCoverages)
+{
+    m_coverageHistory.addRun(timestamp, fileCoverages);
+}
+
+QList<FileCoverage> Library::getFileCoverages(qint64 timestamp) const
+{
+    return m_coverageHistory.getFileCoverages(timestamp);
+}
+
+QList<qint64> Library::getFileCoverageTimestamps() const
+{
+    return m_coverageHistory.getTimestamps();
+}
+
+Library& Library::withCoverageHistory(const CoverageHistory &history)
+{
+    m_coverageHistory = history;
+    return *this;
+}
+
+CoverageHistory Library::getCoverageHistory() const
+{
+    return m_coverageHistory;
+}
+
 QSharedPointer<Testcase> Library::getTestcase(const QString &name) const
 {
     QSharedPointer<Testcase> result;
@@ -7,7 +7,10 @@
   * @license LGPL v2.1
   *
   * @brief Model element representing a testcase class of a library.
-  * @details A testcase has a collection of testruns.
+  * @details A testcase has a collection of testruns. The names of its test functions are interned
+  *          once per testcase, testruns refer to them by id. The source location of a function does
+  *          not change between testruns and is kept once per testcase. A testrun whose tlog segment
+  *          hash equals the one of the testrun before it is a repeat and not worth keeping.
   *
   * @author Robert Wloch, robert@rowlo.de
   *************************************************************************************************/
@@ -25,7 +28,10 @@ Testcase::Testcase(const Testcase &other)
       m_name(other.m_name),
       m_tlogStartLine(other.m_tlogStartLine),
       m_tlogEndLine(other.m_tlogEndLine),
-      m_testruns(other.m_testruns)
+      m_testruns(other.m_testruns),
+      m_functionNames(other.m_functionNames),
+      m_functionIds(other.m_functionIds),
+      m_functionLocations(other.m_functionLocations)
 {
 }
 
@@ -103,4 +109,113 @@ int Testcase::getTestrunsCount() const
     return m_testruns.size();
 }
 
+bool Testcase::isRepeatedTestrun(const QSharedPointer<Testrun> &testrun) const
+{
+    if (testrun.isNull() || testrun->getSegmentHash().isEmpty())
+    {
+        return false;
+    }
+    // the testrun right before the given one, which need not be added yet
+    QMap<qint64, QSharedPointer<Testrun> >::const_iterator it =
+            m_testruns.lowerBound(testrun->getTimestamp());
+    if (it == m_testruns.constBegin())
+    {
+        return false;
+    }
+    --it;
+    return it.value()->getSegmentHash() == testrun->getSegmentHash();
+}
+
+int Testcase::internFunction(const QString &key)
+{
+    QHash<QString, int>::const_iterator it = m_functionIds.constFind(key);
+    if (it != m_functionIds.constEnd())
+    {
+        return it.value();
+    }
+    int functionId = m_functionNames.size();
+    m_functionNames.append(key);
+    m_functionIds.insert(key, functionId);
+    return functionId;
+}
+
+int Testcase::getFunctionId(const QString &key) const
+{
+    return m_functionIds.value(key, -1);
+}
+
+QStringList Testcase::getFunctionNames() const
+{
+    return m_functionNames;
+}
+
+Testcase& Testcase::withFunctionLocation(const int functionId, const QString &file,
+                                         const int line)
+{
+    if (functionId >= 0 && not file.isEmpty())
+    {
+        m_functionLocations.insert(functionId, QPair<QString, int>(file, line));
+    }
+    return *this;
+}
+
+QPair<QString, int> Testcase::getFunctionLocation(const int functionId) const
+{
+    return m_functionLocations.value(functionId);
+}
+
+QMap<int, QPair<QString, int> > Testcase::getFunctionLocations() const
+{
+    return m_functionLocations;
+}
+
+void Testcase::recordTestfunction(const QSharedPointer<Testrun> &testrun,
+                                  const Testfunction &testfunction)
+{
+    if (testrun.isNull() || testfunction.getName().isEmpty())
+    {
+        return;
+    }
+    int functionId = internFunction(testfunction.getKey());
+    Testfunction::State state = testfunction.getState();
+    testrun->withFunctionState(functionId, state)
+            .withFunctionDuration(functionId, testfunction.getDuration());
+    withFunctionLocation(functionId, testfunction.getFile(), testfunction.getLine());
+}
+
+void Testcase::recordBenchmarkResult(const QSharedPointer<Testrun> &testrun, const QString &key,
+                                     const BenchmarkResult &result)
+{
+    if (testrun.isNull() || key.isEmpty())
+    {
+        return;
+    }
+    testrun->withBenchmarkResult(internFunction(key), result);
+}
+
+QList<Testfunction> Testcase::getTestfunctions(const QSharedPointer<Testrun> &testrun) const
+{
+    QList<Testfunction> result;
+    if (testrun.isNull())
+    {
+        return result;
+    }
+    for (int functionId = 0; functionId < m_functionNames.size(); ++functionId)
+    {
+        Testfunction::State state = testrun->getFunctionState(functionId);
+        if (state == Testfunction::NotRun)
+        {
+            continue;
+        }
+        QPair<QString, int> location = getFunctionLocation(functionId);
+        Testfunction testfunction;
+        testfunction.withName(m_functionNames.at(functionId))
+                .withIncident(Testfunction::incidentFromState(state))
+                .withLocation(location.first, location.second)
+                .withDuration(testrun->getFunctionDuration(functionId));
+        result.append(testfunction);
+    }
+    return result;
+}
+
 } // namespace Model
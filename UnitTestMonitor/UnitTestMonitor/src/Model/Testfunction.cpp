@@ -0,0 +1,193 @@
+/**
+  * @file Testfunction.cpp
+  *
+  * @class Model::Testfunction
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Model element representing the result of a test function within a testrun.
+  * @details A test function result is the incident of one test function or data row, its source
+  *          location and the duration of the test function. Testruns store only the state byte of
+  *          an incident, this class is the expanded form handed between parsers, model, and view.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#include "Model/Testfunction.h"
+
+namespace Model
+{
+
+Testfunction::Testfunction()
+    : m_line(0),
+      m_duration(-1.0)
+{
+}
+
+Testfunction::Testfunction(const Testfunction &other)
+    : m_name(other.m_name),
+      m_dataTag(other.m_dataTag),
+      m_incident(other.m_incident),
+      m_file(other.m_file),
+      m_line(other.m_line),
+      m_duration(other.m_duration)
+{
+}
+
+Testfunction& Testfunction::operator=(const Testfunction &other)
+{
+    m_name = other.m_name;
+    m_dataTag = other.m_dataTag;
+    m_incident = other.m_incident;
+    m_file = other.m_file;
+    m_line = other.m_line;
+    m_duration = other.m_duration;
+    return *this;
+}
+
+Testfunction& Testfunction::withName(const QString &name)
+{
+    m_name = name;
+    return *this;
+}
+
+Testfunction& Testfunction::withDataTag(const QString &dataTag)
+{
+    m_dataTag = dataTag;
+    return *this;
+}
+
+Testfunction& Testfunction::withIncident(const QString &incident)
+{
+    m_incident = incident;
+    return *this;
+}
+
+Testfunction& Testfunction::withLocation(const QString &file, const int line)
+{
+    m_file = file;
+    m_line = line;
+    return *this;
+}
+
+Testfunction& Testfunction::withDuration(const double msecs)
+{
+    m_duration = msecs;
+    return *this;
+}
+
+QString Testfunction::getName() const
+{
+    return m_name;
+}
+
+QString Testfunction::getDataTag() const
+{
+    return m_dataTag;
+}
+
+QString Testfunction::getIncident() const
+{
+    return m_incident;
+}
+
+QString Testfunction::getFile() const
+{
+    return m_file;
+}
+
+int Testfunction::getLine() const
+{
+    return m_line;
+}
+
+double Testfunction::getDuration() const
+{
+    return m_duration;
+}
+
+QString Testfunction::getKey() const
+{
+    if (m_dataTag.isEmpty())
+    {
+        return m_name;
+    }
+    return QString("%1(%2)").arg(m_name).arg(m_dataTag);
+}
+
+Testfunction::State Testfunction::getState() const
+{
+    return stateFromIncident(m_incident);
+}
+
+Testfunction::State Testfunction::stateFromIncident(const QString &incident)
+{
+    // incident types of testlib xml, the plain text labels are mapped to them by the parser
+    if (incident == "pass")
+    {
+        return Passed;
+    }
+    if (incident == "fail")
+    {
+        return Failed;
+    }
+    if (incident == "skip")
+    {
+        return Skipped;
+    }
+    if (incident == "xfail")
+    {
+        return ExpectedFailure;
+    }
+    if (incident == "xpass")
+    {
+        return UnexpectedPass;
+    }
+    if (incident == "bpass")
+    {
+        return BlacklistedPass;
+    }
+    if (incident == "bfail")
+    {
+        return BlacklistedFail;
+    }
+    if (incident == "bxfail")
+    {
+        return BlacklistedExpectedFailure;
+    }
+    if (incident == "bxpass")
+    {
+        return BlacklistedUnexpectedPass;
+    }
+    return NotRun;
+}
+
+QString Testfunction::incidentFromState(const State state)
+{
+    switch (state)
+    {
+    case Passed:
+        return "pass";
+    case Failed:
+        return "fail";
+    case Skipped:
+        return "skip";
+    case ExpectedFailure:
+        return "xfail";
+    case UnexpectedPass:
+        return "xpass";
+    case BlacklistedPass:
+        return "bpass";
+    case BlacklistedFail:
+        return "bfail";
+    case BlacklistedExpectedFailure:
+        return "bxfail";
+    case BlacklistedUnexpectedPass:
+        return "bxpass";
+    default:
+        break;
+    }
+    return QString();
+}
+
+} // namespace Model
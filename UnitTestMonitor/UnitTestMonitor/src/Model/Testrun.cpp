@@ -7,7 +7,13 @@
   * @license LGPL v2.1
   *
   * @brief Model element representing a testrun of a testcase.
-  * @details A testrun is a quadrupel of timestamp, passed, failed, and skipped tests.
+  * @details A testrun is a quadrupel of timestamp, passed, failed, and skipped tests. Test function
+  *          results are kept as one state byte and one float duration per function id of the
+  *          testcase, QBENCHMARK results only for the benchmark functions. The segment hash
+  *          identifies the tlog content the testrun was parsed from, so a tlog that is merely
+  *          touched does not add a repeated testrun. A testrun in progress is the state of a
+  *          testcase whose tlog is still being written, it is aborted once the tlog stops growing
+  *          before the testcase's totals are written.
   *
   * @author Robert Wloch, robert@rowlo.de
   *************************************************************************************************/
@@ -17,6 +23,9 @@ namespace Model
 {
 
 Testrun::Testrun()
+    : m_duration(-1.0),
+      m_inProgress(false),
+      m_aborted(false)
 {
 }
 
@@ -25,7 +34,14 @@ Testrun::Testrun(const Testrun &other)
       m_passed(other.m_passed),
       m_failed(other.m_failed),
       m_skipped(other.m_skipped),
-      m_failLogs(other.m_failLogs)
+      m_failLogs(other.m_failLogs),
+      m_duration(other.m_duration),
+      m_functionStates(other.m_functionStates),
+      m_functionDurations(other.m_functionDurations),
+      m_benchmarkResults(other.m_benchmarkResults),
+      m_segmentHash(other.m_segmentHash),
+      m_inProgress(other.m_inProgress),
+      m_aborted(other.m_aborted)
 {
 }
 
@@ -52,6 +68,79 @@ Testrun& Testrun::withFailLog(const QString &failLog)
     return *this;
 }
 
+Testrun& Testrun::withDuration(const double msecs)
+{
+    m_duration = msecs;
+    return *this;
+}
+
+Testrun& Testrun::withFunctionState(const int functionId, const Testfunction::State state)
+{
+    if (functionId >= 0)
+    {
+        if (functionId >= m_functionStates.size())
+        {
+            m_functionStates.append(QByteArray(functionId + 1 - m_functionStates.size(),
+                                               static_cast<char>(Testfunction::NotRun)));
+        }
+        m_functionStates[functionId] = static_cast<char>(state);
+    }
+    return *this;
+}
+
+Testrun& Testrun::withFunctionStates(const QByteArray &states)
+{
+    m_functionStates = states;
+    return *this;
+}
+
+Testrun& Testrun::withFunctionDuration(const int functionId, const double msecs)
+{
+    if (functionId >= 0 && msecs >= 0.0)
+    {
+        if (functionId >= m_functionDurations.size())
+        {
+            m_functionDurations.insert(m_functionDurations.size(),
+                                       functionId + 1 - m_functionDurations.size(), -1.0f);
+        }
+        m_functionDurations[functionId] = static_cast<float>(msecs);
+    }
+    return *this;
+}
+
+Testrun& Testrun::withFunctionDurations(const QVector<float> &durations)
+{
+    m_functionDurations = durations;
+    return *this;
+}
+
+Testrun& Testrun::withBenchmarkResult(const int functionId, const BenchmarkResult &result)
+{
+    if (functionId >= 0 && not result.isEmpty())
+    {
+        m_benchmarkResults.insert(functionId, result);
+    }
+    return *this;
+}
+
+Testrun& Testrun::withSegmentHash(const QByteArray &segmentHash)
+{
+    m_segmentHash = segmentHash;
+    return *this;
+}
+
+Testrun& Testrun::withInProgress(const bool inProgress)
+{
+    m_inProgress = inProgress;
+    return *this;
+}
+
+Testrun& Testrun::withAborted(const bool aborted)
+{
+    m_aborted = aborted;
+    return *this;
+}
+
 qint64 Testrun::getTimestamp() const
 {
     return m_timestamp;
@@ -77,4 +166,58 @@ QList<QString> Testrun::getFailLogs() const
     return m_failLogs;
 }
 
+double Testrun::getDuration() const
+{
+    return m_duration;
+}
+
+Testfunction::State Testrun::getFunctionState(const int functionId) const
+{
+    if (functionId < 0 || functionId >= m_functionStates.size())
+    {
+        return Testfunction::NotRun;
+    }
+    return static_cast<Testfunction::State>(static_cast<uchar>(m_functionStates.at(functionId)));
+}
+
+QByteArray Testrun::getFunctionStates() const
+{
+    return m_functionStates;
+}
+
+double Testrun::getFunctionDuration(const int functionId) const
+{
+    return m_functionDurations.value(functionId, -1.0f);
+}
+
+QVector<float> Testrun::getFunctionDurations() const
+{
+    return m_functionDurations;
+}
+
+BenchmarkResult Testrun::getBenchmarkResult(const int functionId) const
+{
+    return m_benchmarkResults.value(functionId);
+}
+
+QMap<int, BenchmarkResult> Testrun::getBenchmarkResults() const
+{
+    return m_benchmarkResults;
+}
+
+QByteArray Testrun::getSegmentHash() const
+{
+    return m_segmentHash;
+}
+
+bool Testrun::isInProgress() const
+{
+    return m_inProgress;
+}
+
+bool Testrun::isAborted() const
+{
+    return m_aborted;
+}
+
 } // namespace Model
@@ -7,7 +7,8 @@
   * @license LGPL v2.1
   *
   * @brief Reads utm files and creates a monitor set model
-  * @details The MonitorSetReader parses a utm file and instanciates a MonitorSet model.
+  * @details The MonitorSetReader parses a utm file and instanciates a MonitorSet model. The
+  *          coverage histories of its libraries are read from the utmcov file next to it.
   *
   * @author Robert Wloch, robert@rowlo.de
   *************************************************************************************************/
@@ -17,6 +18,7 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QXmlStreamReader>
+#include <QDataStream>
 #include <QDebug>
 
 using Model::MonitorSet;
@@ -25,6 +27,11 @@ using Model::Project;
 using Model::Library;
 using Model::Testcase;
 using Model::Testrun;
+using Model::Fingerprint;
+using Model::Coverage;
+using Model::CoverageHistory;
+using Model::BenchmarkResult;
+using Model::BranchLayout;
 
 MonitorSetReader::MonitorSetReader(const QString &fileName)
     : m_fileName(fileName)
@@ -62,9 +69,59 @@ QSharedPointer<MonitorSet> MonitorSetReader::read()
     {
         qDebug() << "Failed to read from file: " << m_fileName;
     }
+    else
+    {
+        readCoverageHistories(result);
+    }
     return result;
 }
 
+void MonitorSetReader::readCoverageHistories(QSharedPointer<MonitorSet> result)
+{
+    QFile file(CoverageHistory::getFileName(m_fileName));
+    if (not file.exists() || not file.open(QIODevice::ReadOnly))
+    {
+        // monitor sets of older versions have no coverage history yet
+        return;
+    }
+    QDataStream stream(&file);
+    if (not CoverageHistory::readFileHeader(stream))
+    {
+        qDebug() << "Unknown coverage history format in file: " << file.fileName();
+        return;
+    }
+
+    QMap<QString, QSharedPointer<Branch> > branches;
+    foreach (const QSharedPointer<Branch> &branch, result->getBranches())
+    {
+        branches.insert(branch->getPath(), branch);
+    }
+    bool hasNext = false;
+    stream >> hasNext;
+    while (hasNext && stream.status() == QDataStream::Ok)
+    {
+        QString branchPath, projectName, libraryName;
+        stream >> branchPath >> projectName >> libraryName;
+        CoverageHistory history;
+        if (not history.read(stream))
+        {
+            qDebug() << "Failed to read coverage history from file: " << file.fileName();
+            return;
+        }
+        // libraries removed from the monitor set since are skipped
+        QSharedPointer<Branch> branch = branches.value(branchPath);
+        QSharedPointer<Project> project = branch.isNull() ? QSharedPointer<Project>()
+                                                          : branch->getProject(projectName);
+        QSharedPointer<Library> library = project.isNull() ? QSharedPointer<Library>()
+                                                           : project->getLibrary(libraryName);
+        if (not library.isNull())
+        {
+            library->withCoverageHistory(history);
+        }
+        stream >> hasNext;
+    }
+}
+
 void MonitorSetReader::readBranches(QXmlStreamReader* stream, QSharedPointer<MonitorSet> result)
 {
     while (not stream->atEnd())
@@ -83,8 +140,11 @@ void MonitorSetReader::readBranches(QXmlStreamReader* stream, QSharedPointer<Mon
                 break;
             }
 
+            QString watched;
+            readAttribute(stream, "watched", watched);
+
             QSharedPointer<Branch> branch(new Branch());
-            branch->withName(name).withPath(path);
+            branch->withName(name).withPath(path).withWatched(watched == "true");
             result->addBranch(branch);
 
             readProjects(stream, branch);
@@ -94,6 +154,7 @@ void MonitorSetReader::readBranches(QXmlStreamReader* stream, QSharedPointer<Mon
 
 void MonitorSetReader::readProjects(QXmlStreamReader* stream, QSharedPointer<Branch> result)
 {
+    QStringList layoutRules;
     while (not stream->atEnd())
     {
         stream->readNext();
@@ -101,6 +162,14 @@ void MonitorSetReader::readProjects(QXmlStreamReader* stream, QSharedPointer<Bra
         {
             break;
         }
+        if (stream->isStartElement() && stream->name() == "rule")
+        {
+            layoutRules.append(stream->readElementText());
+        }
+        if (stream->isEndElement() && stream->name() == "layout")
+        {
+            result->withLayout(BranchLayout::fromRules(layoutRules));
+        }
         if (stream->isStartElement() && stream->name() == "project")
         {
             QString name;
@@ -139,15 +208,78 @@ void MonitorSetReader::readLibraries(QXmlStreamReader* stream, QSharedPointer<Pr
                 break;
             }
 
+            QString tlogPath, infoPath;
+            readAttribute(stream, "tlogPath", tlogPath);
+            readAttribute(stream, "infoPath", infoPath);
+
             QSharedPointer<Library> library(new Library());
-            library->withName(name).withPath(path).withLcovPath(lcovPath);
+            library->withName(name).withPath(path).withLcovPath(lcovPath).withTlogPath(tlogPath)
+                    .withInfoPath(infoPath);
             result->addLibrary(library);
 
             readTestcases(stream, library);
+            if (tlogPath.isEmpty() && library->getTestcasesCount() > 0)
+            {
+                // files written before the tlog path was stored, its testcases know it
+                library->withTlogPath(library->getTestcases().first()->getTlogPath());
+            }
         }
     }
 }
 
+void MonitorSetReader::readFingerprint(QXmlStreamReader* stream, QSharedPointer<Library> result)
+{
+    QString kind, modifiedString, sizeString, hashString;
+    if (not readAttribute(stream, "kind", kind) ||
+            not readAttribute(stream, "modified", modifiedString) ||
+            not readAttribute(stream, "size", sizeString))
+    {
+        return;
+    }
+    readAttribute(stream, "hash", hashString);
+
+    Fingerprint fingerprint;
+    fingerprint.withModified(modifiedString.toLongLong())
+            .withSize(sizeString.toLongLong())
+            .withHash(hashString.toLatin1());
+    if (kind == "tlog")
+    {
+        result->withTlogFingerprint(fingerprint);
+    }
+    else if (kind == "lcov")
+    {
+        result->withLcovFingerprint(fingerprint);
+    }
+    else if (kind == "info")
+    {
+        result->withInfoFingerprint(fingerprint);
+    }
+}
+
+void MonitorSetReader::readCoverage(QXmlStreamReader* stream, QSharedPointer<Library> result)
+{
+    QString timestampString, linesFound, linesHit, functionsFound, functionsHit, branchesFound,
+            branchesHit, reportDate;
+    if (not readAttribute(stream, "timestamp", timestampString) ||
+            not readAttribute(stream, "linesFound", linesFound) ||
+            not readAttribute(stream, "linesHit", linesHit))
+    {
+        return;
+    }
+    readAttribute(stream, "functionsFound", functionsFound);
+    readAttribute(stream, "functionsHit", functionsHit);
+    readAttribute(stream, "branchesFound", branchesFound);
+    readAttribute(stream, "branchesHit", branchesHit);
+    readAttribute(stream, "reportDate", reportDate);
+
+    Coverage coverage;
+    coverage.withLines(linesFound.toLongLong(), linesHit.toLongLong())
+            .withFunctions(functionsFound.toLongLong(), functionsHit.toLongLong())
+            .withBranches(branchesFound.toLongLong(), branchesHit.toLongLong())
+            .withReportDate(reportDate);
+    result->addCoverage(timestampString.toLongLong(), coverage);
+}
+
 void MonitorSetReader::readTestcases(QXmlStreamReader* stream, QSharedPointer<Library> result)
 {
     while (not stream->atEnd())
@@ -157,6 +289,14 @@ void MonitorSetReader::readTestcases(QXmlStreamReader* stream, QSharedPointer<Li
         {
             break;
         }
+        if (stream->isStartElement() && stream->name() == "fingerprint")
+        {
+            readFingerprint(stream, result);
+        }
+        if (stream->isStartElement() && stream->name() == "coverage")
+        {
+            readCoverage(stream, result);
+        }
         if (stream->isStartElement() && stream->name() == "testcase")
         {
             QString name;
@@ -219,6 +359,78 @@ void MonitorSetReader::readTestruns(QXmlStreamReader* stream, QSharedPointer<Tes
             testrun = QSharedPointer<Testrun>(new Testrun());
             testrun->withTimestamp(timestamp).
                     withResults(passed, failed, skipped);
+
+            QString functionStatesString;
+            if (readAttribute(stream, "functionStates", functionStatesString))
+            {
+                testrun->withFunctionStates(
+                            QByteArray::fromBase64(functionStatesString.toLatin1()));
+            }
+
+            QString durationString;
+            if (readAttribute(stream, "duration", durationString))
+            {
+                testrun->withDuration(durationString.toDouble());
+            }
+
+            QString functionDurationsString;
+            if (readAttribute(stream, "functionDurations", functionDurationsString))
+            {
+                QStringList durations = functionDurationsString.split(',');
+                QVector<float> functionDurations(durations.size(), -1.0f);
+                for (int functionId = 0; functionId < durations.size(); ++functionId)
+                {
+                    bool valid = false;
+                    float duration = durations.at(functionId).toFloat(&valid);
+                    if (valid)
+                    {
+                        functionDurations[functionId] = duration;
+                    }
+                }
+                testrun->withFunctionDurations(functionDurations);
+            }
+
+            QString segmentHashString;
+            if (readAttribute(stream, "segmentHash", segmentHashString))
+            {
+                testrun->withSegmentHash(segmentHashString.toLatin1());
+            }
+
+            QString abortedString;
+            if (readAttribute(stream, "aborted", abortedString))
+            {
+                testrun->withAborted(abortedString == "true");
+            }
+        }
+        if (stream->isStartElement() && stream->name() == "function")
+        {
+            QString name, file, lineString;
+            if (readAttribute(stream, "name", name))
+            {
+                int functionId = result->internFunction(name);
+                if (readAttribute(stream, "file", file) &&
+                        readAttribute(stream, "line", lineString))
+                {
+                    result->withFunctionLocation(functionId, file, lineString.toInt());
+                }
+            }
+        }
+        if (stream->isStartElement() && stream->name() == "benchmark" && not testrun.isNull())
+        {
+            QString idString, valueString, unit, backend, iterationsString;
+            if (readAttribute(stream, "id", idString) &&
+                    readAttribute(stream, "value", valueString) &&
+                    readAttribute(stream, "unit", unit) &&
+                    readAttribute(stream, "backend", backend))
+            {
+                readAttribute(stream, "iterations", iterationsString);
+                BenchmarkResult benchmarkResult;
+                benchmarkResult.withValue(valueString.toDouble())
+                        .withIterations(iterationsString.toInt())
+                        .withUnit(unit)
+                        .withBackend(backend);
+                testrun->withBenchmarkResult(idString.toInt(), benchmarkResult);
+            }
         }
         if (stream->isStartElement() && stream->name() == "failLog" && not testrun.isNull())
         {
@@ -7,7 +7,8 @@
   * @license LGPL v2.1
   *
   * @brief Writes utm files from a monitor set model
-  * @details The MonitorSetWriter creates an utm file from a MonitorSet model.
+  * @details The MonitorSetWriter creates an utm file from a MonitorSet model. The coverage
+  *          histories of the libraries are written in binary next to it, to a utmcov file.
   *
   * @author Robert Wloch, robert@rowlo.de
   *************************************************************************************************/
@@ -17,6 +18,7 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QXmlStreamWriter>
+#include <QDataStream>
 #include <QDebug>
 
 using Model::MonitorSet;
@@ -25,6 +27,29 @@ using Model::Project;
 using Model::Library;
 using Model::Testcase;
 using Model::Testrun;
+using Model::Fingerprint;
+using Model::Coverage;
+using Model::CoverageHistory;
+
+namespace
+{
+
+bool hasTestrunInProgress(const QSharedPointer<Library> &library)
+{
+    foreach (const QSharedPointer<Testcase> &testcase, library->getTestcases())
+    {
+        foreach (const QSharedPointer<Testrun> &testrun, testcase->getTestruns())
+        {
+            if (testrun->isInProgress())
+            {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+} // namespace
 
 MonitorSetWriter::MonitorSetWriter(const QString &fileName)
     : m_fileName(fileName)
@@ -51,7 +76,48 @@ bool MonitorSetWriter::write(const QSharedPointer<MonitorSet> &monitorSet)
     stream.writeEndDocument();
 
     file.close();
-    return true;
+    return writeCoverageHistories(monitorSet);
+}
+
+bool MonitorSetWriter::writeCoverageHistories(const QSharedPointer<MonitorSet> &monitorSet)
+{
+    // written next to the old histories, which are replaced only once all are written
+    QString fileName = CoverageHistory::getFileName(m_fileName);
+    QFile file(QString("%1.tmp").arg(fileName));
+    if (not file.open(QIODevice::WriteOnly))
+    {
+        qDebug() << "Cannot write to file: " << file.fileName();
+        return false;
+    }
+    QDataStream stream(&file);
+    CoverageHistory::writeFileHeader(stream);
+
+    // libraries are found again by branch path, project name, and library name
+    foreach (const QSharedPointer<Branch> &branch, monitorSet->getBranches())
+    {
+        foreach (const QSharedPointer<Project> &project, branch->getProjects())
+        {
+            foreach (const QSharedPointer<Library> &library, project->getLibraries())
+            {
+                CoverageHistory history = library->getCoverageHistory();
+                if (history.isEmpty())
+                {
+                    continue;
+                }
+                stream << true << branch->getPath() << project->getName() << library->getName();
+                history.write(stream);
+            }
+        }
+    }
+    stream << false;
+    file.close();
+    if (stream.status() != QDataStream::Ok || file.error() != QFile::NoError)
+    {
+        file.remove();
+        return false;
+    }
+    QFile::remove(fileName);
+    return file.rename(fileName);
 }
 
 void MonitorSetWriter::writeBranches(
@@ -76,6 +142,19 @@ void MonitorSetWriter::writeBranches(
         writer->writeStartElement("branch");
         writer->writeAttribute("name", name);
         writer->writeAttribute("path", path);
+        if (branch->isWatched())
+        {
+            writer->writeAttribute("watched", "true");
+        }
+        if (not branch->getLayout().isDefault())
+        {
+            writer->writeStartElement("layout");
+            foreach (const QString &rule, branch->getLayout().toRules())
+            {
+                writer->writeTextElement("rule", rule);
+            }
+            writer->writeEndElement(); // layout
+        }
         writeProjects(writer, branch->getProjects());
         writer->writeEndElement(); // branch
     }
@@ -132,11 +211,71 @@ void MonitorSetWriter::writeLibraries(
         writer->writeAttribute("name", name);
         writer->writeAttribute("path", path);
         writer->writeAttribute("lcovPath", lcovPath);
+        if (not library->getTlogPath().isEmpty())
+        {
+            writer->writeAttribute("tlogPath", library->getTlogPath());
+        }
+        if (not library->getInfoPath().isEmpty())
+        {
+            writer->writeAttribute("infoPath", library->getInfoPath());
+        }
+        if (not hasTestrunInProgress(library))
+        {
+            // without its fingerprint the tlog is parsed again after a restart
+            writeFingerprint(writer, "tlog", library->getTlogFingerprint());
+        }
+        writeFingerprint(writer, "lcov", library->getLcovFingerprint());
+        writeFingerprint(writer, "info", library->getInfoFingerprint());
+        writeCoverages(writer, library->getCoverages());
         writeTestcases(writer, library->getTestcases());
         writer->writeEndElement(); // library
     }
 }
 
+void MonitorSetWriter::writeFingerprint(
+        QXmlStreamWriter *writer, const QString &kind, const Fingerprint &fingerprint)
+{
+    if (not writer || fingerprint.isEmpty())
+    {
+        return;
+    }
+    writer->writeStartElement("fingerprint");
+    writer->writeAttribute("kind", kind);
+    writer->writeAttribute("modified", QString("%1").arg(fingerprint.getModified()));
+    writer->writeAttribute("size", QString("%1").arg(fingerprint.getSize()));
+    if (not fingerprint.getHash().isEmpty())
+    {
+        writer->writeAttribute("hash", QString::fromLatin1(fingerprint.getHash()));
+    }
+    writer->writeEndElement(); // fingerprint
+}
+
+void MonitorSetWriter::writeCoverages(
+        QXmlStreamWriter *writer, const QMap<qint64, Coverage> &coverages)
+{
+    if (not writer)
+    {
+        return;
+    }
+    QMap<qint64, Coverage>::const_iterator it = coverages.constBegin();
+    for (; it != coverages.constEnd(); ++it)
+    {
+        writer->writeStartElement("coverage");
+        writer->writeAttribute("timestamp", QString("%1").arg(it.key()));
+        writer->writeAttribute("linesFound", QString("%1").arg(it->getLinesFound()));
+        writer->writeAttribute("linesHit", QString("%1").arg(it->getLinesHit()));
+        writer->writeAttribute("functionsFound", QString("%1").arg(it->getFunctionsFound()));
+        writer->writeAttribute("functionsHit", QString("%1").arg(it->getFunctionsHit()));
+        writer->writeAttribute("branchesFound", QString("%1").arg(it->getBranchesFound()));
+        writer->writeAttribute("branchesHit", QString("%1").arg(it->getBranchesHit()));
+        if (not it->getReportDate().isEmpty())
+        {
+            writer->writeAttribute("reportDate", it->getReportDate());
+        }
+        writer->writeEndElement(); // coverage
+    }
+}
+
 void MonitorSetWriter::writeTestcases(
         QXmlStreamWriter *writer, QList<QSharedPointer<Testcase> > testcases)
 {
@@ -168,6 +307,7 @@ void MonitorSetWriter::writeTestcases(
         writer->writeAttribute("tlogPath", path);
         writer->writeAttribute("tlogStartLine", QString("%1").arg(startLine));
         writer->writeAttribute("tlogEndLine", QString("%1").arg(endLine));
+        writeFunctions(writer, testcase);
         writeTestruns(writer, testcase->getTestruns());
         writer->writeEndElement(); // testcase
     }
@@ -182,6 +322,11 @@ void MonitorSetWriter::writeTestruns(
     }
     foreach (const QSharedPointer<Testrun> &testrun, testruns)
     {
+        if (testrun->isInProgress())
+        {
+            // not written, the tlog's fingerprint is left out of the file for it, too
+            continue;
+        }
         qint32 passed = testrun->getPassed();
         qint32 failed = testrun->getFailed();
         qint32 skipped = testrun->getSkipped();
@@ -192,6 +337,34 @@ void MonitorSetWriter::writeTestruns(
         writer->writeAttribute("failed", QString("%1").arg(failed));
         writer->writeAttribute("skipped", QString("%1").arg(skipped));
         writer->writeAttribute("timestamp", QString("%1").arg(timestamp));
+        if (testrun->getDuration() >= 0.0)
+        {
+            writer->writeAttribute("duration", QString::number(testrun->getDuration()));
+        }
+        if (not testrun->getFunctionStates().isEmpty())
+        {
+            writer->writeAttribute("functionStates",
+                                   QString::fromLatin1(testrun->getFunctionStates().toBase64()));
+        }
+        if (not testrun->getFunctionDurations().isEmpty())
+        {
+            // one entry per function id, empty for the functions without a duration
+            QStringList durations;
+            foreach (float duration, testrun->getFunctionDurations())
+            {
+                durations << (duration >= 0.0f ? QString::number(duration) : QString());
+            }
+            writer->writeAttribute("functionDurations", durations.join(","));
+        }
+        if (not testrun->getSegmentHash().isEmpty())
+        {
+            writer->writeAttribute("segmentHash", QString::fromLatin1(testrun->getSegmentHash()));
+        }
+        if (testrun->isAborted())
+        {
+            writer->writeAttribute("aborted", "true");
+        }
+        writeFunctionResults(writer, testrun);
         if (failLogs.size() > 0)
         {
             foreach (const QString &failLog, failLogs)
@@ -202,3 +375,47 @@ void MonitorSetWriter::writeTestruns(
         writer->writeEndElement(); // testrun
     }
 }
+
+void MonitorSetWriter::writeFunctions(
+        QXmlStreamWriter *writer, const QSharedPointer<Testcase> &testcase)
+{
+    if (not writer)
+    {
+        return;
+    }
+    // the position of a function element is the id testruns refer to
+    QStringList functionNames = testcase->getFunctionNames();
+    for (int functionId = 0; functionId < functionNames.size(); ++functionId)
+    {
+        writer->writeStartElement("function");
+        writer->writeAttribute("name", functionNames.at(functionId));
+        QPair<QString, int> location = testcase->getFunctionLocation(functionId);
+        if (not location.first.isEmpty())
+        {
+            writer->writeAttribute("file", location.first);
+            writer->writeAttribute("line", QString("%1").arg(location.second));
+        }
+        writer->writeEndElement(); // function
+    }
+}
+
+void MonitorSetWriter::writeFunctionResults(
+        QXmlStreamWriter *writer, const QSharedPointer<Testrun> &testrun)
+{
+    if (not writer)
+    {
+        return;
+    }
+    QMap<int, Model::BenchmarkResult> benchmarkResults = testrun->getBenchmarkResults();
+    for (QMap<int, Model::BenchmarkResult>::const_iterator it = benchmarkResults.constBegin();
+         it != benchmarkResults.constEnd(); ++it)
+    {
+        writer->writeStartElement("benchmark");
+        writer->writeAttribute("id", QString("%1").arg(it.key()));
+        writer->writeAttribute("value", QString::number(it.value().getValue(), 'g', 10));
+        writer->writeAttribute("unit", it.value().getUnit());
+        writer->writeAttribute("backend", it.value().getBackend());
+        writer->writeAttribute("iterations", QString("%1").arg(it.value().getIterations()));
+        writer->writeEndElement(); // benchmark
+    }
+}
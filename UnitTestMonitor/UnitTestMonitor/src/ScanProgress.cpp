@@ -0,0 +1,161 @@
+/**
+  * @file ScanProgress.cpp
+  *
+  * @class ScanProgress
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Progress and cancellation state of a branch scan
+  * @details The branch scanner counts discovered and parsed libraries and the tlog bytes read into
+  *          a ScanProgress shared with the main window, which polls it while the scan runs. A
+  *          cancel request is honored between libraries, so every library is either parsed
+  *          completely or left untouched. Once the libraries of a scan are merged into the branch
+  *          the scanner publishes the branch; libraries whose tlog is still queued or parsed are
+  *          busy and must not be read until they are finished.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#include "ScanProgress.h"
+
+#include <QMutexLocker>
+
+ScanProgress::ScanProgress()
+    : m_cancelled(false),
+      m_discoveredLibraries(0),
+      m_pendingLibraries(0),
+      m_parsedLibraries(0),
+      m_pendingBytes(0),
+      m_bytesRead(0),
+      m_publications(0)
+{
+    m_elapsedTimer.start();
+}
+
+void ScanProgress::reset()
+{
+    QMutexLocker locker(&m_mutex);
+    m_elapsedTimer.restart();
+    m_cancelled = false;
+    m_discoveredLibraries = 0;
+    m_pendingLibraries = 0;
+    m_parsedLibraries = 0;
+    m_pendingBytes = 0;
+    m_bytesRead = 0;
+    m_busyLibraries.clear();
+    m_branch.clear();
+    m_publications = 0;
+}
+
+void ScanProgress::cancel()
+{
+    QMutexLocker locker(&m_mutex);
+    m_cancelled = true;
+}
+
+bool ScanProgress::isCancelled() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_cancelled;
+}
+
+void ScanProgress::addDiscoveredLibraries(int count)
+{
+    QMutexLocker locker(&m_mutex);
+    m_discoveredLibraries += count;
+}
+
+void ScanProgress::addPendingLibraries(int count, qint64 bytes)
+{
+    QMutexLocker locker(&m_mutex);
+    m_pendingLibraries += count;
+    m_pendingBytes += bytes;
+}
+
+void ScanProgress::addParsedLibrary(const Model::Library *library, qint64 bytes)
+{
+    QMutexLocker locker(&m_mutex);
+    ++m_parsedLibraries;
+    m_bytesRead += bytes;
+    m_busyLibraries.remove(library);
+    ++m_publications;
+}
+
+void ScanProgress::addBusyLibrary(const Model::Library *library)
+{
+    QMutexLocker locker(&m_mutex);
+    m_busyLibraries.insert(library);
+}
+
+bool ScanProgress::isBusy(const Model::Library *library) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_busyLibraries.contains(library);
+}
+
+void ScanProgress::publishBranch(const QSharedPointer<Model::Branch> &branch)
+{
+    QMutexLocker locker(&m_mutex);
+    m_branch = branch;
+    ++m_publications;
+}
+
+QSharedPointer<Model::Branch> ScanProgress::getBranch() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_branch;
+}
+
+int ScanProgress::getPublications() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_publications;
+}
+
+int ScanProgress::getDiscoveredLibraries() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_discoveredLibraries;
+}
+
+int ScanProgress::getPendingLibraries() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_pendingLibraries;
+}
+
+int ScanProgress::getParsedLibraries() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_parsedLibraries;
+}
+
+qint64 ScanProgress::getPendingBytes() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_pendingBytes;
+}
+
+qint64 ScanProgress::getBytesRead() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_bytesRead;
+}
+
+qint64 ScanProgress::getElapsedMsecs() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_elapsedTimer.elapsed();
+}
+
+qint64 ScanProgress::getRemainingMsecs() const
+{
+    QMutexLocker locker(&m_mutex);
+    // extrapolate from the bytes read so far, tlog parsing dominates the scan
+    if (m_bytesRead <= 0 || m_pendingBytes <= m_bytesRead)
+    {
+        return -1;
+    }
+    double msecsPerByte = static_cast<double>(m_elapsedTimer.elapsed()) / m_bytesRead;
+    return static_cast<qint64>(msecsPerByte * (m_pendingBytes - m_bytesRead));
+}
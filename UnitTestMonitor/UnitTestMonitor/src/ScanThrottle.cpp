@@ -0,0 +1,120 @@
+/**
+  * @file ScanThrottle.cpp
+  *
+  * @class ScanThrottle
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Keeps a background branch scan out of the way of the builds on the same host
+  * @details The throttle hands out the tlog bytes of a scan against a budget of bytes per second
+  *          shared by all worker threads; a budget of 0 does not limit the rate. On Linux the
+  *          IdleIoPriority scope puts the calling thread into the idle I/O scheduling class and
+  *          dropFromPageCache() advises the kernel that a parsed tlog is not needed again, so a
+  *          scan neither competes with compilers for the disk nor evicts their working set.
+  *          Elsewhere both are no-ops.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#include "ScanThrottle.h"
+
+#include <QFile>
+#include <QMutexLocker>
+
+#ifdef Q_OS_LINUX
+#include <fcntl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+#ifdef Q_OS_LINUX
+// from linux/ioprio.h, which is not installed everywhere
+const int ioprioWhoProcess = 1;
+const int ioprioClassShift = 13;
+const int ioprioClassIdle = 3;
+#endif
+
+} // namespace
+
+ScanThrottle::IdleIoPriority::IdleIoPriority(bool enabled)
+    : m_previousPriority(-1)
+{
+#ifdef Q_OS_LINUX
+    if (enabled)
+    {
+        // who 0 is the calling thread, the pool threads of a scan are lowered one by one
+        int priority = static_cast<int>(syscall(SYS_ioprio_get, ioprioWhoProcess, 0));
+        if (priority >= 0 &&
+                syscall(SYS_ioprio_set, ioprioWhoProcess, 0,
+                        ioprioClassIdle << ioprioClassShift) == 0)
+        {
+            m_previousPriority = priority;
+        }
+    }
+#else
+    Q_UNUSED(enabled);
+#endif
+}
+
+ScanThrottle::IdleIoPriority::~IdleIoPriority()
+{
+#ifdef Q_OS_LINUX
+    if (m_previousPriority >= 0)
+    {
+        // QtConcurrent threads are reused, they must not stay idle
+        syscall(SYS_ioprio_set, ioprioWhoProcess, 0, m_previousPriority);
+    }
+#endif
+}
+
+ScanThrottle::ScanThrottle(qint64 bytesPerSecond)
+    : m_bytesPerSecond(qMax(Q_INT64_C(0), bytesPerSecond)),
+      m_bytesReserved(0),
+      m_budgetFreeAt(0)
+{
+    m_clock.start();
+}
+
+qint64 ScanThrottle::getBytesPerSecond() const
+{
+    return m_bytesPerSecond;
+}
+
+qint64 ScanThrottle::getBytesReserved() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_bytesReserved;
+}
+
+int ScanThrottle::reserve(qint64 bytes)
+{
+    // returns the milliseconds the caller has to wait before it may read the reserved bytes
+    QMutexLocker locker(&m_mutex);
+    m_bytesReserved += qMax(Q_INT64_C(0), bytes);
+    if (m_bytesPerSecond <= 0 || bytes <= 0)
+    {
+        return 0;
+    }
+    qint64 now = m_clock.elapsed();
+    qint64 start = qMax(now, m_budgetFreeAt);
+    m_budgetFreeAt = start + bytes * 1000 / m_bytesPerSecond;
+    return static_cast<int>(qMin(start - now, Q_INT64_C(0x7fffffff)));
+}
+
+void ScanThrottle::dropFromPageCache(const QString &filePath)
+{
+#ifdef Q_OS_LINUX
+    int fd = ::open(QFile::encodeName(filePath).constData(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+    {
+        return;
+    }
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+    ::close(fd);
+#else
+    Q_UNUSED(filePath);
+#endif
+}
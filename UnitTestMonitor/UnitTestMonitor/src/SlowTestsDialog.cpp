@@ -0,0 +1,197 @@
+/**
+  * @file SlowTestsDialog.cpp
+  *
+  * @class SlowTestsDialog
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Dialog listing the testcase durations of a branch
+  * @details The SlowTestsDialog lists the duration of the latest run of each testcase next to
+  *          the duration of the run before it. The table sorts by any column, so the slowest
+  *          testcases and the biggest slowdowns are a click away.
+  *
+  * @author robert@rowlo.de
+  *************************************************************************************************/
+#include "SlowTestsDialog.h"
+#include "ui_SlowTestsDialog.h"
+
+#include <QColor>
+#include <QSettings>
+#include <QStandardItemModel>
+#include <Model/Project.h>
+#include <Model/Library.h>
+#include <Model/Testcase.h>
+#include <Model/Testrun.h>
+
+using Model::Branch;
+using Model::Project;
+using Model::Library;
+using Model::Testcase;
+using Model::Testrun;
+
+namespace
+{
+
+const int sortRole = Qt::UserRole + 1;
+
+enum Column
+{
+    ProjectColumn = 0,
+    LibraryColumn,
+    TestcaseColumn,
+    LatestColumn,
+    PreviousColumn,
+    ChangeColumn,
+    ChangePercentColumn
+};
+
+} // namespace
+
+SlowTestsDialog::SlowTestsDialog(QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::SlowTestsDialog),
+    m_model(0)
+{
+    ui->setupUi(this);
+    m_model = new QStandardItemModel(ui->testcasesTableView);
+    m_model->setSortRole(sortRole);
+    ui->testcasesTableView->setModel(m_model);
+    ui->testcasesTableView->setSortingEnabled(true);
+
+    connect(this, SIGNAL(finished(int)), SLOT(storeGeometry()));
+    connect(ui->slowestPushButton, SIGNAL(clicked()), SLOT(sortBySlowest()));
+    connect(ui->slowdownPushButton, SIGNAL(clicked()), SLOT(sortBySlowdown()));
+}
+
+SlowTestsDialog::~SlowTestsDialog()
+{
+    delete ui;
+}
+
+void SlowTestsDialog::storeGeometry()
+{
+    QSettings settings;
+    settings.setValue("SlowTestsDialog/size", size());
+    settings.setValue("SlowTestsDialog/pos", pos());
+    settings.sync();
+}
+
+void SlowTestsDialog::sortBySlowest()
+{
+    ui->testcasesTableView->sortByColumn(LatestColumn, Qt::DescendingOrder);
+}
+
+void SlowTestsDialog::sortBySlowdown()
+{
+    ui->testcasesTableView->sortByColumn(ChangeColumn, Qt::DescendingOrder);
+}
+
+QStandardItem* SlowTestsDialog::createItem(const QString &text, const QVariant &sortValue)
+{
+    QStandardItem *item = new QStandardItem(text);
+    item->setEditable(false);
+    item->setData(sortValue, sortRole);
+    return item;
+}
+
+QStandardItem* SlowTestsDialog::createDurationItem(double msecs)
+{
+    if (msecs < 0.0)
+    {
+        // runs without duration sort below all measured ones
+        return createItem("n/a", -1.0);
+    }
+    QStandardItem *item = createItem(QString::number(msecs, 'f', 0), msecs);
+    item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    return item;
+}
+
+void SlowTestsDialog::initializeForBranch(const QSharedPointer<Branch> &branch)
+{
+    m_model->clear();
+    m_model->setHorizontalHeaderLabels(QStringList() << "Project" << "Library" << "Testcase"
+                                       << "Latest [ms]" << "Previous [ms]" << "Change [ms]"
+                                       << "Change [%]");
+    ui->descriptionLabel->setText("");
+    if (branch.isNull())
+    {
+        return;
+    }
+
+    double totalLatest = 0.0;
+    foreach (const QSharedPointer<Project> &project, branch->getProjects())
+    {
+        foreach (const QSharedPointer<Library> &library, project->getLibraries())
+        {
+            foreach (const QSharedPointer<Testcase> &testcase, library->getTestcases())
+            {
+                // testruns are ordered by timestamp, only runs with a duration are compared
+                double latest = -1.0, previous = -1.0;
+                QList<QSharedPointer<Testrun> > testruns = testcase->getTestruns();
+                for (int i = testruns.size() - 1; i >= 0 && previous < 0.0; --i)
+                {
+                    double duration = testruns.at(i)->getDuration();
+                    if (duration < 0.0)
+                    {
+                        continue;
+                    }
+                    if (latest < 0.0)
+                    {
+                        latest = duration;
+                    }
+                    else
+                    {
+                        previous = duration;
+                    }
+                }
+                if (latest < 0.0)
+                {
+                    continue;
+                }
+                totalLatest += latest;
+
+                QList<QStandardItem*> rowItems;
+                rowItems << createItem(project->getName(), project->getName().toLower())
+                         << createItem(library->getName(), library->getName().toLower())
+                         << createItem(testcase->getName(), testcase->getName().toLower())
+                         << createDurationItem(latest)
+                         << createDurationItem(previous);
+                if (previous >= 0.0)
+                {
+                    double change = latest - previous;
+                    rowItems << createItem(QString("%1%2").arg(change > 0.0 ? "+" : "")
+                                           .arg(change, 0, 'f', 0), change);
+                    if (previous > 0.0)
+                    {
+                        double percent = change * 100.0 / previous;
+                        rowItems << createItem(QString("%1%2").arg(percent > 0.0 ? "+" : "")
+                                               .arg(percent, 0, 'f', 1), percent);
+                    }
+                    else
+                    {
+                        rowItems << createItem("n/a", 0.0);
+                    }
+                    if (change > 0.0)
+                    {
+                        rowItems.at(ChangeColumn)->setForeground(QColor::fromRgb(200, 0, 0));
+                    }
+                }
+                else
+                {
+                    rowItems << createItem("n/a", 0.0) << createItem("n/a", 0.0);
+                }
+                rowItems.at(ChangeColumn)->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+                rowItems.at(ChangePercentColumn)->setTextAlignment(
+                            Qt::AlignRight | Qt::AlignVCenter);
+                m_model->appendRow(rowItems);
+            }
+        }
+    }
+
+    ui->descriptionLabel->setText(QString("%1: %2 testcases, %3 s in their latest runs")
+                                  .arg(branch->getName()).arg(m_model->rowCount())
+                                  .arg(totalLatest / 1000.0, 0, 'f', 1));
+    sortBySlowest();
+    ui->testcasesTableView->resizeColumnsToContents();
+}
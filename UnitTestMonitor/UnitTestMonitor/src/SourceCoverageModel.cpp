@@ -0,0 +1,221 @@
+/**
+  * @file SourceCoverageModel.cpp
+  *
+  * @class SourceCoverageModel
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Table model of a source file with the execution count of each line
+  * @details The model maps the source file and only indexes where its lines start. The text of a
+  *          line is decoded when a view asks for it, so a view shows a file of any length right
+  *          away and only pays for the rows it paints. The execution counts come from the sorted
+  *          line arrays of a tracefile and are looked up by binary search. Instrumented lines are
+  *          tinted by whether they ran.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#include "SourceCoverageModel.h"
+
+#include <QColor>
+#include <QFont>
+#include <QtAlgorithms>
+#include <cstring>
+
+SourceCoverageModel::SourceCoverageModel(QObject *parent)
+    : QAbstractTableModel(parent),
+      m_data(0),
+      m_size(0)
+{
+}
+
+SourceCoverageModel::~SourceCoverageModel()
+{
+    clear();
+}
+
+void SourceCoverageModel::clear()
+{
+    beginResetModel();
+    if (m_data && m_content.isEmpty())
+    {
+        m_file.unmap(reinterpret_cast<uchar*>(const_cast<char*>(m_data)));
+    }
+    m_file.close();
+    m_data = 0;
+    m_size = 0;
+    m_content.clear();
+    m_lineStarts.clear();
+    m_sourceFile = Model::FileCoverage();
+    m_lines.clear();
+    m_lineHits.clear();
+    endResetModel();
+}
+
+bool SourceCoverageModel::setSourceFile(const Model::FileCoverage &sourceFile)
+{
+    clear();
+    beginResetModel();
+    m_sourceFile = sourceFile;
+    m_lines = sourceFile.getLines();
+    m_lineHits = sourceFile.getLineHits();
+    m_file.setFileName(sourceFile.getPath());
+    if (m_file.open(QIODevice::ReadOnly))
+    {
+        m_size = m_file.size();
+        m_data = m_size > 0 ? reinterpret_cast<const char*>(m_file.map(0, m_size)) : 0;
+        if (not m_data && m_size > 0)
+        {
+            m_content = m_file.readAll();
+            m_data = m_content.constData();
+            m_size = m_content.size();
+        }
+    }
+
+    if (m_data)
+    {
+        m_lineStarts.append(0);
+        const char *end = m_data + m_size;
+        const char *begin = m_data;
+        while (begin < end)
+        {
+            const char *lineEnd = static_cast<const char*>(std::memchr(begin, '\n', end - begin));
+            if (not lineEnd || lineEnd + 1 == end)
+            {
+                break;
+            }
+            m_lineStarts.append(lineEnd + 1 - m_data);
+            begin = lineEnd + 1;
+        }
+    }
+    else if (not m_lines.isEmpty())
+    {
+        // without the source the instrumented lines are still listed
+        m_lineStarts.fill(-1, static_cast<int>(m_lines.last()));
+    }
+    endResetModel();
+    return m_data != 0;
+}
+
+int SourceCoverageModel::findLine(qint64 lineNumber) const
+{
+    // rows are zero based, lines one based
+    return qBound(0, static_cast<int>(lineNumber) - 1, qMax(0, m_lineStarts.size() - 1));
+}
+
+int SourceCoverageModel::nextUncoveredRow(int row) const
+{
+    // the first uncovered line below the row, wrapping around to the top
+    if (m_lines.isEmpty())
+    {
+        return -1;
+    }
+    QVector<qint64>::const_iterator it = qUpperBound(m_lines.constBegin(), m_lines.constEnd(),
+                                                     static_cast<qint64>(row + 1));
+    int start = it - m_lines.constBegin();
+    int count = m_lines.size();
+    for (int i = 0; i < count; ++i)
+    {
+        int index = (start + i) % count;
+        if (m_lineHits.at(index) == 0)
+        {
+            return findLine(m_lines.at(index));
+        }
+    }
+    return -1;
+}
+
+int SourceCoverageModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_lineStarts.size();
+}
+
+int SourceCoverageModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : 3;
+}
+
+QVariant SourceCoverageModel::data(const QModelIndex &index, int role) const
+{
+    if (not index.isValid() || index.row() >= m_lineStarts.size())
+    {
+        return QVariant();
+    }
+    int row = index.row();
+    if (role == Qt::DisplayRole)
+    {
+        if (index.column() == LineColumn)
+        {
+            return row + 1;
+        }
+        if (index.column() == HitsColumn)
+        {
+            qint64 hits = lineHits(row);
+            return hits < 0 ? QVariant() : QVariant(hits);
+        }
+        return lineText(row);
+    }
+    if (role == Qt::BackgroundRole)
+    {
+        qint64 hits = lineHits(row);
+        if (hits == 0)
+        {
+            return QColor::fromRgb(240, 130, 130, 230);
+        }
+        if (hits > 0 && index.column() != SourceColumn)
+        {
+            return QColor::fromRgb(130, 255, 130, 230);
+        }
+        return QVariant();
+    }
+    if (role == Qt::TextAlignmentRole && index.column() != SourceColumn)
+    {
+        return static_cast<int>(Qt::AlignRight | Qt::AlignVCenter);
+    }
+    if (role == Qt::FontRole && index.column() == SourceColumn)
+    {
+        QFont font("Monospace");
+        font.setStyleHint(QFont::TypeWriter);
+        return font;
+    }
+    return QVariant();
+}
+
+QVariant SourceCoverageModel::headerData(int section, Qt::Orientation orientation,
+                                         int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole)
+    {
+        return QVariant();
+    }
+    switch (section)
+    {
+    case LineColumn:
+        return tr("Line");
+    case HitsColumn:
+        return tr("Hits");
+    default:
+        return tr("Source");
+    }
+}
+
+QString SourceCoverageModel::lineText(int row) const
+{
+    if (not m_data)
+    {
+        return QString();
+    }
+    qint64 begin = m_lineStarts.at(row);
+    qint64 end = row + 1 < m_lineStarts.size() ? m_lineStarts.at(row + 1) : m_size;
+    while (end > begin && (m_data[end - 1] == '\n' || m_data[end - 1] == '\r'))
+    {
+        --end;
+    }
+    // tabs would stretch the row, a view has no tab stops
+    return QString::fromUtf8(m_data + begin, end - begin).replace('\t', "    ");
+}
+
+qint64 SourceCoverageModel::lineHits(int row) const
+{
+    return m_sourceFile.getHits(row + 1);
+}
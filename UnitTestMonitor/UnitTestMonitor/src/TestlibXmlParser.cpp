@@ -0,0 +1,353 @@
+/**
+  * @file TestlibXmlParser.cpp
+  *
+  * @class TestlibXmlParser
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Parses Qt testlib xml and lightxml output into the model
+  * @details The testlib xml parser streams a tlog written with "-o file,xml" or "-o file,lightxml"
+  *          through a QXmlStreamReader. Concatenated documents of several test executables are
+  *          accepted. Each test function and data row is recorded with its incident, source
+  *          location, duration, and QBENCHMARK result.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#include "TestlibXmlParser.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QXmlStreamReader>
+
+#include <Model/Testrun.h>
+
+using Model::Library;
+using Model::Testcase;
+using Model::Testrun;
+using Model::Testfunction;
+using Model::BenchmarkResult;
+
+namespace
+{
+
+// lightxml has no root element and several documents may be concatenated, so the parser feeds
+// everything into one synthetic root element
+const char rootElement[] = "utmTlog";
+const qint64 chunkSize = 64 * 1024;
+
+} // namespace
+
+TestlibXmlParser::TestlibXmlParser()
+    : m_timestamp(0),
+      m_bytesParsed(0),
+      m_testcaseStartLine(0),
+      m_passed(0),
+      m_failed(0),
+      m_skipped(0),
+      m_testcaseDuration(-1.0),
+      m_functionFirstResult(0),
+      m_inIncident(false),
+      m_incidentLine(0),
+      m_text(0)
+{
+}
+
+bool TestlibXmlParser::isXmlTlog(const QString &tlogFilePath)
+{
+    QFile tlogFile(tlogFilePath);
+    if (not tlogFile.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+    return isXmlTlogHead(tlogFile.read(256));
+}
+
+bool TestlibXmlParser::isXmlTlogHead(const QByteArray &tlogHead)
+{
+    // only the first 256 bytes of a tlog are looked at
+    QByteArray head = tlogHead.left(256).trimmed();
+    if (head.startsWith("\xEF\xBB\xBF"))
+    {
+        head = head.mid(3).trimmed();
+    }
+    return head.startsWith("<?xml") || head.startsWith("<TestCase")
+            || head.startsWith("<Environment");
+}
+
+qint64 TestlibXmlParser::getBytesParsed() const
+{
+    return m_bytesParsed;
+}
+
+bool TestlibXmlParser::parse(const QString &tlogFilePath,
+                             const QSharedPointer<Library> &library,
+                             qint64 timestamp)
+{
+    QFileInfo tlogFileInfo(tlogFilePath);
+    if (library.isNull() || not tlogFileInfo.exists())
+    {
+        return false;
+    }
+
+    QFile tlogFile(tlogFilePath);
+    if (not tlogFile.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    m_tlogFilePath = tlogFilePath;
+    m_library = library;
+    m_timestamp = timestamp;
+    m_bytesParsed = 0;
+    m_testcase.clear();
+
+    QXmlStreamReader reader;
+    reader.addData(QByteArray("<") + rootElement + ">");
+    bool rootClosed = false;
+    while (true)
+    {
+        while (not reader.atEnd())
+        {
+            reader.readNext();
+            if (reader.isStartElement())
+            {
+                handleStartElement(reader);
+            }
+            else if (reader.isEndElement())
+            {
+                handleEndElement(reader);
+            }
+            else if (reader.isCharacters() && m_text)
+            {
+                m_text->append(reader.text());
+            }
+        }
+
+        if (reader.error() != QXmlStreamReader::PrematureEndOfDocumentError || rootClosed)
+        {
+            break;
+        }
+        if (tlogFile.atEnd())
+        {
+            reader.addData(QByteArray("</") + rootElement + ">");
+            rootClosed = true;
+            continue;
+        }
+
+        // feed whole lines and blank out xml declarations, which are only allowed once
+        QByteArray chunk;
+        while (chunk.size() < chunkSize && not tlogFile.atEnd())
+        {
+            QByteArray line = tlogFile.readLine();
+            m_bytesParsed += line.size();
+            if (line.trimmed().startsWith("<?xml"))
+            {
+                int declarationEnd = line.indexOf("?>");
+                line = declarationEnd < 0 ? QByteArray("\n") : line.mid(declarationEnd + 2);
+            }
+            chunk.append(line);
+        }
+        reader.addData(chunk);
+    }
+
+    if (not m_testcase.isNull())
+    {
+        // lightxml output has no enclosing TestCase element
+        endTestcase(static_cast<int>(reader.lineNumber()) - 1);
+    }
+    m_library.clear();
+    return not reader.hasError() || reader.error() == QXmlStreamReader::PrematureEndOfDocumentError;
+}
+
+void TestlibXmlParser::handleStartElement(QXmlStreamReader &reader)
+{
+    QXmlStreamAttributes attributes = reader.attributes();
+    QStringRef name = reader.name();
+    int line = static_cast<int>(reader.lineNumber()) - 1;
+
+    if (name == "TestCase")
+    {
+        beginTestcase(attributes.value("name").toString(), line);
+    }
+    else if (name == "TestFunction")
+    {
+        if (m_testcase.isNull())
+        {
+            beginTestcase(m_library->getName(), line);
+        }
+        m_functionName = attributes.value("name").toString();
+        m_functionFirstResult = m_testfunctions.size();
+    }
+    else if (name == "Incident" ||
+             (name == "Message" && attributes.value("type") == "skip"))
+    {
+        m_inIncident = true;
+        m_incidentType = attributes.value("type").toString();
+        m_incidentFile = attributes.value("file").toString();
+        m_incidentLine = attributes.value("line").toString().toInt();
+        m_dataTag.clear();
+        m_description.clear();
+    }
+    else if (name == "DataTag" && m_inIncident)
+    {
+        m_text = &m_dataTag;
+    }
+    else if (name == "Description" && m_inIncident)
+    {
+        m_text = &m_description;
+    }
+    else if (name == "BenchmarkResult")
+    {
+        recordBenchmarkResult(attributes);
+    }
+    else if (name == "Duration")
+    {
+        double msecs = attributes.value("msecs").toString().toDouble();
+        if (not m_functionName.isEmpty())
+        {
+            for (int i = m_functionFirstResult; i < m_testfunctions.size(); ++i)
+            {
+                m_testfunctions[i].withDuration(msecs);
+            }
+        }
+        else
+        {
+            m_testcaseDuration = msecs;
+        }
+    }
+}
+
+void TestlibXmlParser::handleEndElement(QXmlStreamReader &reader)
+{
+    QStringRef name = reader.name();
+    if (name == "DataTag" || name == "Description")
+    {
+        m_text = 0;
+    }
+    else if ((name == "Incident" || name == "Message") && m_inIncident)
+    {
+        recordIncident();
+        m_inIncident = false;
+    }
+    else if (name == "TestFunction")
+    {
+        m_functionName.clear();
+    }
+    else if (name == "TestCase" && not m_testcase.isNull())
+    {
+        endTestcase(static_cast<int>(reader.lineNumber()) - 1);
+    }
+}
+
+void TestlibXmlParser::beginTestcase(const QString &name, int startLine)
+{
+    m_testcaseStartLine = startLine;
+    m_passed = 0;
+    m_failed = 0;
+    m_skipped = 0;
+    m_testcaseDuration = -1.0;
+    m_testfunctions.clear();
+    m_benchmarkResults.clear();
+    m_failLog.clear();
+    m_functionName.clear();
+
+    m_testcase = m_library->getTestcase(name);
+    if (m_testcase.isNull())
+    {
+        m_testcase = QSharedPointer<Testcase>(new Testcase());
+        m_testcase->withName(name);
+        m_library->addTestcase(m_testcase);
+    }
+}
+
+void TestlibXmlParser::recordIncident()
+{
+    if (m_testcase.isNull())
+    {
+        return;
+    }
+
+    // count like the "Totals:" line of the plain text output, blacklisted results are ignored
+    if (m_incidentType == "pass" || m_incidentType == "xfail")
+    {
+        ++m_passed;
+    }
+    else if (m_incidentType == "fail" || m_incidentType == "xpass")
+    {
+        ++m_failed;
+        QString function = m_functionName;
+        if (not m_dataTag.isEmpty())
+        {
+            function = QString("%1(%2)").arg(function).arg(m_dataTag);
+        }
+        m_failLog << QString("FAIL!  : %1::%2() %3")
+                     .arg(m_testcase->getName()).arg(function).arg(m_description.trimmed());
+        m_failLog << QString("   Loc: [%1(%2)]").arg(m_incidentFile).arg(m_incidentLine);
+    }
+    else if (m_incidentType == "skip")
+    {
+        ++m_skipped;
+    }
+
+    Testfunction testfunction;
+    testfunction.withName(m_functionName).withDataTag(m_dataTag).withIncident(m_incidentType)
+            .withLocation(m_incidentFile, m_incidentLine);
+    m_testfunctions.append(testfunction);
+}
+
+void TestlibXmlParser::recordBenchmarkResult(const QXmlStreamAttributes &attributes)
+{
+    // <BenchmarkResult metric="WalltimeMilliseconds" tag="" value="0.0003" iterations="262144" />
+    if (m_testcase.isNull() || m_functionName.isEmpty())
+    {
+        return;
+    }
+    QString key = m_functionName;
+    QString tag = attributes.value("tag").toString();
+    if (not tag.isEmpty())
+    {
+        key = QString("%1(%2)").arg(key).arg(tag);
+    }
+    QString unit = BenchmarkResult::unitFromMetric(attributes.value("metric").toString());
+
+    BenchmarkResult result;
+    result.withValue(attributes.value("value").toString().toDouble())
+            .withIterations(attributes.value("iterations").toString().toInt())
+            .withUnit(unit)
+            .withBackend(BenchmarkResult::backendFromUnit(unit));
+    m_benchmarkResults.append(QPair<QString, BenchmarkResult>(key, result));
+}
+
+void TestlibXmlParser::endTestcase(int endLine)
+{
+    m_testcase->withTlogPath(m_tlogFilePath, m_testcaseStartLine, endLine);
+    if (m_testcase->getTestrun(m_timestamp).isNull())
+    {
+        QString failLogAsString("");
+        if (m_failed > 0)
+        {
+            failLogAsString = m_failLog.join("\n");
+        }
+
+        QSharedPointer<Testrun> testrun(new Testrun());
+        testrun->withFailLog(failLogAsString)
+                .withResults(m_passed, m_failed, m_skipped)
+                .withDuration(m_testcaseDuration)
+                .withTimestamp(m_timestamp);
+        foreach (const Testfunction &testfunction, m_testfunctions)
+        {
+            m_testcase->recordTestfunction(testrun, testfunction);
+        }
+        for (int i = 0; i < m_benchmarkResults.size(); ++i)
+        {
+            m_testcase->recordBenchmarkResult(testrun, m_benchmarkResults.at(i).first,
+                                              m_benchmarkResults.at(i).second);
+        }
+        m_testcase->addTestrun(testrun);
+    }
+    m_testcase.clear();
+    m_testfunctions.clear();
+    m_benchmarkResults.clear();
+    m_failLog.clear();
+}
@@ -0,0 +1,248 @@
+/**
+  * @file TlogMarkerScanner.cpp
+  *
+  * @class TlogMarkerScanner
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Finds testlib marker lines in a tlog buffer
+  * @details The marker scanner jumps from one line starting with a marker character to the next
+  *          one and only counts the lines in between. On x86 it compares 32 bytes (AVX2) or 16
+  *          bytes (SSE2) at a time, elsewhere it falls back to a memchr based scalar loop.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#include "TlogMarkerScanner.h"
+
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+#define UTM_MARKER_SCANNER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace
+{
+
+inline int countBits(unsigned int mask)
+{
+#if defined(__GNUC__)
+    return __builtin_popcount(mask);
+#else
+    int count = 0;
+    for (; mask; mask &= mask - 1)
+    {
+        ++count;
+    }
+    return count;
+#endif
+}
+
+inline int lowestBit(unsigned int mask)
+{
+#if defined(__GNUC__)
+    return __builtin_ctz(mask);
+#else
+    int bit = 0;
+    while (not (mask & 1u))
+    {
+        mask >>= 1;
+        ++bit;
+    }
+    return bit;
+#endif
+}
+
+#if defined(UTM_MARKER_SCANNER_X86)
+bool hasAvx2()
+{
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+}
+#endif
+
+} // namespace
+
+TlogMarkerScanner::TlogMarkerScanner(const char *data, qint64 size, const char *markers)
+    : m_data(data),
+      m_size(data ? size : 0),
+      m_position(0),
+      m_lineIndex(0),
+      m_markersCount(0)
+{
+    std::memset(m_isMarker, 0, sizeof(m_isMarker));
+    for (const char *marker = markers; marker && *marker; ++marker)
+    {
+        // every marker is compared per vector, more than fit here would be missed silently
+        Q_ASSERT(m_markersCount < maxMarkersCount);
+        if (m_markersCount >= maxMarkersCount)
+        {
+            break;
+        }
+        m_markers[m_markersCount++] = *marker;
+        m_isMarker[static_cast<unsigned char>(*marker)] = true;
+    }
+}
+
+const char* TlogMarkerScanner::instructionSet()
+{
+#if defined(UTM_MARKER_SCANNER_X86)
+    return hasAvx2() ? "AVX2" : "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+bool TlogMarkerScanner::nextMarkerLine(const char *&line, int &length, int &lineNumber)
+{
+    if (m_position >= m_size)
+    {
+        return false;
+    }
+    if (not m_isMarker[static_cast<unsigned char>(m_data[m_position])])
+    {
+        m_position = skipToMarkerLine(m_position);
+    }
+    return nextLine(line, length, lineNumber);
+}
+
+bool TlogMarkerScanner::nextLine(const char *&line, int &length, int &lineNumber)
+{
+    if (m_position >= m_size)
+    {
+        return false;
+    }
+    const char *lineStart = m_data + m_position;
+    const char *lineEnd = static_cast<const char*>(
+                std::memchr(lineStart, '\n', static_cast<size_t>(m_size - m_position)));
+    if (not lineEnd)
+    {
+        lineEnd = m_data + m_size;
+    }
+    line = lineStart;
+    length = static_cast<int>(lineEnd - lineStart);
+    lineNumber = ++m_lineIndex;
+    m_position = (lineEnd - m_data) + 1;
+    return true;
+}
+
+/**
+  * @brief Returns the start of the next line beginning with a marker, or the end of the buffer.
+  * @details The line at position is known not to be a marker line. Every newline passed on the
+  *          way increments the line index.
+  */
+qint64 TlogMarkerScanner::skipToMarkerLine(qint64 position)
+{
+#if defined(UTM_MARKER_SCANNER_X86)
+    if (hasAvx2())
+    {
+        position = skipAvx2(position);
+    }
+    else
+    {
+        position = skipSse2(position);
+    }
+#endif
+    return skipScalar(position);
+}
+
+qint64 TlogMarkerScanner::skipScalar(qint64 position)
+{
+    while (position < m_size)
+    {
+        const char *newline = static_cast<const char*>(
+                    std::memchr(m_data + position, '\n', static_cast<size_t>(m_size - position)));
+        if (not newline)
+        {
+            return m_size;
+        }
+        ++m_lineIndex;
+        position = (newline - m_data) + 1;
+        if (position < m_size && m_isMarker[static_cast<unsigned char>(m_data[position])])
+        {
+            return position;
+        }
+    }
+    return m_size;
+}
+
+#if defined(UTM_MARKER_SCANNER_X86)
+
+qint64 TlogMarkerScanner::skipSse2(qint64 position)
+{
+    const __m128i newline = _mm_set1_epi8('\n');
+    // each block also reads the byte after it, the first byte of the following line
+    while (position + 17 <= m_size)
+    {
+        const __m128i block =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_data + position));
+        const __m128i next =
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_data + position + 1));
+        __m128i markers = _mm_setzero_si128();
+        for (int i = 0; i < m_markersCount; ++i)
+        {
+            markers = _mm_or_si128(markers, _mm_cmpeq_epi8(next, _mm_set1_epi8(m_markers[i])));
+        }
+        unsigned int newlineMask =
+                static_cast<unsigned int>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, newline)));
+        unsigned int hitMask =
+                newlineMask & static_cast<unsigned int>(_mm_movemask_epi8(markers));
+        if (hitMask)
+        {
+            // stop at the newline in front of the marker line, the scalar loop consumes it
+            int bit = lowestBit(hitMask);
+            m_lineIndex += countBits(newlineMask & ((1u << bit) - 1u));
+            return position + bit;
+        }
+        m_lineIndex += countBits(newlineMask);
+        position += 16;
+    }
+    return position;
+}
+
+__attribute__((target("avx2")))
+qint64 TlogMarkerScanner::skipAvx2(qint64 position)
+{
+    const __m256i newline = _mm256_set1_epi8('\n');
+    while (position + 33 <= m_size)
+    {
+        const __m256i block =
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m_data + position));
+        const __m256i next =
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(m_data + position + 1));
+        __m256i markers = _mm256_setzero_si256();
+        for (int i = 0; i < m_markersCount; ++i)
+        {
+            markers = _mm256_or_si256(
+                        markers, _mm256_cmpeq_epi8(next, _mm256_set1_epi8(m_markers[i])));
+        }
+        unsigned int newlineMask = static_cast<unsigned int>(
+                    _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, newline)));
+        unsigned int hitMask =
+                newlineMask & static_cast<unsigned int>(_mm256_movemask_epi8(markers));
+        if (hitMask)
+        {
+            int bit = lowestBit(hitMask);
+            m_lineIndex += countBits(newlineMask & ((1u << bit) - 1u));
+            return position + bit;
+        }
+        m_lineIndex += countBits(newlineMask);
+        position += 32;
+    }
+    return position;
+}
+
+#else
+
+qint64 TlogMarkerScanner::skipSse2(qint64 position)
+{
+    return position;
+}
+
+qint64 TlogMarkerScanner::skipAvx2(qint64 position)
+{
+    return position;
+}
+
+#endif
@@ -0,0 +1,705 @@
+/**
+  * @file TlogParser.cpp
+  *
+  * @class TlogParser
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Parses Qt testlib plain text tlogs into the model
+  * @details The tlog parser memory maps a tlog and lets a TlogMarkerScanner jump between the lines
+  *          starting with a testlib marker. Only those lines and the lines of a fail log are
+  *          decoded into strings. The incident lines and QBENCHMARK results of the single test
+  *          functions are recorded with the testrun of their testcase. If a tlog cannot be
+  *          mapped it is read into memory and parsed the same way. The bytes of every testcase
+  *          segment are hashed, a testrun repeating the segment of the testrun before it is
+  *          skipped. In tail mode the parser keeps its state and the offset behind the last
+  *          complete line of a tlog, so parseAppended() maps only the bytes written since; a
+  *          testcase whose totals are not written yet gets a testrun in progress. A hash of the
+  *          bytes in front of the offset tells a tlog rewritten by the next test execution. A tail
+  *          whose tlog stopped growing is closed by abortTestcase().
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#include "TlogParser.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFileInfo>
+#include <algorithm>
+#include <cstring>
+
+#include <TlogMarkerScanner.h>
+#include <Model/Testrun.h>
+
+using Model::Library;
+using Model::Testcase;
+using Model::Testrun;
+using Model::Testfunction;
+using Model::BenchmarkResult;
+
+namespace
+{
+
+const char markerBegin[] = "********* Start ";
+const char markerEnd[] = "********* Finished testing of ";
+const char markerEndOfLine[] = " *********";
+const char markerSummary[] = "Totals: ";
+const char markerFailBegin[] = "FAIL!";
+const char markerFailEnd[] = "   Loc:";
+const char markerBenchmark[] = "RESULT : ";
+const char markers[] = "*FTPSXBR";
+// bytes in front of the tail offset that have to stay the same for a tail to go on
+const qint64 tailAnchorSize = 4096;
+
+// incident labels of the plain text logger and their testlib xml incident types
+struct IncidentLabel
+{
+    const char *label;
+    int length;
+    const char *incident;
+};
+
+const IncidentLabel incidentLabels[] =
+{
+    { "PASS   : ", 9, "pass" },
+    { "FAIL!  : ", 9, "fail" },
+    { "SKIP   : ", 9, "skip" },
+    { "XFAIL  : ", 9, "xfail" },
+    { "XPASS  : ", 9, "xpass" },
+    { "BPASS  : ", 9, "bpass" },
+    { "BFAIL  : ", 9, "bfail" },
+    { "BXFAIL : ", 9, "bxfail" },
+    { "BXPASS : ", 9, "bxpass" }
+};
+
+template <int N>
+inline bool startsWith(const char *line, int length, const char (&pattern)[N])
+{
+    return length >= N - 1 && std::memcmp(line, pattern, N - 1) == 0;
+}
+
+template <int N>
+inline bool endsWith(const char *line, int length, const char (&pattern)[N])
+{
+    return length >= N - 1 && std::memcmp(line + length - (N - 1), pattern, N - 1) == 0;
+}
+
+} // namespace
+
+TlogParser::TlogParser()
+    : m_timestamp(0),
+      m_bytesParsed(0),
+      m_lineNumber(0),
+      m_testcaseStartLine(0),
+      m_testcaseBegin(0),
+      m_segmentHash(QCryptographicHash::Sha1),
+      m_testcaseOpen(false),
+      m_tailOffset(0),
+      m_lineBase(0),
+      m_tailAnchorSize(0),
+      m_inFailLogOutput(false)
+{
+}
+
+qint64 TlogParser::getBytesParsed() const
+{
+    return m_bytesParsed;
+}
+
+void TlogParser::reset(const QString &tlogFilePath,
+                       const QSharedPointer<Library> &library,
+                       qint64 timestamp)
+{
+    m_tlogFilePath = tlogFilePath;
+    m_library = library;
+    m_timestamp = timestamp;
+    m_bytesParsed = 0;
+    m_testcase.clear();
+    m_lineNumber = 0;
+    m_testcaseStartLine = 0;
+    m_testcaseBegin = 0;
+    m_segmentHash.reset();
+    m_testcaseOpen = false;
+    m_tailOffset = 0;
+    m_lineBase = 0;
+    m_tailAnchor.clear();
+    m_tailAnchorSize = 0;
+    m_failLog.clear();
+    m_testfunctions.clear();
+    m_benchmarkKey.clear();
+    m_benchmarkResults.clear();
+    m_inFailLogOutput = false;
+}
+
+bool TlogParser::parseTotals(const QString &line, qint32 &passed, qint32 &failed,
+                             qint32 &skipped, double &msecs)
+{
+    // "Totals: 9 passed, 0 failed, 0 skipped" of Qt 4 and
+    // "Totals: 9 passed, 0 failed, 0 skipped, 0 blacklisted, 12ms" of Qt 5
+    QStringList parts = QString(line).replace(markerSummary, "").split(",");
+    if (parts.size() < 3)
+    {
+        return false;
+    }
+    passed = parts.at(0).trimmed().replace("passed", "").trimmed().toInt();
+    failed = parts.at(1).trimmed().replace("failed", "").trimmed().toInt();
+    skipped = parts.at(2).trimmed().replace("skipped", "").trimmed().toInt();
+    for (int i = 3; i < parts.size(); ++i)
+    {
+        // blacklisted results are not counted, like in the xml parser
+        QString part = parts.at(i).trimmed();
+        if (part.endsWith("ms"))
+        {
+            bool valid = false;
+            double value = part.left(part.size() - 2).trimmed().toDouble(&valid);
+            if (valid)
+            {
+                msecs = value;
+            }
+        }
+    }
+    return true;
+}
+
+bool TlogParser::parse(const QString &tlogFilePath,
+                       const QSharedPointer<Library> &library,
+                       qint64 timestamp)
+{
+    QFileInfo tlogFileInfo(tlogFilePath);
+    if (library.isNull() || not tlogFileInfo.exists())
+    {
+        return false;
+    }
+
+    QFile tlogFile(tlogFilePath);
+    if (not tlogFile.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    qint64 size = tlogFile.size();
+    if (size == 0)
+    {
+        reset(tlogFilePath, library, timestamp);
+        return true;
+    }
+
+    const uchar *data = tlogFile.map(0, size);
+    if (not data)
+    {
+        QByteArray content = tlogFile.readAll();
+        return parseData(content.constData(), content.size(), tlogFilePath, library, timestamp);
+    }
+
+    bool result = parseData(reinterpret_cast<const char*>(data), size,
+                            tlogFilePath, library, timestamp);
+    tlogFile.unmap(const_cast<uchar*>(data));
+    return result;
+}
+
+bool TlogParser::parseData(const char *data, qint64 size,
+                           const QString &tlogFilePath,
+                           const QSharedPointer<Library> &library,
+                           qint64 timestamp)
+{
+    reset(tlogFilePath, library, timestamp);
+    if (library.isNull() || not data)
+    {
+        return false;
+    }
+
+    parseLines(data, size);
+    m_bytesParsed = size;
+    m_tailOffset = size;
+    return true;
+}
+
+bool TlogParser::parseAppended(const QString &tlogFilePath,
+                               const QSharedPointer<Library> &library,
+                               qint64 timestamp)
+{
+    if (library.isNull())
+    {
+        return false;
+    }
+    QFile tlogFile(tlogFilePath);
+    if (not tlogFile.open(QIODevice::ReadOnly))
+    {
+        return false;
+    }
+
+    qint64 size = tlogFile.size();
+    if (tlogFilePath != m_tlogFilePath || library != m_library || size < m_tailOffset ||
+            not hasTailAnchor(tlogFile))
+    {
+        // a new tlog, or the old one was truncated or rewritten by the next test execution
+        reset(tlogFilePath, library, timestamp);
+    }
+    if (size == m_tailOffset)
+    {
+        return true;
+    }
+
+    // the appended bytes are mapped like a whole tlog, read only if they cannot be mapped
+    qint64 length = size - m_tailOffset;
+    QByteArray appended;
+    uchar *mapped = tlogFile.map(m_tailOffset, length);
+    const char *data = reinterpret_cast<const char*>(mapped);
+    if (not mapped)
+    {
+        if (not tlogFile.seek(m_tailOffset))
+        {
+            return true;
+        }
+        appended = tlogFile.read(length);
+        data = appended.constData();
+        length = appended.size();
+    }
+
+    // an incomplete last line is parsed again with the next appended bytes
+    qint64 complete = length;
+    while (complete > 0 && data[complete - 1] != '\n')
+    {
+        --complete;
+    }
+    if (complete > 0)
+    {
+        parseLines(data, complete);
+        m_lineBase += static_cast<int>(std::count(data, data + complete, '\n'));
+        m_tailOffset += complete;
+        m_bytesParsed += complete;
+        m_tailAnchorSize = qMin(complete, tailAnchorSize);
+        m_tailAnchor = QCryptographicHash::hash(
+                    QByteArray::fromRawData(data + complete - m_tailAnchorSize,
+                                            static_cast<int>(m_tailAnchorSize)),
+                    QCryptographicHash::Sha1);
+        updateTestrunInProgress();
+    }
+    if (mapped)
+    {
+        tlogFile.unmap(mapped);
+    }
+    return true;
+}
+
+bool TlogParser::hasTailAnchor(QFile &tlogFile)
+{
+    if (m_tailAnchorSize == 0)
+    {
+        return true;
+    }
+    if (not tlogFile.seek(m_tailOffset - m_tailAnchorSize))
+    {
+        return false;
+    }
+    return QCryptographicHash::hash(tlogFile.read(m_tailAnchorSize),
+                                    QCryptographicHash::Sha1) == m_tailAnchor;
+}
+
+bool TlogParser::isTestcaseOpen() const
+{
+    return m_testcaseOpen;
+}
+
+void TlogParser::abortTestcase()
+{
+    if (m_testcaseOpen && not m_testcase.isNull())
+    {
+        // the testrun in progress keeps what was logged before the tlog stopped growing
+        QSharedPointer<Testrun> testrun = m_testcase->getTestrun(m_timestamp);
+        if (not testrun.isNull() && testrun->isInProgress())
+        {
+            testrun->withInProgress(false).withAborted(true);
+        }
+        endTestcase();
+    }
+    m_testcaseOpen = false;
+}
+
+qint64 TlogParser::getTailOffset() const
+{
+    return m_tailOffset;
+}
+
+void TlogParser::parseLines(const char *data, qint64 size)
+{
+    if (m_testcaseOpen)
+    {
+        // the segment of the open testcase continues in these bytes
+        m_testcaseBegin = data;
+    }
+
+    // only lines starting with a marker character are handed out, except within a fail log
+    TlogMarkerScanner scanner(data, size, markers);
+    const char *line = 0;
+    int length = 0;
+    int lineNumber = 0;
+    while ((m_inFailLogOutput || not m_benchmarkKey.isEmpty())
+           ? scanner.nextLine(line, length, lineNumber)
+           : scanner.nextMarkerLine(line, length, lineNumber))
+    {
+        handleLine(line, length, m_lineBase + lineNumber);
+    }
+
+    if (m_testcaseOpen && m_testcaseBegin)
+    {
+        m_segmentHash.addData(m_testcaseBegin, static_cast<int>(data + size - m_testcaseBegin));
+    }
+    m_testcaseBegin = 0;
+}
+
+void TlogParser::handleLine(const char *line, int length, int lineNumber)
+{
+    m_lineNumber = lineNumber;
+    if (length > 0 && line[length - 1] == '\r')
+    {
+        --length;
+    }
+    if (not m_benchmarkKey.isEmpty())
+    {
+        // the value of a benchmark result follows on the line after its "RESULT : " line
+        QString text = QString::fromLocal8Bit(line, length).trimmed();
+        if (text.contains(" per iteration"))
+        {
+            recordBenchmarkResult(text);
+            return;
+        }
+        if (not text.isEmpty())
+        {
+            m_benchmarkKey.clear();
+        }
+    }
+
+    bool isMarkerLine = length > 0 && line[0] != '\0' && std::strchr(markers, line[0]);
+    if (not m_inFailLogOutput && not isMarkerLine)
+    {
+        // plain test output, nothing to decode
+        return;
+    }
+
+    if (startsWith(line, length, markerBenchmark))
+    {
+        beginBenchmarkResult(line + sizeof(markerBenchmark) - 1,
+                             length - static_cast<int>(sizeof(markerBenchmark) - 1));
+        return;
+    }
+
+    if (isMarkerLine && line[0] != '*' && line[0] != 'T')
+    {
+        for (unsigned int i = 0; i < sizeof(incidentLabels) / sizeof(incidentLabels[0]); ++i)
+        {
+            const IncidentLabel &label = incidentLabels[i];
+            if (length >= label.length && std::memcmp(line, label.label, label.length) == 0)
+            {
+                recordIncident(line + label.length, length - label.length, label.incident);
+                break;
+            }
+        }
+    }
+
+    bool beginsTestcase = startsWith(line, length, markerBegin) &&
+            endsWith(line, length, markerEndOfLine);
+    if (beginsTestcase)
+    {
+        beginTestcase(line, length);
+    }
+
+    if (startsWith(line, length, markerFailBegin))
+    {
+        m_inFailLogOutput = true;
+    }
+    if (m_inFailLogOutput)
+    {
+        if (beginsTestcase)
+        {
+            // a Start line within a fail log is logged without its marker
+            m_failLog << QString::fromLocal8Bit(line, length)
+                         .replace(markerBegin, "").replace(markerEndOfLine, "");
+        }
+        else
+        {
+            m_failLog << QString::fromLocal8Bit(line, length);
+        }
+        if (startsWith(line, length, markerFailEnd))
+        {
+            recordLocation(line, length);
+            m_inFailLogOutput = false;
+        }
+    }
+
+    if (startsWith(line, length, markerSummary))
+    {
+        recordTotals(line, length);
+    }
+
+    if (startsWith(line, length, markerEnd) && endsWith(line, length, markerEndOfLine))
+    {
+        endTestcase();
+    }
+}
+
+void TlogParser::beginTestcase(const char *line, int length)
+{
+    m_testcaseStartLine = m_lineNumber - 1;
+    m_testcaseBegin = line;
+    m_segmentHash.reset();
+    m_testcaseOpen = true;
+    m_failLog.clear();
+    m_testfunctions.clear();
+    m_benchmarkResults.clear();
+    QString testcaseName = QString::fromLocal8Bit(line, length)
+            .replace(markerBegin, "").replace(markerEndOfLine, "")
+            .split("::").last();
+    m_testcase = m_library->getTestcase(testcaseName);
+    if (m_testcase.isNull())
+    {
+        m_testcase = QSharedPointer<Testcase>(new Testcase());
+        m_testcase->withName(testcaseName);
+        m_library->addTestcase(m_testcase);
+    }
+}
+
+void TlogParser::recordIncident(const char *line, int length, const QString &incident)
+{
+    // "TestClass::function(data tag) optional description"
+    QString text = QString::fromLocal8Bit(line, length);
+    int nameBegin = text.indexOf("::");
+    if (nameBegin < 0)
+    {
+        return;
+    }
+    nameBegin += 2;
+    int nameEnd = nameBegin;
+    while (nameEnd < text.size() && text.at(nameEnd) != '(' && text.at(nameEnd) != ' ')
+    {
+        ++nameEnd;
+    }
+    QString dataTag;
+    if (nameEnd < text.size() && text.at(nameEnd) == '(')
+    {
+        // data tags may contain parentheses themselves, the tag ends at ") " or the line end
+        int tagEnd = text.indexOf(") ", nameEnd + 1);
+        if (tagEnd < 0)
+        {
+            tagEnd = text.endsWith(')') ? text.size() - 1 : -1;
+        }
+        if (tagEnd > nameEnd)
+        {
+            dataTag = text.mid(nameEnd + 1, tagEnd - nameEnd - 1);
+        }
+    }
+
+    Testfunction testfunction;
+    testfunction.withName(text.mid(nameBegin, nameEnd - nameBegin))
+            .withDataTag(dataTag)
+            .withIncident(incident);
+    m_testfunctions.append(testfunction);
+}
+
+void TlogParser::recordLocation(const char *line, int length)
+{
+    // "   Loc: [/path/to/tst_file.cpp(42)]"
+    if (m_testfunctions.isEmpty())
+    {
+        return;
+    }
+    QString location = QString::fromLocal8Bit(line, length).mid(sizeof(markerFailEnd) - 1)
+            .trimmed();
+    if (location.startsWith('[') && location.endsWith(")]"))
+    {
+        int lineBegin = location.lastIndexOf('(');
+        if (lineBegin > 1)
+        {
+            m_testfunctions.last().withLocation(
+                        location.mid(1, lineBegin - 1),
+                        location.mid(lineBegin + 1, location.size() - lineBegin - 3).toInt());
+        }
+    }
+}
+
+void TlogParser::beginBenchmarkResult(const char *line, int length)
+{
+    // "TestClass::function():" or "TestClass::function():\"data tag\":", the value may follow on
+    // the same line or on the next one
+    QString text = QString::fromLocal8Bit(line, length);
+    int nameBegin = text.indexOf("::");
+    int nameEnd = text.indexOf("():", nameBegin);
+    if (nameBegin < 0 || nameEnd < 0)
+    {
+        return;
+    }
+    nameBegin += 2;
+    QString name = text.mid(nameBegin, nameEnd - nameBegin);
+    int rest = nameEnd + 3;
+    if (text.mid(rest).startsWith('"'))
+    {
+        int tagEnd = text.indexOf("\":", rest + 1);
+        if (tagEnd > rest)
+        {
+            name = QString("%1(%2)").arg(name).arg(text.mid(rest + 1, tagEnd - rest - 1));
+            rest = tagEnd + 2;
+        }
+    }
+
+    m_benchmarkKey = name;
+    QString value = text.mid(rest).trimmed();
+    if (not value.isEmpty())
+    {
+        recordBenchmarkResult(value);
+    }
+}
+
+void TlogParser::recordBenchmarkResult(const QString &text)
+{
+    // "0.00030 msecs per iteration (total: 79, iterations: 262144)"
+    QString key = m_benchmarkKey;
+    m_benchmarkKey.clear();
+    int unitEnd = text.indexOf(" per iteration");
+    int valueEnd = text.indexOf(' ');
+    if (unitEnd < 0 || valueEnd < 0 || valueEnd >= unitEnd)
+    {
+        return;
+    }
+
+    bool valid = false;
+    double value = text.left(valueEnd).remove(',').toDouble(&valid);
+    if (not valid)
+    {
+        return;
+    }
+    QString unit = text.mid(valueEnd + 1, unitEnd - valueEnd - 1).trimmed();
+    int iterations = 0;
+    int iterationsBegin = text.indexOf("iterations: ", unitEnd);
+    if (iterationsBegin >= 0)
+    {
+        iterationsBegin += 12;
+        int iterationsEnd = text.indexOf(')', iterationsBegin);
+        iterations = text.mid(iterationsBegin, iterationsEnd - iterationsBegin)
+                .remove(',').trimmed().toInt();
+    }
+
+    BenchmarkResult result;
+    result.withValue(value)
+            .withIterations(iterations)
+            .withUnit(unit)
+            .withBackend(BenchmarkResult::backendFromUnit(unit));
+    m_benchmarkResults.append(QPair<QString, BenchmarkResult>(key, result));
+}
+
+void TlogParser::recordTotals(const char *line, int length)
+{
+    if (m_testcase.isNull())
+    {
+        return;
+    }
+
+    qint32 passed = 0, failed = 0, skipped = 0;
+    double msecs = -1.0;
+    parseTotals(QString::fromLocal8Bit(line, length), passed, failed, skipped, msecs);
+    QSharedPointer<Testrun> existing = m_testcase->getTestrun(m_timestamp);
+    if (existing.isNull() || existing->isInProgress())
+    {
+        QString failLogAsString("");
+        if (failed > 0)
+        {
+            failLogAsString = m_failLog.join("\n");
+        }
+
+        QSharedPointer<Testrun> testrun(new Testrun());
+        testrun->withFailLog(failLogAsString)
+                .withResults(passed, failed, skipped)
+                .withDuration(msecs)
+                .withTimestamp(m_timestamp);
+        if (m_testcaseOpen && m_testcaseBegin)
+        {
+            // the segment from the start marker up to the totals, which carry the duration
+            m_segmentHash.addData(m_testcaseBegin,
+                                  static_cast<int>(line + length - m_testcaseBegin));
+            testrun->withSegmentHash(m_segmentHash.result().toHex());
+        }
+        if (m_testcase->isRepeatedTestrun(testrun))
+        {
+            // drops the testrun in progress a tail left
+            m_testcase->deleteTestrun(m_timestamp);
+        }
+        else
+        {
+            foreach (const Testfunction &testfunction, m_testfunctions)
+            {
+                m_testcase->recordTestfunction(testrun, testfunction);
+            }
+            for (int i = 0; i < m_benchmarkResults.size(); ++i)
+            {
+                m_testcase->recordBenchmarkResult(testrun, m_benchmarkResults.at(i).first,
+                                                  m_benchmarkResults.at(i).second);
+            }
+            m_testcase->addTestrun(testrun);
+        }
+    }
+    m_testfunctions.clear();
+    m_benchmarkResults.clear();
+    m_testcaseBegin = 0;
+    m_testcaseOpen = false;
+}
+
+void TlogParser::endTestcase()
+{
+    if (m_testcase.isNull())
+    {
+        return;
+    }
+    m_testcase->withTlogPath(m_tlogFilePath, m_testcaseStartLine, m_lineNumber - 1);
+}
+
+void TlogParser::updateTestrunInProgress()
+{
+    if (m_testcase.isNull() || not m_testcaseOpen)
+    {
+        return;
+    }
+    QSharedPointer<Testrun> existing = m_testcase->getTestrun(m_timestamp);
+    if (not existing.isNull() && not existing->isInProgress())
+    {
+        return;
+    }
+
+    // counted like the totals of testlib, blacklisted results do not count
+    qint32 passed = 0, failed = 0, skipped = 0;
+    foreach (const Testfunction &testfunction, m_testfunctions)
+    {
+        switch (testfunction.getState())
+        {
+        case Testfunction::Passed:
+        case Testfunction::ExpectedFailure:
+            ++passed;
+            break;
+        case Testfunction::Failed:
+        case Testfunction::UnexpectedPass:
+            ++failed;
+            break;
+        case Testfunction::Skipped:
+            ++skipped;
+            break;
+        default:
+            break;
+        }
+    }
+
+    QSharedPointer<Testrun> testrun(new Testrun());
+    testrun->withFailLog(failed > 0 ? m_failLog.join("\n") : QString(""))
+            .withResults(passed, failed, skipped)
+            .withTimestamp(m_timestamp)
+            .withInProgress(true);
+    foreach (const Testfunction &testfunction, m_testfunctions)
+    {
+        m_testcase->recordTestfunction(testrun, testfunction);
+    }
+    for (int i = 0; i < m_benchmarkResults.size(); ++i)
+    {
+        m_testcase->recordBenchmarkResult(testrun, m_benchmarkResults.at(i).first,
+                                          m_benchmarkResults.at(i).second);
+    }
+    m_testcase->addTestrun(testrun);
+    m_testcase->withTlogPath(m_tlogFilePath, m_testcaseStartLine, m_lineNumber - 1);
+}
@@ -0,0 +1,557 @@
+/**
+  * @file UringReader.cpp
+  *
+  * @class UringReader
+  *
+  * @copyright (c) 2014, Robert Wloch
+  * @license LGPL v2.1
+  *
+  * @brief Reads a batch of small files through a Linux io_uring
+  * @details Instead of open, read, and close per file the reader submits the opens of a whole
+  *          window of files with one system call, then their reads with another one, and hands
+  *          every file to its Consumer as soon as its read completes, while the kernel still
+  *          reads the others. The closes go along with the next submission. The ring is set up
+  *          with raw system calls, no liburing is needed. If the kernel or the headers lack
+  *          io_uring the reader is not valid and callers keep using their own file access; a file
+  *          that fails in the ring is handed over without content, so the caller can fall back
+  *          for that file alone.
+  *
+  * @author Robert Wloch, robert@rowlo.de
+  *************************************************************************************************/
+#include "UringReader.h"
+
+#include <QFile>
+#include <QVector>
+
+#if defined(Q_OS_LINUX) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define UTM_IO_URING
+#endif
+#endif
+
+#ifdef UTM_IO_URING
+#include <linux/io_uring.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+
+// user data of the closes, whose completions are only counted
+const int closeIndex = -1;
+
+} // namespace
+
+UringReader::UringReader(int queueDepth)
+    : m_queueDepth(qBound(2, queueDepth, 4096)),
+      m_ringFd(-1),
+      m_sqRing(0),
+      m_cqRing(0),
+      m_sqes(0),
+      m_sqRingSize(0),
+      m_cqRingSize(0),
+      m_sqesSize(0),
+      m_sqHead(0),
+      m_sqTail(0),
+      m_sqMask(0),
+      m_sqArray(0),
+      m_cqHead(0),
+      m_cqTail(0),
+      m_cqMask(0),
+      m_cqes(0),
+      m_queued(0),
+      m_inFlight(0),
+      m_syscalls(0)
+{
+    setup();
+}
+
+UringReader::~UringReader()
+{
+    teardown();
+}
+
+bool UringReader::isSupported()
+{
+    UringReader probe(2);
+    return probe.isValid();
+}
+
+bool UringReader::isValid() const
+{
+    return m_ringFd >= 0;
+}
+
+int UringReader::getQueueDepth() const
+{
+    return m_queueDepth;
+}
+
+qint64 UringReader::getSyscalls() const
+{
+    return m_syscalls;
+}
+
+bool UringReader::setup()
+{
+#ifdef UTM_IO_URING
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    int ringFd = static_cast<int>(syscall(__NR_io_uring_setup, m_queueDepth, &params));
+    ++m_syscalls;
+    if (ringFd < 0)
+    {
+        // no io_uring in this kernel, or it is disabled by policy
+        return false;
+    }
+    m_ringFd = ringFd;
+    m_queueDepth = static_cast<int>(params.sq_entries);
+
+    m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+    if (singleMap)
+    {
+        m_sqRingSize = qMax(m_sqRingSize, m_cqRingSize);
+        m_cqRingSize = m_sqRingSize;
+    }
+    m_sqRing = mmap(0, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    m_ringFd, IORING_OFF_SQ_RING);
+    if (m_sqRing == MAP_FAILED)
+    {
+        m_sqRing = 0;
+        teardown();
+        return false;
+    }
+    m_cqRing = m_sqRing;
+    if (not singleMap)
+    {
+        m_cqRing = mmap(0, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                        m_ringFd, IORING_OFF_CQ_RING);
+        if (m_cqRing == MAP_FAILED)
+        {
+            m_cqRing = 0;
+            teardown();
+            return false;
+        }
+    }
+    m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    m_sqes = mmap(0, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                  m_ringFd, IORING_OFF_SQES);
+    if (m_sqes == MAP_FAILED)
+    {
+        m_sqes = 0;
+        teardown();
+        return false;
+    }
+    m_syscalls += singleMap ? 2 : 3;
+
+    char *sqRing = static_cast<char*>(m_sqRing);
+    char *cqRing = static_cast<char*>(m_cqRing);
+    m_sqHead = reinterpret_cast<unsigned*>(sqRing + params.sq_off.head);
+    m_sqTail = reinterpret_cast<unsigned*>(sqRing + params.sq_off.tail);
+    m_sqMask = reinterpret_cast<unsigned*>(sqRing + params.sq_off.ring_mask);
+    m_sqArray = reinterpret_cast<unsigned*>(sqRing + params.sq_off.array);
+    m_cqHead = reinterpret_cast<unsigned*>(cqRing + params.cq_off.head);
+    m_cqTail = reinterpret_cast<unsigned*>(cqRing + params.cq_off.tail);
+    m_cqMask = reinterpret_cast<unsigned*>(cqRing + params.cq_off.ring_mask);
+    m_cqes = cqRing + params.cq_off.cqes;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void UringReader::teardown()
+{
+#ifdef UTM_IO_URING
+    if (m_sqes)
+    {
+        munmap(m_sqes, m_sqesSize);
+    }
+    if (m_cqRing && m_cqRing != m_sqRing)
+    {
+        munmap(m_cqRing, m_cqRingSize);
+    }
+    if (m_sqRing)
+    {
+        munmap(m_sqRing, m_sqRingSize);
+    }
+    if (m_ringFd >= 0)
+    {
+        ::close(m_ringFd);
+    }
+#endif
+    m_ringFd = -1;
+    m_sqRing = 0;
+    m_cqRing = 0;
+    m_sqes = 0;
+    m_queued = 0;
+    m_inFlight = 0;
+}
+
+bool UringReader::readFiles(const QStringList &filePaths, const QList<qint64> &sizes,
+                            Consumer &consumer)
+{
+    if (filePaths.size() != sizes.size())
+    {
+        return false;
+    }
+
+    // the paths must outlive their submitted opens
+    QList<QByteArray> paths;
+    foreach (const QString &filePath, filePaths)
+    {
+        paths.append(QFile::encodeName(filePath));
+    }
+
+    bool result = isValid();
+    for (int begin = 0; begin < paths.size(); begin += m_queueDepth)
+    {
+        int end = qMin(begin + m_queueDepth, paths.size());
+        if (not isValid())
+        {
+            result = false;
+            for (int index = begin; index < end; ++index)
+            {
+                consumer.consume(index, QByteArray(), false);
+            }
+            continue;
+        }
+        readWindow(paths, sizes, begin, end, consumer);
+    }
+    return result && isValid();
+}
+
+bool UringReader::reserveEntry()
+{
+#ifdef UTM_IO_URING
+    // entries the kernel has not taken yet must not be overwritten, a full ring is submitted
+    unsigned capacity = static_cast<unsigned>(m_queueDepth);
+    if (*m_sqTail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE) < capacity)
+    {
+        return true;
+    }
+    return submit(0) && *m_sqTail - __atomic_load_n(m_sqHead, __ATOMIC_ACQUIRE) < capacity;
+#else
+    return false;
+#endif
+}
+
+bool UringReader::queueOpen(int index, const QByteArray &path)
+{
+#ifdef UTM_IO_URING
+    if (not reserveEntry())
+    {
+        return false;
+    }
+    unsigned tail = *m_sqTail;
+    unsigned slot = tail & *m_sqMask;
+    io_uring_sqe *sqe = static_cast<io_uring_sqe*>(m_sqes) + slot;
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_OPENAT;
+    sqe->fd = AT_FDCWD;
+    sqe->addr = reinterpret_cast<quint64>(path.constData());
+    sqe->open_flags = O_RDONLY | O_CLOEXEC;
+    sqe->user_data = static_cast<quint64>(static_cast<qint64>(index));
+    m_sqArray[slot] = slot;
+    __atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+    ++m_queued;
+    ++m_inFlight;
+    return true;
+#else
+    Q_UNUSED(index);
+    Q_UNUSED(path);
+    return false;
+#endif
+}
+
+bool UringReader::queueRead(int index, int fd, char *buffer, qint64 length, qint64 offset)
+{
+#ifdef UTM_IO_URING
+    if (not reserveEntry())
+    {
+        return false;
+    }
+    unsigned tail = *m_sqTail;
+    unsigned slot = tail & *m_sqMask;
+    io_uring_sqe *sqe = static_cast<io_uring_sqe*>(m_sqes) + slot;
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<quint64>(buffer);
+    sqe->len = static_cast<unsigned>(length);
+    sqe->off = static_cast<quint64>(offset);
+    sqe->user_data = static_cast<quint64>(static_cast<qint64>(index));
+    m_sqArray[slot] = slot;
+    __atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+    ++m_queued;
+    ++m_inFlight;
+    return true;
+#else
+    Q_UNUSED(index);
+    Q_UNUSED(fd);
+    Q_UNUSED(buffer);
+    Q_UNUSED(length);
+    Q_UNUSED(offset);
+    return false;
+#endif
+}
+
+bool UringReader::queueClose(int fd)
+{
+#ifdef UTM_IO_URING
+    if (not reserveEntry())
+    {
+        return false;
+    }
+    unsigned tail = *m_sqTail;
+    unsigned slot = tail & *m_sqMask;
+    io_uring_sqe *sqe = static_cast<io_uring_sqe*>(m_sqes) + slot;
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_CLOSE;
+    sqe->fd = fd;
+    sqe->user_data = static_cast<quint64>(static_cast<qint64>(closeIndex));
+    m_sqArray[slot] = slot;
+    __atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+    ++m_queued;
+    ++m_inFlight;
+    return true;
+#else
+    Q_UNUSED(fd);
+    return false;
+#endif
+}
+
+bool UringReader::submit(int minComplete)
+{
+#ifdef UTM_IO_URING
+    if (m_queued == 0 && minComplete == 0)
+    {
+        return true;
+    }
+    for (;;)
+    {
+        int submitted = static_cast<int>(
+                    syscall(__NR_io_uring_enter, m_ringFd, m_queued, minComplete,
+                            minComplete > 0 ? IORING_ENTER_GETEVENTS : 0, 0, 0));
+        ++m_syscalls;
+        if (submitted >= 0)
+        {
+            // entries the kernel did not take yet go along with the next submission
+            m_queued -= submitted;
+            return true;
+        }
+        if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+        {
+            return false;
+        }
+    }
+#else
+    Q_UNUSED(minComplete);
+    return false;
+#endif
+}
+
+bool UringReader::reap(int &index, int &result)
+{
+#ifdef UTM_IO_URING
+    unsigned head = *m_cqHead;
+    unsigned tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+    if (head == tail)
+    {
+        return false;
+    }
+    const io_uring_cqe *cqe = static_cast<const io_uring_cqe*>(m_cqes) + (head & *m_cqMask);
+    index = static_cast<int>(static_cast<qint64>(cqe->user_data));
+    result = cqe->res;
+    __atomic_store_n(m_cqHead, head + 1, __ATOMIC_RELEASE);
+    --m_inFlight;
+    return true;
+#else
+    Q_UNUSED(index);
+    Q_UNUSED(result);
+    return false;
+#endif
+}
+
+void UringReader::readWindow(const QList<QByteArray> &paths, const QList<qint64> &sizes,
+                             int begin, int end, Consumer &consumer)
+{
+#ifdef UTM_IO_URING
+    int count = end - begin;
+    QVector<int> fds(count, -1);
+    QVector<QByteArray> buffers(count);
+    QVector<qint64> filled(count, 0);
+    QVector<bool> done(count, false);
+    int closes = 0;
+    int index = 0;
+    int result = 0;
+
+    // phase 1: open the whole window with one submission
+    bool failed = false;
+    for (int i = 0; not failed && i < count; ++i)
+    {
+        failed = not queueOpen(begin + i, paths.at(begin + i));
+    }
+    failed = failed || not submit(count);
+    int opened = 0;
+    while (not failed && opened < count)
+    {
+        if (not reap(index, result))
+        {
+            failed = not submit(1);
+            continue;
+        }
+        if (index == closeIndex)
+        {
+            continue;
+        }
+        ++opened;
+        fds[index - begin] = result;
+        if (result == -EINVAL)
+        {
+            // the kernel has a ring but no openat for it, older than 5.6
+            failed = true;
+        }
+    }
+
+    // phase 2: read every opened file, one byte more than its size tells a growing tlog apart
+    int pending = 0;
+    for (int i = 0; not failed && i < count; ++i)
+    {
+        if (fds.at(i) < 0)
+        {
+            continue;
+        }
+        qint64 size = qMax(Q_INT64_C(0), sizes.at(begin + i));
+        buffers[i].resize(static_cast<int>(size + 1));
+        failed = not queueRead(begin + i, fds.at(i), buffers[i].data(), size + 1, 0);
+        pending += failed ? 0 : 1;
+    }
+    failed = failed || not submit(0);
+    for (int i = 0; not failed && i < count; ++i)
+    {
+        if (fds.at(i) < 0)
+        {
+            done[i] = true;
+            consumer.consume(begin + i, QByteArray(), false);
+        }
+    }
+
+    while (not failed && pending > 0)
+    {
+        if (not reap(index, result))
+        {
+            failed = not submit(1);
+            continue;
+        }
+        if (index == closeIndex)
+        {
+            --closes;
+            continue;
+        }
+        int i = index - begin;
+        qint64 expected = buffers.at(i).size() - 1;
+        if (result > 0)
+        {
+            filled[i] += result;
+        }
+        if (result > 0 && filled.at(i) < expected)
+        {
+            // short read, continue where it stopped
+            failed = not queueRead(index, fds.at(i), buffers[i].data() + filled.at(i),
+                                   expected + 1 - filled.at(i), filled.at(i));
+            continue;
+        }
+        --pending;
+        if (queueClose(fds.at(i)))
+        {
+            ++closes;
+        }
+        else
+        {
+            ::close(fds.at(i));
+        }
+        fds[i] = -1;
+        done[i] = true;
+        if (result < 0 || filled.at(i) > expected)
+        {
+            // a read error or a tlog that grew since it was listed
+            buffers[i].clear();
+            consumer.consume(index, QByteArray(), false);
+            continue;
+        }
+        buffers[i].resize(static_cast<int>(filled.at(i)));
+        consumer.consume(index, buffers.at(i), true);
+        buffers[i].clear();
+    }
+
+    // phase 3: the closes of this window
+    while (not failed && closes > 0)
+    {
+        if (not reap(index, result))
+        {
+            failed = not submit(closes);
+            continue;
+        }
+        if (index == closeIndex)
+        {
+            --closes;
+        }
+    }
+
+    if (failed)
+    {
+        // the kernel may still write into the buffers of submitted reads, they are waited for
+        bool opening = opened < count;
+        bool drained = true;
+        while (drained && m_inFlight > 0)
+        {
+            if (not reap(index, result))
+            {
+                drained = submit(1);
+                continue;
+            }
+            if (opening && index != closeIndex && result >= 0)
+            {
+                // closed below like the files opened before the failure
+                fds[index - begin] = result;
+            }
+        }
+        if (not drained)
+        {
+            // entries of a broken ring never complete, their buffers and paths are not freed
+            QVector<QByteArray> *abandonedBuffers = new QVector<QByteArray>(buffers);
+            QList<QByteArray> *abandonedPaths = new QList<QByteArray>(paths);
+            Q_UNUSED(abandonedBuffers);
+            Q_UNUSED(abandonedPaths);
+        }
+        // the ring is in an unknown state, it is not used again
+        teardown();
+        for (int i = 0; i < count; ++i)
+        {
+            if (fds.at(i) >= 0)
+            {
+                ::close(fds.at(i));
+            }
+            if (not done.at(i))
+            {
+                consumer.consume(begin + i, QByteArray(), false);
+            }
+        }
+    }
+#else
+    Q_UNUSED(paths);
+    Q_UNUSED(sizes);
+    for (int index = begin; index < end; ++index)
+    {
+        consumer.consume(index, QByteArray(), false);
+    }
+#endif
+}
@@ -13,10 +13,335 @@
   *************************************************************************************************/
 #include "MainWindow.h"
 #include <QApplication>
+#include <QDirIterator>
+#include <QElapsedTimer>
 #include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <TlogParser.h>
+#include <TlogMarkerScanner.h>
+#include <ScanThrottle.h>
+#include <UringReader.h>
+#include <DirectoryWalker.h>
+#include <BranchLayoutMatcher.h>
+#include <Model/Library.h>
+#include <Model/Testcase.h>
+#include <Model/Testrun.h>
+
+/**
+  * @brief The QTextStream line loop tlogs were parsed with before the TlogParser.
+  * @details Kept only as the baseline of the tlog benchmark, it records the totals and the fail
+  *          log of each testcase but no test functions.
+  */
+static void parseTlogTextStream(const QString &tlogFilePath,
+                                const QSharedPointer<Model::Library> &library,
+                                qint64 timestamp)
+{
+    QFile tlogFile(tlogFilePath);
+    if (not tlogFile.open(QIODevice::ReadOnly | QIODevice::Text))
+    {
+        return;
+    }
+
+    QString patternTestCaseBeginStartOfLine("********* Start ");
+    QString patternTestCaseBeginEndOfLine(" *********");
+    QString patternTestCaseEndStartOfLine("********* Finished testing of ");
+    QString patternTestCaseEndEndOfLine(" *********");
+    QString patternTestCaseSummaryStartOfLine("Totals: ");
+    // Fails
+    QString patternTestCaseFailBeginStartOfLine("FAIL!");
+    QString patternTestCaseFailEndStartOfLine("   Loc:");
+
+    QSharedPointer<Model::Testcase> testcase;
+    QTextStream in(&tlogFile);
+    int lineNumber = 0, testcaseStartLine = 0;
+    QStringList failLog;
+    bool inFailLogOutput = false;
+    while (not in.atEnd())
+    {
+        QString line = in.readLine();
+        ++lineNumber;
+
+        if (line.startsWith(patternTestCaseBeginStartOfLine) &&
+                line.endsWith(patternTestCaseBeginEndOfLine))
+        {
+            testcaseStartLine = lineNumber - 1;
+            failLog.clear();
+            QString testcaseName = line.replace(patternTestCaseBeginStartOfLine, "").
+                    replace(patternTestCaseBeginEndOfLine, "")
+                    .split("::").last();
+            testcase = library->getTestcase(testcaseName);
+            if (testcase.isNull())
+            {
+                testcase = QSharedPointer<Model::Testcase>(new Model::Testcase());
+                testcase->withName(testcaseName);
+                library->addTestcase(testcase);
+            }
+        }
+
+        if (line.startsWith(patternTestCaseFailBeginStartOfLine))
+        {
+            inFailLogOutput = true;
+        }
+        if (inFailLogOutput)
+        {
+            failLog << line;
+            if (line.startsWith(patternTestCaseFailEndStartOfLine))
+            {
+                inFailLogOutput = false;
+            }
+        }
+
+        if (line.startsWith(patternTestCaseSummaryStartOfLine) && not testcase.isNull())
+        {
+            qint32 passed = 0, failed = 0, skipped = 0;
+            double msecs = -1.0;
+            TlogParser::parseTotals(line, passed, failed, skipped, msecs);
+            if (testcase->getTestrun(timestamp).isNull())
+            {
+                QSharedPointer<Model::Testrun> testrun(new Model::Testrun());
+                testrun->withFailLog(failed > 0 ? failLog.join("\n") : QString(""))
+                        .withResults(passed, failed, skipped)
+                        .withDuration(msecs)
+                        .withTimestamp(timestamp);
+                testcase->addTestrun(testrun);
+            }
+        }
+
+        if (line.startsWith(patternTestCaseEndStartOfLine) &&
+                line.endsWith(patternTestCaseEndEndOfLine) && not testcase.isNull())
+        {
+            testcase->withTlogPath(tlogFilePath, testcaseStartLine, lineNumber - 1);
+        }
+    }
+}
+
+/**
+  * @brief Prints the throughput of the QTextStream baseline and of the tlog parser on a tlog read
+  *        into memory and on a mapped tlog.
+  * @details Invoked as "UnitTestMonitor --benchmark-tlog <tlog> [repetitions]".
+  */
+static int benchmarkTlogParser(const QString &tlogFilePath, int repetitions)
+{
+    QTextStream out(stdout);
+    qint64 size = QFileInfo(tlogFilePath).size();
+    if (size <= 0 || repetitions <= 0)
+    {
+        out << "Cannot benchmark missing or empty tlog: " << tlogFilePath << endl;
+        return 1;
+    }
+
+    TlogParser parser;
+    for (int mode = 0; mode < 3; ++mode)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < repetitions; ++i)
+        {
+            QSharedPointer<Model::Library> library(new Model::Library());
+            if (mode == 0)
+            {
+                parseTlogTextStream(tlogFilePath, library, 1);
+            }
+            else if (mode == 1)
+            {
+                // what parse() falls back to if a tlog cannot be mapped
+                QFile tlogFile(tlogFilePath);
+                if (tlogFile.open(QIODevice::ReadOnly))
+                {
+                    QByteArray content = tlogFile.readAll();
+                    parser.parseData(content.constData(), content.size(), tlogFilePath, library, 1);
+                }
+            }
+            else
+            {
+                parser.parse(tlogFilePath, library, 1);
+            }
+        }
+        double seconds = qMax<qint64>(timer.nsecsElapsed(), 1) / 1000000000.0;
+        double megabytes = static_cast<double>(size) * repetitions / (1024.0 * 1024.0);
+        if (mode == 0)
+        {
+            out << "QTextStream baseline: ";
+        }
+        else if (mode == 1)
+        {
+            out << "read parser (" << TlogMarkerScanner::instructionSet() << "): ";
+        }
+        else
+        {
+            out << "mapped parser (" << TlogMarkerScanner::instructionSet() << "): ";
+        }
+        out << QString::number(megabytes / seconds, 'f', 1) << " MB/s" << endl;
+    }
+    return 0;
+}
+
+/**
+  * @brief Parses every tlog handed out by a UringReader from memory.
+  */
+class BenchmarkConsumer : public UringReader::Consumer
+{
+public:
+    explicit BenchmarkConsumer(const QStringList &tlogFilePaths)
+        : m_tlogFilePaths(tlogFilePaths),
+          m_fallbacks(0)
+    {
+    }
+
+    void consume(int index, const QByteArray &content, bool read)
+    {
+        QSharedPointer<Model::Library> library(new Model::Library());
+        if (read)
+        {
+            m_parser.parseData(content.constData(), content.size(), m_tlogFilePaths.at(index),
+                               library, 1);
+        }
+        else
+        {
+            m_parser.parse(m_tlogFilePaths.at(index), library, 1);
+            ++m_fallbacks;
+        }
+    }
+
+    int getFallbacks() const
+    {
+        return m_fallbacks;
+    }
+
+private:
+    const QStringList &m_tlogFilePaths;
+    TlogParser m_parser;
+    int m_fallbacks;
+};
+
+/**
+  * @brief Prints the files per second of reading tlogs one by one and in io_uring batches.
+  * @details Invoked as "UnitTestMonitor --benchmark-batch <directory> [queue depth]". Every tlog
+  *          below the directory is dropped from the page cache before each pass, which makes the
+  *          cache cold for tlogs that are not mapped or written by someone else at the time.
+  */
+static int benchmarkBatchedReads(const QString &directoryPath, int queueDepth)
+{
+    QTextStream out(stdout);
+    QStringList tlogFilePaths;
+    QList<qint64> sizes;
+    qint64 totalSize = 0;
+    QDirIterator it(directoryPath, QStringList() << "tlog", QDir::Files,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext())
+    {
+        tlogFilePaths.append(it.next());
+        sizes.append(it.fileInfo().size());
+        totalSize += it.fileInfo().size();
+    }
+    if (tlogFilePaths.isEmpty() || queueDepth <= 0)
+    {
+        out << "Cannot benchmark without tlogs below: " << directoryPath << endl;
+        return 1;
+    }
+    out << tlogFilePaths.size() << " tlogs, "
+        << QString::number(totalSize / (1024.0 * 1024.0), 'f', 1) << " MB" << endl;
+
+    for (int mode = 0; mode < 2; ++mode)
+    {
+        foreach (const QString &tlogFilePath, tlogFilePaths)
+        {
+            ScanThrottle::dropFromPageCache(tlogFilePath);
+        }
+
+        QElapsedTimer timer;
+        timer.start();
+        if (mode == 0)
+        {
+            TlogParser parser;
+            foreach (const QString &tlogFilePath, tlogFilePaths)
+            {
+                QSharedPointer<Model::Library> library(new Model::Library());
+                parser.parse(tlogFilePath, library, 1);
+            }
+            out << "one by one: ";
+        }
+        else
+        {
+            UringReader reader(queueDepth);
+            if (not reader.isValid())
+            {
+                out << "io_uring batches: not available" << endl;
+                return 0;
+            }
+            BenchmarkConsumer consumer(tlogFilePaths);
+            reader.readFiles(tlogFilePaths, sizes, consumer);
+            out << "io_uring batches of " << reader.getQueueDepth() << " ("
+                << reader.getSyscalls() << " system calls, " << consumer.getFallbacks()
+                << " fallbacks): ";
+        }
+        double seconds = qMax<qint64>(timer.nsecsElapsed(), 1) / 1000000000.0;
+        out << QString::number(tlogFilePaths.size() / seconds, 'f', 0) << " files/s" << endl;
+    }
+    return 0;
+}
+
+/**
+  * @brief Prints the system calls of walking a branch natively and the estimate for QDir.
+  * @details Invoked as "UnitTestMonitor --benchmark-walk <branch directory>". The branch is
+  *          walked by the templates of the default layout on one thread.
+  */
+static int benchmarkDirectoryWalk(const QString &branchPath)
+{
+    QTextStream out(stdout);
+    BranchLayoutMatcher matcher;
+    if (not QFileInfo(branchPath).isDir() || not matcher.isValid())
+    {
+        out << "Cannot benchmark walking missing directory: " << branchPath << endl;
+        return 1;
+    }
+    if (not DirectoryWalker::isSupported())
+    {
+        out << "native walk: not available" << endl;
+        return 0;
+    }
+
+    for (int mode = 0; mode < 2; ++mode)
+    {
+        DirectoryWalker walker;
+        QList<BranchLayoutMatcher::Match> matches;
+        QElapsedTimer timer;
+        timer.start();
+        matcher.walk(matcher.createStep(branchPath), mode == 0 ? 0 : &walker, matches);
+        double milliseconds = timer.nsecsElapsed() / 1000000.0;
+        if (mode == 0)
+        {
+            out << "QDir: ";
+        }
+        else
+        {
+            out << "native (" << walker.getSyscalls() << " system calls, about "
+                << walker.getSavedSyscalls() << " saved compared to QDir): ";
+        }
+        out << matches.size() << " files in " << QString::number(milliseconds, 'f', 1) << " ms"
+            << endl;
+    }
+    return 0;
+}
 
 int main(int argc, char *argv[])
 {
+    if (argc > 2 && QString(argv[1]) == "--benchmark-tlog")
+    {
+        int repetitions = argc > 3 ? QString(argv[3]).toInt() : 10;
+        return benchmarkTlogParser(QString::fromLocal8Bit(argv[2]), repetitions);
+    }
+    if (argc > 2 && QString(argv[1]) == "--benchmark-batch")
+    {
+        int queueDepth = argc > 3 ? QString(argv[3]).toInt() : 64;
+        return benchmarkBatchedReads(QString::fromLocal8Bit(argv[2]), queueDepth);
+    }
+    if (argc > 2 && QString(argv[1]) == "--benchmark-walk")
+    {
+        return benchmarkDirectoryWalk(QString::fromLocal8Bit(argv[2]));
+    }
+
     QApplication a(argc, argv);
 
     QCoreApplication::setOrganizationName("CuteOpenSourceWorld");